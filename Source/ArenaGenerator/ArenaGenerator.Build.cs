@@ -29,6 +29,7 @@ public class ArenaGenerator : ModuleRules
 			new string[]
 			{
 				"Core",
+				"MassEntity",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -39,6 +40,7 @@ public class ArenaGenerator : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"NavigationSystem",
 				"Slate",
 				"SlateCore",
 				// ... add private dependencies that you statically link with here ...	
@@ -0,0 +1,288 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaAdjacencySolver.h"
+#include "HAL/PlatformTime.h"
+
+namespace ArenaAdjacency
+{
+	static int32 Opposite(int32 Direction) { return (Direction + 2) & 3; }
+
+	static const TArray<int32>& GetAccepted(const FArenaMeshAdjacency& Adjacency, int32 Direction)
+	{
+		switch (Direction) {
+			case 0: { return Adjacency.North; }
+			case 1: { return Adjacency.East; }
+			case 2: { return Adjacency.South; }
+			default: { return Adjacency.West; }
+		}
+	}
+
+	static uint64 AcceptedMask(const FArenaMeshAdjacency& Adjacency, int32 Direction, uint64 AllMeshes)
+	{
+		const TArray<int32>& Accepted = GetAccepted(Adjacency, Direction);
+		if (Accepted.IsEmpty()) { return AllMeshes; }
+
+		uint64 Mask = 0;
+		for (const int32 MeshIdx : Accepted)
+		{
+			if (MeshIdx >= 0 && MeshIdx < FArenaAdjacencyRules::MaxMeshes) {
+				Mask |= uint64(1) << MeshIdx;
+			}
+		}
+		return Mask & AllMeshes;
+	}
+}
+
+#pragma region Rules
+
+bool FArenaAdjacencyRules::BuildFromGroup(const FArenaMeshGroupConfig& Group)
+{
+	NumMeshes = Group.GroupMeshes.Num();
+	if (NumMeshes == 0 || NumMeshes > MaxMeshes) { return false; }
+
+	const uint64 AllMeshes = NumMeshes == 64 ? ~uint64(0) : (uint64(1) << NumMeshes) - 1;
+
+	TArray<uint64> Accepts[4];
+	for (int32 Dir = 0; Dir < 4; ++Dir)
+	{
+		Accepts[Dir].SetNumUninitialized(NumMeshes);
+		for (int32 MeshIdx = 0; MeshIdx < NumMeshes; ++MeshIdx)
+		{
+			Accepts[Dir][MeshIdx] = ArenaAdjacency::AcceptedMask(Group.GroupMeshes[MeshIdx].Adjacency, Dir, AllMeshes);
+		}
+	}
+
+	//A mesh is allowed next to another only if both accept each other
+	for (int32 Dir = 0; Dir < 4; ++Dir)
+	{
+		const int32 Opposite = ArenaAdjacency::Opposite(Dir);
+		Allowed[Dir].SetNumZeroed(NumMeshes);
+
+		for (int32 MeshIdx = 0; MeshIdx < NumMeshes; ++MeshIdx)
+		{
+			for (int32 Other = 0; Other < NumMeshes; ++Other)
+			{
+				const bool bAccepted = (Accepts[Dir][MeshIdx] >> Other) & 1;
+				const bool bAcceptedBack = (Accepts[Opposite][Other] >> MeshIdx) & 1;
+				if (bAccepted && bAcceptedBack) {
+					Allowed[Dir][MeshIdx] |= uint64(1) << Other;
+				}
+			}
+		}
+	}
+
+	Weights.SetNumUninitialized(NumMeshes);
+	for (int32 MeshIdx = 0; MeshIdx < NumMeshes; ++MeshIdx)
+	{
+		Weights[MeshIdx] = FMath::Max(Group.GroupMeshes[MeshIdx].Adjacency.Weight, 0.f);
+	}
+
+	return true;
+}
+
+#pragma endregion
+
+#pragma region Solver
+
+FArenaAdjacencySolver::FArenaAdjacencySolver(const FArenaAdjacencyRules& InRules)
+	: Rules(InRules)
+{
+	NumChunks = FMath::DivideAndRoundUp(Rules.NumMeshes, 8);
+
+	//Support of a domain is the OR of the support of each of its bytes
+	for (int32 Dir = 0; Dir < 4; ++Dir)
+	{
+		TArray<uint64>& Table = SupportTables[Dir];
+		Table.SetNumZeroed(NumChunks * 256);
+
+		for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+		{
+			for (int32 Byte = 1; Byte < 256; ++Byte)
+			{
+				//Reuses the entry without the lowest bit
+				const int32 LowBit = FMath::CountTrailingZeros(uint32(Byte));
+				const int32 MeshIdx = Chunk * 8 + LowBit;
+				const uint64 MeshSupport = MeshIdx < Rules.NumMeshes ? Rules.Allowed[Dir][MeshIdx] : 0;
+
+				Table[Chunk * 256 + Byte] = Table[Chunk * 256 + (Byte & (Byte - 1))] | MeshSupport;
+			}
+		}
+	}
+}
+
+uint64 FArenaAdjacencySolver::GetSupport(int32 Direction, uint64 Domain) const
+{
+	const uint64* Table = SupportTables[Direction].GetData();
+
+	uint64 Support = 0;
+	for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+	{
+		Support |= Table[Chunk * 256 + ((Domain >> (Chunk * 8)) & 0xFF)];
+	}
+	return Support;
+}
+
+int32 FArenaAdjacencySolver::PickMesh(uint64 Domain, FRandomStream& Stream) const
+{
+	float TotalWeight = 0.f;
+	for (uint64 Bits = Domain; Bits; Bits &= Bits - 1)
+	{
+		TotalWeight += Rules.Weights[FMath::CountTrailingZeros64(Bits)];
+	}
+
+	//Zero weights everywhere fall back to an even pick
+	if (TotalWeight <= 0.f)
+	{
+		int32 Pick = Stream.RandRange(0, FMath::CountBits(Domain) - 1);
+		uint64 Bits = Domain;
+		while (Pick-- > 0) { Bits &= Bits - 1; }
+		return int32(FMath::CountTrailingZeros64(Bits));
+	}
+
+	float Roll = Stream.FRand() * TotalWeight;
+	int32 Picked = INDEX_NONE;
+	for (uint64 Bits = Domain; Bits; Bits &= Bits - 1)
+	{
+		Picked = int32(FMath::CountTrailingZeros64(Bits));
+		Roll -= Rules.Weights[Picked];
+		if (Roll < 0.f) { break; }
+	}
+	return Picked;
+}
+
+void FArenaAdjacencySolver::PushEntropy(int32 Cell, uint64 Domain, FRandomStream& Stream)
+{
+	const int32 Count = int32(FMath::CountBits(Domain));
+	if (Count <= 1) { return; }
+
+	//Noise breaks ties between cells with as many options, so collapse does not sweep the lattice in order
+	EntropyHeap.HeapPush(FCellEntropy{ Count + Stream.FRand() * 0.5f, Count, Cell });
+}
+
+bool FArenaAdjacencySolver::Propagate(FRandomStream& Stream)
+{
+	while (!PropagationStack.IsEmpty())
+	{
+		const int32 Cell = PropagationStack.Pop(false);
+		const int32 Col = Cell % Columns;
+		const int32 Row = Cell / Columns;
+		const uint64 Domain = Domains[Cell];
+
+		const int32 Neighbors[4] = {
+			Row + 1 < Rows ? Cell + Columns : INDEX_NONE,
+			Col + 1 < Columns ? Cell + 1 : INDEX_NONE,
+			Row > 0 ? Cell - Columns : INDEX_NONE,
+			Col > 0 ? Cell - 1 : INDEX_NONE,
+		};
+
+		for (int32 Dir = 0; Dir < 4; ++Dir)
+		{
+			const int32 Neighbor = Neighbors[Dir];
+			if (Neighbor == INDEX_NONE) { continue; }
+
+			const uint64 Narrowed = Domains[Neighbor] & GetSupport(Dir, Domain);
+			if (Narrowed == Domains[Neighbor]) { continue; }
+			if (Narrowed == 0) { return false; }
+
+			Domains[Neighbor] = Narrowed;
+			PropagationStack.Add(Neighbor);
+			PushEntropy(Neighbor, Narrowed, Stream);
+		}
+	}
+
+	return true;
+}
+
+bool FArenaAdjacencySolver::Attempt(FRandomStream& Stream)
+{
+	const uint64 AllMeshes = Rules.NumMeshes == 64 ? ~uint64(0) : (uint64(1) << Rules.NumMeshes) - 1;
+	const int32 NumCells = Columns * Rows;
+
+	Domains.Init(AllMeshes, NumCells);
+	EntropyHeap.Reset();
+	PropagationStack.Reset();
+
+	//Rules can forbid meshes everywhere, for example at the edges of the plane
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		PropagationStack.Add(Cell);
+	}
+	if (!Propagate(Stream)) { return false; }
+
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		PushEntropy(Cell, Domains[Cell], Stream);
+	}
+
+	while (!EntropyHeap.IsEmpty())
+	{
+		FCellEntropy Lowest;
+		EntropyHeap.HeapPop(Lowest, false);
+
+		//Entries are left behind when a cell narrows again, only the current one counts
+		const uint64 Domain = Domains[Lowest.Cell];
+		if (int32(FMath::CountBits(Domain)) != Lowest.Count) { continue; }
+
+		Domains[Lowest.Cell] = uint64(1) << PickMesh(Domain, Stream);
+		PropagationStack.Add(Lowest.Cell);
+		if (!Propagate(Stream)) { return false; }
+	}
+
+	return true;
+}
+
+void FArenaAdjacencySolver::Solve(int32 InColumns, int32 InRows, int32 Seed, int32 MaxAttempts, FArenaAdjacencyResult& OutResult)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	OutResult = FArenaAdjacencyResult();
+	Columns = FMath::Max(InColumns, 0);
+	Rows = FMath::Max(InRows, 0);
+
+	if (Columns * Rows == 0 || Rules.NumMeshes == 0) { return; }
+
+	for (int32 AttemptIdx = 0; AttemptIdx < FMath::Max(MaxAttempts, 1); ++AttemptIdx)
+	{
+		OutResult.Attempts++;
+
+		FRandomStream Stream(int32(uint32(Seed) + uint32(AttemptIdx)));
+		if (Attempt(Stream))
+		{
+			OutResult.Meshes.SetNumUninitialized(Domains.Num());
+			for (int32 Cell = 0; Cell < Domains.Num(); ++Cell)
+			{
+				OutResult.Meshes[Cell] = int32(FMath::CountTrailingZeros64(Domains[Cell]));
+			}
+			break;
+		}
+
+		OutResult.Contradictions++;
+	}
+
+	OutResult.Seconds = FPlatformTime::Seconds() - StartTime;
+}
+
+#pragma endregion
@@ -0,0 +1,259 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaFitSolver.h"
+#include "Async/ParallelFor.h"
+#include "ArenaLayoutPlanner.h"
+
+namespace
+{
+	bool IsGridLead(EArenaBuildOrderRules Rules)
+	{
+		return Rules == EArenaBuildOrderRules::GridLeadsByDimensions || Rules == EArenaBuildOrderRules::GridLeadsByRadius;
+	}
+
+	//Grid dimensions below this leave no room for a polygon
+	constexpr int32 MinGridDimensions = 2;
+}
+
+float FArenaFitSolver::InteriorAngleForSides(int32 Sides)
+{
+	Sides = FMath::Max(Sides, 3);
+	return ((Sides - 2) * 180) / Sides;
+}
+
+FArenaFitResult FArenaFitSolver::Evaluate(const FArenaFitInputs& Inputs, int32 Sides, int32 Lead)
+{
+	FArenaFitResult Result;
+
+	const float GridTile = FMath::Max(Inputs.GridTileSize, KINDA_SMALL_NUMBER);
+	const float WallTile = FMath::Max(Inputs.WallTileSize, KINDA_SMALL_NUMBER);
+
+	Result.ArenaSides = FMath::Max(Sides, 3);
+	Result.InteriorAngle = InteriorAngleForSides(Result.ArenaSides);
+	const float HalfInterior = Result.InteriorAngle / 2.f;
+
+	if (IsGridLead(Inputs.BuildOrderRules))
+	{
+		//Grid dimensions determine the radius, walls take what fits
+		Result.ArenaDimensions = Lead;
+		Result.InscribedRadius = Inputs.BuildOrderRules == EArenaBuildOrderRules::GridLeadsByDimensions ?
+			GridTile * (Lead - 1) * 0.5f :
+			GridTile * Lead * 0.5f;
+
+		Result.SideLength = 2.f * FArenaLayoutPlanner::CalculateOpposite(Result.InscribedRadius, HalfInterior);
+
+		const int32 WallsOnSide = FMath::FloorToInt(Result.SideLength / WallTile);
+		Result.TilesPerArenaSide = FMath::Clamp(WallsOnSide, 1, Inputs.MaxTilesPerSideRow);
+		Result.bWallsFit = WallsOnSide >= 1;
+	}
+	else
+	{
+		//Tiles per side determine the radius, the grid covers it
+		Result.TilesPerArenaSide = Lead;
+		Result.SideLength = WallTile * Lead;
+		Result.InscribedRadius = (Result.SideLength / 2.f) / FMath::Sin(FMath::DegreesToRadians(90.f - HalfInterior));
+		Result.ArenaDimensions = FMath::CeilToInt((Result.InscribedRadius * 2.f) / GridTile);
+		Result.bWallsFit = Lead >= 1;
+	}
+
+	Result.Apothem = FMath::Abs(FArenaLayoutPlanner::CalculateAdjacent(Result.InscribedRadius, HalfInterior));
+	Result.NumTiles = Result.ArenaDimensions * Result.ArenaDimensions + Result.ArenaSides * Result.TilesPerArenaSide;
+
+	return Result;
+}
+
+int32 FArenaFitSolver::GetTargetLead(const FArenaFitInputs& Inputs, int32 Sides)
+{
+	const FArenaSectionTargets& Targets = Inputs.Targets;
+	const float GridTile = FMath::Max(Inputs.GridTileSize, KINDA_SMALL_NUMBER);
+	const float WallTile = FMath::Max(Inputs.WallTileSize, KINDA_SMALL_NUMBER);
+
+	switch (Inputs.BuildOrderRules) {
+		case EArenaBuildOrderRules::GridLeadsByDimensions:
+		{
+			return Targets.TargetGridDimensions;
+		}
+		case EArenaBuildOrderRules::GridLeadsByRadius:
+		{
+			return (Targets.TargetInscribedRadius / GridTile) > MinGridDimensions ? FMath::FloorToInt(Targets.TargetInscribedRadius / GridTile) : MinGridDimensions;
+		}
+		case EArenaBuildOrderRules::PolygonLeadByDimensions:
+		{
+			return Targets.TargetTilesPerSide;
+		}
+		default:
+		case EArenaBuildOrderRules::PolygonLeadByRadius:
+		{
+			const float HalfInterior = InteriorAngleForSides(Sides) / 2.f;
+			return FMath::FloorToInt((2.f * FArenaLayoutPlanner::CalculateOpposite(Targets.TargetInscribedRadius, HalfInterior)) / WallTile);
+		}
+	}
+}
+
+int32 FArenaFitSolver::MaxSidesForRadius(float Radius, float TileSize, int32 MaxSides, int32 TilesPerSide)
+{
+	const float Needed = FMath::Max(TileSize, 0.f) * FMath::Max(TilesPerSide, 1);
+	if (Radius <= 0.f || Needed > 2.f * Radius) { return 0; }
+	if (Needed <= 0.f) { return MaxSides; }
+
+	//Side of a regular polygon is 2R sin(pi / n), solve for n
+	const double Bound = PI / FMath::Asin(FMath::Min(Needed / (2.0 * Radius), 1.0));
+	int32 Sides = FMath::Clamp(FMath::FloorToInt(Bound), 0, FMath::Max(MaxSides, 3));
+
+	//Planning rounds the interior angle, verify with its formula
+	while (Sides >= 3 && 2.f * FArenaLayoutPlanner::CalculateOpposite(Radius, InteriorAngleForSides(Sides) / 2.f) < Needed)
+	{
+		Sides--;
+	}
+
+	return Sides >= 3 ? Sides : 0;
+}
+
+float FArenaFitSolver::MinRadiusForSides(int32 Sides, float TileSize, int32 TilesPerSide)
+{
+	const float HalfInterior = InteriorAngleForSides(Sides) / 2.f;
+	const float Needed = FMath::Max(TileSize, 0.f) * FMath::Max(TilesPerSide, 1);
+
+	return (Needed / 2.f) / FMath::Max(FMath::Cos(FMath::DegreesToRadians(HalfInterior)), KINDA_SMALL_NUMBER);
+}
+
+int32 FArenaFitSolver::MinFittingLead(const FArenaFitInputs& Inputs, int32 Sides)
+{
+	if (!IsGridLead(Inputs.BuildOrderRules)) { return 1; }
+
+	const float GridTile = FMath::Max(Inputs.GridTileSize, KINDA_SMALL_NUMBER);
+	const float Diameter = 2.f * MinRadiusForSides(Sides, Inputs.WallTileSize);
+
+	int32 Lead = Inputs.BuildOrderRules == EArenaBuildOrderRules::GridLeadsByDimensions ?
+		FMath::CeilToInt(Diameter / GridTile) + 1 :
+		FMath::CeilToInt(Diameter / GridTile);
+	Lead = FMath::Max(Lead, MinGridDimensions);
+
+	//Rounding can leave the side a hair short
+	for (int32 Step = 0; Step < 2 && !Evaluate(Inputs, Sides, Lead).bWallsFit; ++Step)
+	{
+		Lead++;
+	}
+
+	return Lead;
+}
+
+FArenaFitResult FArenaFitSolver::Solve(const FArenaFitInputs& Inputs)
+{
+	const FArenaSectionTargets& Targets = Inputs.Targets;
+
+	const int32 TargetSides = FMath::Clamp(Targets.TargetPolygonSides, 3, FMath::Max(Inputs.MaxSides, 3));
+	const int32 TargetLead = GetTargetLead(Inputs, TargetSides);
+
+	int32 Sides = TargetSides;
+	int32 Lead = TargetLead;
+	FArenaFitResult Result = Evaluate(Inputs, Sides, Lead);
+
+	//Walls do not fit on the sides
+	if (!Result.bWallsFit)
+	{
+		//Tiles per side are the target itself when the polygon leads by dimensions, fewer sides would not help
+		if (Targets.FitResolution == EArenaFitResolution::ReduceSides && Inputs.BuildOrderRules != EArenaBuildOrderRules::PolygonLeadByDimensions)
+		{
+			const float Radius = IsGridLead(Inputs.BuildOrderRules) ? Result.InscribedRadius : Targets.TargetInscribedRadius;
+			const int32 FittingSides = MaxSidesForRadius(Radius, Inputs.WallTileSize, Inputs.MaxSides);
+
+			if (FittingSides >= 3)
+			{
+				Sides = FMath::Min(Sides, FittingSides);
+				Lead = FMath::Max(GetTargetLead(Inputs, Sides), 1);
+				Result = Evaluate(Inputs, Sides, Lead);
+			}
+		}
+
+		//Growing is also the fallback when even a triangle does not fit
+		if (!Result.bWallsFit)
+		{
+			Lead = FMath::Max(Lead, MinFittingLead(Inputs, Sides));
+			Result = Evaluate(Inputs, Sides, Lead);
+		}
+	}
+
+	//Reduce the lead parameter to the largest value within budget. Tile count grows with the lead, so a binary search is enough.
+	if (Targets.TileBudget > 0 && Result.NumTiles > Targets.TileBudget)
+	{
+		int32 Low = MinFittingLead(Inputs, Sides);
+		int32 High = FMath::Max(Lead, Low);
+
+		if (Evaluate(Inputs, Sides, Low).NumTiles > Targets.TileBudget)
+		{
+			Lead = Low;
+			Result = Evaluate(Inputs, Sides, Lead);
+			Result.bWithinBudget = false;
+		}
+		else
+		{
+			while (Low < High)
+			{
+				const int32 Mid = Low + (High - Low + 1) / 2;
+				if (Evaluate(Inputs, Sides, Mid).NumTiles <= Targets.TileBudget) { Low = Mid; }
+				else { High = Mid - 1; }
+			}
+
+			Lead = Low;
+			Result = Evaluate(Inputs, Sides, Lead);
+		}
+	}
+
+	Result.bAdjusted = Sides != TargetSides || Lead != TargetLead;
+	return Result;
+}
+
+void FArenaFitSolver::SolveBatch(TArrayView<const FArenaFitInputs> Inputs, TArrayView<FArenaFitResult> OutResults)
+{
+	check(Inputs.Num() == OutResults.Num());
+
+	ParallelFor(Inputs.Num(), [&Inputs, &OutResults](int32 Idx)
+	{
+		OutResults[Idx] = Solve(Inputs[Idx]);
+	});
+}
+
+FArenaFitResult UArenaFitSolverLibrary::SolveArenaFit(const FArenaFitInputs& Inputs)
+{
+	return FArenaFitSolver::Solve(Inputs);
+}
+
+void UArenaFitSolverLibrary::SolveArenaFitBatch(const TArray<FArenaFitInputs>& Inputs, TArray<FArenaFitResult>& OutResults)
+{
+	OutResults.SetNum(Inputs.Num());
+	FArenaFitSolver::SolveBatch(Inputs, OutResults);
+}
+
+int32 UArenaFitSolverLibrary::MaxSidesForRadius(float Radius, float TileSize, int32 MaxSides, int32 TilesPerSide)
+{
+	return FArenaFitSolver::MaxSidesForRadius(Radius, TileSize, MaxSides, TilesPerSide);
+}
+
+float UArenaFitSolverLibrary::MinRadiusForSides(int32 Sides, float TileSize, int32 TilesPerSide)
+{
+	return FArenaFitSolver::MinRadiusForSides(Sides, TileSize, TilesPerSide);
+}
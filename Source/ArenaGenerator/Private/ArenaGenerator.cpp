@@ -26,6 +26,7 @@
 #include "Developer/Settings/Public/ISettingsModule.h"
 #include "Developer/Settings/Public/ISettingsSection.h"
 #include "ArenaGeneratorSettings.h"
+#include "ArenaOutputSink.h"
 
 
 #define LOCTEXT_NAMESPACE "FArenaGeneratorModule"
@@ -34,12 +35,15 @@ void FArenaGeneratorModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 	RegisterSettings();
+	FArenaOutputSinkRegistry::RegisterBuiltInSinks();
 }
 
 void FArenaGeneratorModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FArenaOutputSinkRegistry::UnregisterBuiltInSinks();
+
 	if (UObjectInitialized())
 	{
 		UnregisterSettings();
@@ -24,3 +24,89 @@
 
 
 #include "ArenaGeneratorTypes.h"
+
+void FArenaMeshGroupConfig::GetComponentMeshes(TArray<UStaticMesh*>& OutMeshes) const
+{
+	OutMeshes.Reset();
+
+	for (const FArenaMesh& ArenaMesh : GroupMeshes)
+	{
+		OutMeshes.Add(ArenaMesh.Mesh);
+	}
+
+	for (const FArenaMesh& ArenaMesh : GroupMeshes)
+	{
+		for (const FArenaSubMesh& SubMesh : ArenaMesh.SubMeshes)
+		{
+			OutMeshes.Add(SubMesh.Mesh);
+		}
+	}
+}
+
+void FArenaMeshGroupConfig::GetSubMeshSlots(TArray<int32>& OutFirstSlots) const
+{
+	OutFirstSlots.Reset(GroupMeshes.Num());
+
+	int32 Slot = GroupMeshes.Num();
+	for (const FArenaMesh& ArenaMesh : GroupMeshes)
+	{
+		OutFirstSlots.Add(Slot);
+		Slot += ArenaMesh.SubMeshes.Num();
+	}
+}
+
+int32 FArenaSpawnPoints::Sample(const FRandomStream& Stream, int32 MinClearance) const
+{
+	//Points are sorted by clearance, so the ones clear enough are a prefix
+	const int32 Count = NumWithClearance.IsEmpty() ? 0 : NumWithClearance[FMath::Clamp(MinClearance, 0, NumWithClearance.Num() - 1)];
+	if (MinClearance >= NumWithClearance.Num() || Count == 0) { return INDEX_NONE; }
+
+	return Stream.RandHelper(Count);
+}
+
+int32 FArenaCoverPoints::Sample(const FRandomStream& Stream) const
+{
+	return Locations.IsEmpty() ? INDEX_NONE : Stream.RandHelper(Locations.Num());
+}
+
+void FArenaAnnotations::Reset()
+{
+	SpawnPoints = FArenaSpawnPoints();
+	CoverPoints = FArenaCoverPoints();
+	PatrolLoops.Reset();
+}
+
+SIZE_T FArenaAnnotations::GetAllocatedSize() const
+{
+	SIZE_T Size = SpawnPoints.Locations.GetAllocatedSize() + SpawnPoints.Clearance.GetAllocatedSize() + SpawnPoints.NumWithClearance.GetAllocatedSize()
+		+ CoverPoints.Locations.GetAllocatedSize() + CoverPoints.Facing.GetAllocatedSize() + PatrolLoops.GetAllocatedSize();
+
+	for (const FArenaPatrolLoop& Loop : PatrolLoops)
+	{
+		Size += Loop.Points.GetAllocatedSize();
+	}
+	return Size;
+}
+
+void FArenaBakedLayout::UpdateStats()
+{
+	Stats = FArenaLayoutStats();
+	Stats.MemoryBytes = sizeof(FArenaBakedLayout) + MeshInstances.GetAllocatedSize() + Actors.GetAllocatedSize() + Annotations.GetAllocatedSize();
+
+	for (const FArenaBakedMeshInstances& Baked : MeshInstances)
+	{
+		Stats.NumMeshInstances += Baked.Transforms.Num();
+		Stats.MemoryBytes += Baked.Transforms.GetAllocatedSize();
+
+		for (const FTransform& InstTransform : Baked.Transforms)
+		{
+			Stats.Bounds += InstTransform.GetLocation();
+		}
+	}
+
+	for (const FArenaBakedActor& Baked : Actors)
+	{
+		Stats.NumActors++;
+		Stats.Bounds += Baked.Transform.GetLocation();
+	}
+}
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaGroundSnap.h"
+#include "ArenaLayoutPlanner.h"
+
+int32 FArenaGroundSnap::GetNumColumns(const FArenaPlannedPattern& Pattern)
+{
+	return Pattern.SectionType == EArenaSectionType::Polygon ? Pattern.Slices * Pattern.Columns : Pattern.Columns * Pattern.Rows;
+}
+
+int32 FArenaGroundSnap::GetColumnIdx(const FArenaPlannedPattern& Pattern, const FArenaTileCoord& Coord)
+{
+	if (Coord.Slice < 0 || Coord.Column < 0 || Coord.Row < 0
+		|| Coord.Slice >= Pattern.Slices || Coord.Column >= Pattern.Columns || Coord.Row >= Pattern.Rows) {
+		return INDEX_NONE;
+	}
+
+	return Pattern.SectionType == EArenaSectionType::Polygon ? Coord.Slice * Pattern.Columns + Coord.Column : Coord.Row * Pattern.Columns + Coord.Column;
+}
+
+void FArenaGroundSnap::GatherColumns(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, TArray<FArenaGroundColumn>& OutColumns)
+{
+	OutColumns.Reset();
+
+	TArray<FVector> PivotOffsets;
+	TArray<int32> LowestTiles;
+
+	for (int32 PatternIdx = 0; PatternIdx < Plan.Patterns.Num(); ++PatternIdx)
+	{
+		const FArenaPlannedPattern& Pattern = Plan.Patterns[PatternIdx];
+		if (Pattern.NumTiles <= 0 || !Inputs.SectionList.IsValidIndex(Pattern.SectionIdx) || !Inputs.SectionList[Pattern.SectionIdx].bSnapToGround) { continue; }
+
+		LowestTiles.Init(INDEX_NONE, GetNumColumns(Pattern));
+		for (int32 TileIdx = Pattern.FirstTile; TileIdx < Pattern.FirstTile + Pattern.NumTiles; ++TileIdx)
+		{
+			const int32 ColumnIdx = GetColumnIdx(Pattern, Plan.Tiles[TileIdx].Coord);
+			if (ColumnIdx == INDEX_NONE) { continue; }
+
+			int32& Lowest = LowestTiles[ColumnIdx];
+			if (Lowest == INDEX_NONE || Plan.Tiles[TileIdx].Transform.GetLocation().Z < Plan.Tiles[Lowest].Transform.GetLocation().Z) {
+				Lowest = TileIdx;
+			}
+		}
+
+		FArenaLayoutPlanner::GetPivotOffsets(Inputs, Pattern, PivotOffsets);
+
+		for (int32 ColumnIdx = 0; ColumnIdx < LowestTiles.Num(); ++ColumnIdx)
+		{
+			if (LowestTiles[ColumnIdx] == INDEX_NONE) { continue; }
+
+			const FArenaPlannedTile& Tile = Plan.Tiles[LowestTiles[ColumnIdx]];
+			const FVector Pivot = PivotOffsets.IsValidIndex(Tile.MeshIdx) ? PivotOffsets[Tile.MeshIdx] : FVector(0);
+
+			FArenaGroundColumn& Column = OutColumns.AddDefaulted_GetRef();
+			Column.PlanPattern = PatternIdx;
+			Column.ColumnIdx = ColumnIdx;
+			Column.Location = Tile.Transform.GetLocation() + FRotator(0, Tile.Transform.Rotator().Yaw, 0).RotateVector(FVector(Pivot.X, Pivot.Y, 0));
+		}
+	}
+}
+
+int32 FArenaGroundSnap::ApplyColumns(FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, TConstArrayView<FArenaGroundColumn> Columns)
+{
+	const float MaxAdjust = FMath::Max(Inputs.GroundSnapMaxAdjust, 0.f);
+	int32 NumMoved = 0;
+
+	TArray<float> Offsets;
+
+	//Columns are gathered pattern by pattern, each run of a pattern is applied at once
+	for (int32 RunStart = 0; RunStart < Columns.Num();)
+	{
+		const int32 PlanPattern = Columns[RunStart].PlanPattern;
+		int32 RunEnd = RunStart;
+		while (RunEnd < Columns.Num() && Columns[RunEnd].PlanPattern == PlanPattern) { ++RunEnd; }
+
+		if (!Plan.Patterns.IsValidIndex(PlanPattern)) {
+			RunStart = RunEnd;
+			continue;
+		}
+
+		const FArenaPlannedPattern& Pattern = Plan.Patterns[PlanPattern];
+		Offsets.Init(0.f, GetNumColumns(Pattern));
+
+		for (int32 Idx = RunStart; Idx < RunEnd; ++Idx)
+		{
+			const FArenaGroundColumn& Column = Columns[Idx];
+			if (Column.bHit && Offsets.IsValidIndex(Column.ColumnIdx)) {
+				Offsets[Column.ColumnIdx] = FMath::Clamp(Column.Offset, -MaxAdjust, MaxAdjust);
+			}
+		}
+
+		auto MoveTiles = [&Pattern, &Offsets](TArrayView<FArenaPlannedTile> Tiles)
+		{
+			int32 Moved = 0;
+			for (FArenaPlannedTile& Tile : Tiles)
+			{
+				const int32 ColumnIdx = GetColumnIdx(Pattern, Tile.Coord);
+				if (ColumnIdx == INDEX_NONE || Offsets[ColumnIdx] == 0.f) { continue; }
+
+				Tile.Transform.AddToTranslation(FVector(0, 0, Offsets[ColumnIdx]));
+				Moved++;
+			}
+			return Moved;
+		};
+
+		//Sub meshes share their tile's coordinate and follow it
+		NumMoved += MoveTiles(TArrayView<FArenaPlannedTile>(Plan.Tiles.GetData() + Pattern.FirstTile, Pattern.NumTiles));
+		MoveTiles(TArrayView<FArenaPlannedTile>(Plan.SubTiles.GetData() + Pattern.FirstSubTile, Pattern.NumSubTiles));
+
+		RunStart = RunEnd;
+	}
+
+	return NumMoved;
+}
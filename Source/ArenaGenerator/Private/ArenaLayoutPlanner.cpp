@@ -0,0 +1,1752 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaLayoutPlanner.h"
+#include "ArenaAdjacencySolver.h"
+#include "Async/ParallelFor.h"
+#include "Algo/StableSort.h"
+#include "ArenaGeneratorLog.h"
+#include "ArenaNoise.h"
+#include "ArenaFitSolver.h"
+
+void FArenaConcavityTable::Build(int32 ColMidpoint, int32 RowMidpoint, int32 InColumns, int32 InRows, float ConcavityStrength)
+{
+	Columns = FMath::Max(InColumns, 0);
+	Rows = FMath::Max(InRows, 0);
+	Weights.SetNumUninitialized(Columns * Rows);
+
+	for (int32 Row = 0; Row < Rows; ++Row)
+	{
+		for (int32 Col = 0; Col < Columns; ++Col)
+		{
+			Weights[Row * Columns + Col] = FArenaLayoutPlanner::ConcavityWeight(ColMidpoint, RowMidpoint, Col, Row, ConcavityStrength);
+		}
+	}
+}
+
+void FArenaPivotTable::Build(TConstArrayView<FVector> PivotToCenter, float BaseYaw, float YawIncrement, int32 InNumYaws)
+{
+	NumYaws = FMath::Max(InNumYaws, 1);
+	Offsets.SetNumUninitialized(PivotToCenter.Num() * NumYaws);
+
+	for (int32 MeshIdx = 0; MeshIdx < PivotToCenter.Num(); ++MeshIdx)
+	{
+		for (int32 YawIdx = 0; YawIdx < NumYaws; ++YawIdx)
+		{
+			Offsets[MeshIdx * NumYaws + YawIdx] = FArenaLayoutPlanner::PivotRotationOffset(PivotToCenter[MeshIdx], BaseYaw + (YawIncrement * YawIdx));
+		}
+	}
+}
+
+void FArenaAutoTileTable::Build(TConstArrayView<FArenaAutoTileRule> Rules, int32 NumMeshes)
+{
+	for (int32 Mask = 0; Mask < 256; ++Mask)
+	{
+		FEntry& Entry = Entries[Mask];
+		Entry = FEntry();
+
+		for (const FArenaAutoTileRule& Rule : Rules)
+		{
+			const int32 NumTurns = Rule.bMatchRotations ? 4 : 1;
+			for (int32 Turn = 0; Turn < NumTurns && !Entry.bMatched; ++Turn)
+			{
+				const uint8 Occupied = RotateMask(uint8(Rule.Occupied), Turn);
+				const uint8 Compared = RotateMask(uint8(Rule.CompareMask), Turn);
+
+				if ((Mask & Compared) == (Occupied & Compared))
+				{
+					Entry.MeshIdx = (Rule.MeshIndex >= 0 && Rule.MeshIndex < NumMeshes) ? Rule.MeshIndex : INDEX_NONE;
+					Entry.Yaw = Rule.Yaw + (90.f * Turn);
+					Entry.bMatched = true;
+				}
+			}
+
+			if (Entry.bMatched) { break; }
+		}
+	}
+}
+
+uint8 FArenaAutoTileTable::RotateMask(uint8 Mask, int32 Turns)
+{
+	const int32 Shift = (Turns & 3) * 2;
+	return uint8((Mask << Shift) | (Mask >> (8 - Shift)));
+}
+
+void FArenaAutoTileTable::ComputeMasks(TArrayView<uint8> Occupancy, int32 Columns, int32 Rows, bool bWrapColumns, TArrayView<uint8> OutMasks)
+{
+	const int32 Width = Columns + 2;
+	check(Occupancy.Num() == Width * (Rows + 2) && OutMasks.Num() == Occupancy.Num());
+
+	if (bWrapColumns)
+	{
+		for (int32 Row = 0; Row < Rows + 2; ++Row)
+		{
+			uint8* Line = Occupancy.GetData() + Row * Width;
+			Line[0] = Line[Columns];
+			Line[Columns + 1] = Line[1];
+		}
+	}
+
+	for (int32 Row = 1; Row <= Rows; ++Row)
+	{
+		const uint8* RESTRICT Down = Occupancy.GetData() + (Row - 1) * Width;
+		const uint8* RESTRICT Mid = Down + Width;
+		const uint8* RESTRICT Up = Mid + Width;
+		uint8* RESTRICT Out = OutMasks.GetData() + Row * Width;
+
+		//Branchless so the row vectorizes, occupancy is 0 or 1
+		for (int32 Col = 1; Col <= Columns; ++Col)
+		{
+			Out[Col] = uint8(Up[Col]
+				| (Up[Col + 1] << 1)
+				| (Mid[Col + 1] << 2)
+				| (Down[Col + 1] << 3)
+				| (Down[Col] << 4)
+				| (Down[Col - 1] << 5)
+				| (Mid[Col - 1] << 6)
+				| (Up[Col - 1] << 7));
+		}
+	}
+}
+
+void FArenaCarveMask::Init(const FArenaPlannedPattern& Pattern)
+{
+	Slices = Pattern.Slices;
+	Columns = Pattern.Columns;
+	Rows = Pattern.Rows;
+	Cells.Empty();
+}
+
+void FArenaCarveMask::AddRange(FIntPoint SliceRange, FIntPoint ColumnRange, FIntPoint RowRange)
+{
+	if (Slices <= 0 || Columns <= 0 || Rows <= 0) { return; }
+
+	auto Resolve = [](FIntPoint Range, int32 Count)
+	{
+		return FIntPoint(FMath::Max(Range.X, 0), Range.Y < 0 ? Count - 1 : FMath::Min(Range.Y, Count - 1));
+	};
+	SliceRange = Resolve(SliceRange, Slices);
+	ColumnRange = Resolve(ColumnRange, Columns);
+	RowRange = Resolve(RowRange, Rows);
+
+	if (SliceRange.X > SliceRange.Y || ColumnRange.X > ColumnRange.Y || RowRange.X > RowRange.Y) { return; }
+
+	//Allocated by the first range so patterns without carving skip the test
+	if (Cells.IsEmpty()) { Cells.Init(false, Slices * Columns * Rows); }
+
+	for (int32 Slice = SliceRange.X; Slice <= SliceRange.Y; ++Slice)
+	{
+		for (int32 Row = RowRange.X; Row <= RowRange.Y; ++Row)
+		{
+			Cells.SetRange((Slice * Rows + Row) * Columns + ColumnRange.X, ColumnRange.Y - ColumnRange.X + 1, true);
+		}
+	}
+}
+
+void FArenaCarveMask::AddGridBox(const FBox& Box, const FVector& Origin, const FVector& Step)
+{
+	//Cells whose middle lies within the box along one axis, empty when X > Y
+	auto AxisRange = [](double Min, double Max, double AxisOrigin, double AxisStep)
+	{
+		if (FMath::IsNearlyZero(AxisStep)) {
+			return (AxisOrigin >= Min && AxisOrigin <= Max) ? FIntPoint(0, MAX_int32) : FIntPoint(1, 0);
+		}
+
+		const double First = (Min - AxisOrigin) / AxisStep;
+		const double Last = (Max - AxisOrigin) / AxisStep;
+		return FIntPoint(FMath::CeilToInt(FMath::Min(First, Last)), FMath::FloorToInt(FMath::Max(First, Last)));
+	};
+
+	const FIntPoint RowRange = AxisRange(Box.Min.X, Box.Max.X, Origin.X, Step.X);
+	const FIntPoint ColumnRange = AxisRange(Box.Min.Y, Box.Max.Y, Origin.Y, Step.Y);
+	const FIntPoint SliceRange = AxisRange(Box.Min.Z, Box.Max.Z, Origin.Z, Step.Z);
+
+	//Ranges entirely before the lattice would read as running to its end
+	if (RowRange.Y < 0 || ColumnRange.Y < 0 || SliceRange.Y < 0) { return; }
+
+	AddRange(SliceRange, ColumnRange, RowRange);
+}
+
+void FArenaCarveMask::AddLineBox(const FBox& Box, int32 Slice, int32 Row, const FVector& Start, const FVector& Step)
+{
+	//Clips the line of cell middles against the box, one slab per axis
+	double Enter = -DBL_MAX;
+	double Exit = DBL_MAX;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (FMath::IsNearlyZero(Step[Axis]))
+		{
+			if (Start[Axis] < Box.Min[Axis] || Start[Axis] > Box.Max[Axis]) { return; }
+			continue;
+		}
+
+		double Near = (Box.Min[Axis] - Start[Axis]) / Step[Axis];
+		double Far = (Box.Max[Axis] - Start[Axis]) / Step[Axis];
+		if (Near > Far) { Swap(Near, Far); }
+
+		Enter = FMath::Max(Enter, Near);
+		Exit = FMath::Min(Exit, Far);
+	}
+
+	if (Enter > Exit || Exit < 0.0) { return; }
+
+	const int32 FirstColumn = FMath::CeilToInt(FMath::Max(Enter, 0.0));
+	const int32 LastColumn = FMath::FloorToInt(FMath::Min(Exit, double(Columns - 1)));
+
+	AddRange(FIntPoint(Slice, Slice), FIntPoint(FirstColumn, LastColumn), FIntPoint(Row, Row));
+}
+
+void FArenaLayoutPlan::Reset()
+{
+	Patterns.Reset();
+	Tiles.Reset();
+	SubTiles.Reset();
+	SectionGeometry.Reset();
+	NumDuplicatesRemoved = 0;
+	Annotations.Reset();
+	TileGraph.Reset();
+}
+
+void FArenaLayoutPlan::Append(const FArenaLayoutPlan& Other)
+{
+	const int32 TileOffset = Tiles.Num();
+	const int32 SubTileOffset = SubTiles.Num();
+
+	for (const FArenaPlannedPattern& Pattern : Other.Patterns)
+	{
+		FArenaPlannedPattern& Added = Patterns.Add_GetRef(Pattern);
+		Added.FirstTile += TileOffset;
+		Added.FirstSubTile += SubTileOffset;
+	}
+
+	Tiles.Append(Other.Tiles);
+	SubTiles.Append(Other.SubTiles);
+	SectionGeometry.Append(Other.SectionGeometry);
+	NumDuplicatesRemoved += Other.NumDuplicatesRemoved;
+}
+
+FArenaLayoutPlanner::FArenaLayoutPlanner(const FArenaLayoutInputs& InInputs, const FRandomStream& InStream)
+	: Inputs(InInputs)
+	, Stream(InStream)
+{
+}
+
+bool FArenaLayoutPlanner::PlanLayout(FArenaLayoutPlan& OutPlan)
+{
+	OutPlan.Reset();
+	OutPlan.Seed = Stream.GetInitialSeed();
+	State = FArenaPlannerState();
+
+	if (Inputs.MeshGroups.IsEmpty() && Inputs.ActorGroups.IsEmpty()) {
+		ArenaGenLog_ErrorSilent("Cannot build sections with empty Mesh & Actor Groups!");
+		return false;
+	}
+
+	if (Inputs.SectionList.IsEmpty())
+	{
+		ArenaGenLog_WarningSilent("SectionList is empty! Arena generation is null.");
+		return false;
+	}
+
+	for (int32 i = 0; i < Inputs.SectionList.Num(); i++)
+	{
+		PlanSection(i, OutPlan);
+	}
+
+	//Sections are placed independently, overlaps are only known once all of them are planned
+	OutPlan.NumDuplicatesRemoved = RemoveDuplicateTiles(OutPlan);
+
+	if (Inputs.bBuildAnnotations) {
+		BuildAnnotations(OutPlan, Inputs, OutPlan.Annotations);
+	}
+
+	if (Inputs.bBuildTileGraph) {
+		FArenaTileGraph::Build(OutPlan, Inputs, OutPlan.TileGraph);
+	}
+
+	return !OutPlan.IsEmpty();
+}
+
+bool FArenaLayoutPlanner::PlanSection(int32 SectionIdx, FArenaLayoutPlan& OutPlan)
+{
+	if (!Inputs.SectionList.IsValidIndex(SectionIdx)) { return false; }
+
+	const FArenaSection& Section = Inputs.SectionList[SectionIdx];
+	if (!CalculateSectionParameters(Section)) { return false; }
+
+	OutPlan.SectionGeometry.Add(State.Geometry);
+
+	bool bPlannedAny = false;
+	for (int32 j = 0; j < Section.BuildRules.Num(); j++)
+	{
+		bPlannedAny |= PlanPattern(Section.BuildRules[j], SectionIdx, j, OutPlan);
+	}
+
+	return bPlannedAny;
+}
+
+bool FArenaLayoutPlanner::PlanSectionBand(int32 SectionIdx, FArenaLayoutPlan& OutPlan)
+{
+	if (!Inputs.SectionList.IsValidIndex(SectionIdx)) { return false; }
+
+	const FArenaSection& Section = Inputs.SectionList[SectionIdx];
+
+	//Section parameters reset the origin, only keep the height reached so far
+	const float BandBase = State.OriginOffset.Z;
+	if (!CalculateSectionParameters(Section)) { return false; }
+	State.OriginOffset.Z = BandBase;
+
+	OutPlan.SectionGeometry.Add(State.Geometry);
+
+	bool bPlannedAny = false;
+	for (int32 j = 0; j < Section.BuildRules.Num(); j++)
+	{
+		bPlannedAny |= PlanPattern(Section.BuildRules[j], SectionIdx, j, OutPlan);
+	}
+
+	//Bands are committed on their own, so only overlaps within the band are found
+	OutPlan.NumDuplicatesRemoved += RemoveDuplicateTiles(OutPlan);
+
+	return bPlannedAny;
+}
+
+bool FArenaLayoutPlanner::PredictSectionTiles(const FArenaSection& Section, int32& OutMeshTiles, int32& OutActorTiles)
+{
+	if (!CalculateSectionParameters(Section)) { return false; }
+
+	for (int32 j = 0; j < Section.BuildRules.Num(); j++)
+	{
+		const FArenaSectionBuildRules& Rules = Section.BuildRules[j];
+
+		FArenaPlannedPattern Pattern;
+		if (!PreparePattern(Rules, INDEX_NONE, j, Pattern)) { continue; }
+
+		const int32 NumTiles = Pattern.Slices * Pattern.Columns * Pattern.Rows;
+		(Pattern.AssetToPlace == ETypeToPlace::Actors ? OutActorTiles : OutMeshTiles) += NumTiles;
+
+		//Same state updates as planning the pattern, the next pattern's extents depend on them
+		if (Rules.SectionType == EArenaSectionType::Polygon) { State.PreviousTilesPerSide = Pattern.TilesPerSide; }
+		State.PreviousMeshSize = Pattern.MeshSize;
+	}
+
+	return true;
+}
+
+bool FArenaLayoutPlanner::CalculateSectionParameters(const FArenaSection& Section)
+{
+	if (Inputs.MeshGroups.IsEmpty()) { 
+		if (!bQuiet) { ArenaGenLog_ErrorSilent("Cannot calculate section parameters with empty Mesh Groups!"); }
+		return false;
+	}
+
+	const TArray<FArenaMeshGroupConfig>& MeshGroups = Inputs.MeshGroups;
+	FArenaSectionGeometry& Geometry = State.Geometry;
+
+	State.OriginOffset = FVector(0);
+
+	//Determine best starting indices for patterns
+	bool bGrided = false;
+	bool bPolygoned = false;
+
+	for (int32 i = 0; i < Section.BuildRules.Num(); i++) {
+		if (bGrided && bPolygoned) { break; }
+		if (Section.BuildRules[i].SectionType == EArenaSectionType::HorizontalGrid && !bGrided) { State.FocusGridIndex = Section.BuildRules[i].ObjectGroupId; bGrided = true; }
+		if (Section.BuildRules[i].SectionType == EArenaSectionType::Polygon && !bPolygoned) { State.FocusPolygonIndex = Section.BuildRules[i].ObjectGroupId; bPolygoned = true; }
+	}
+
+	//Focus indices index mesh groups, keep them in bounds
+	const int32 FocusGridIndex = MeshGroups.IsValidIndex(State.FocusGridIndex) ? State.FocusGridIndex : 0;
+	const int32 FocusPolygonIndex = MeshGroups.IsValidIndex(State.FocusPolygonIndex) ? State.FocusPolygonIndex : 0;
+
+	//CALCULATE SECTION PARAMETERS
+	//The solver applies the build order rules, then makes sure wall tiles fit on the sides and the tile budget is respected
+	FArenaFitInputs FitInputs;
+	FitInputs.BuildOrderRules = Section.SectionBuildOrderRules;
+	FitInputs.Targets = Section.Targets;
+	FitInputs.GridTileSize = MeshGroups[FocusGridIndex].MeshDimensions.X;
+	FitInputs.WallTileSize = MeshGroups[FocusPolygonIndex].MeshDimensions.X;
+	FitInputs.MaxSides = Inputs.MaxSides;
+	FitInputs.MaxTilesPerSideRow = Inputs.MaxTilesPerSideRow;
+
+	SectionFit = FArenaFitSolver::Solve(FitInputs);
+	const FArenaFitResult& Fit = SectionFit;
+	if (Fit.bAdjusted && !bQuiet)
+	{
+		ArenaGenLog_WarningSilent("Section targets adjusted to fit: %d sides, %d grid dimensions, %d tiles per side.", Fit.ArenaSides, Fit.ArenaDimensions, Fit.TilesPerArenaSide);
+	}
+	if (!Fit.bWithinBudget && !bQuiet)
+	{
+		ArenaGenLog_WarningSilent("Section cannot fit in a budget of %d tiles, using the smallest arena (%d tiles).", Section.Targets.TileBudget, Fit.NumTiles);
+	}
+
+	Geometry.BuildOrderRules = Section.SectionBuildOrderRules;
+	Geometry.ArenaSides = Fit.ArenaSides;
+	Geometry.InteriorAngle = Fit.InteriorAngle;
+	Geometry.ExteriorAngle = 360.f / Geometry.ArenaSides;
+	Geometry.ArenaDimensions = Fit.ArenaDimensions;
+	Geometry.TilesPerArenaSide = Fit.TilesPerArenaSide;
+	Geometry.InscribedRadius = Fit.InscribedRadius;
+	Geometry.SideLength = Fit.SideLength;
+	Geometry.Apothem = Fit.Apothem;
+
+	return true;
+}
+
+void FArenaLayoutPlanner::GetCarveVolumes(int32 SectionIdx, int32 PatternIdx, TArray<const FArenaCarveVolume*>& OutVolumes) const
+{
+	OutVolumes.Reset();
+	if (!Inputs.SectionList.IsValidIndex(SectionIdx)) { return; }
+
+	for (const FArenaCarveVolume& Volume : Inputs.SectionList[SectionIdx].CarveVolumes)
+	{
+		if (Volume.AppliesTo(PatternIdx)) {
+			OutVolumes.Add(&Volume);
+		}
+	}
+}
+
+bool FArenaLayoutPlanner::PreparePattern(const FArenaSectionBuildRules& Rules, int32 SectionIdx, int32 PatternIdx, FArenaPlannedPattern& Pattern)
+{
+	const TArray<FArenaMeshGroupConfig>& MeshGroups = Inputs.MeshGroups;
+	const TArray<FArenaActorConfig>& ActorGroups = Inputs.ActorGroups;
+	const FArenaSectionGeometry& Geometry = State.Geometry;
+
+	if(Rules.AssetToPlace == ETypeToPlace::StaticMeshes && MeshGroups.IsEmpty())
+	{
+		if (!bQuiet) { ArenaGenLog_ErrorSilent("Cannot build section pattern because associated mesh group is invalid OR mesh groups are empty."); }
+		return false; 
+	}
+	else if (Rules.AssetToPlace == ETypeToPlace::Actors && ActorGroups.IsEmpty())
+	{
+		if (!bQuiet) { ArenaGenLog_ErrorSilent("Cannot build section pattern because associated actor group is invalid OR actor groups are empty."); }
+		return false;
+	}
+
+	const int32 SectionAmount = FMath::Max(Rules.SectionAmount, 1); //Make sure section amount is not negative or zero
+
+	Pattern.SectionIdx = SectionIdx;
+	Pattern.PatternIdx = PatternIdx;
+	Pattern.SectionType = Rules.SectionType;
+	Pattern.AssetToPlace = Rules.AssetToPlace;
+
+	switch (Rules.AssetToPlace)
+	{
+		default:
+		case ETypeToPlace::StaticMeshes:
+		{
+			Pattern.AssetToPlace = ETypeToPlace::StaticMeshes;
+
+			//Clamp MeshGroup index so that we do not search outside of its bounds
+			Pattern.GroupIdx = (Rules.ObjectGroupId < MeshGroups.Num() && Rules.ObjectGroupId > 0) ? Rules.ObjectGroupId : 0;
+
+			if (MeshGroups[Pattern.GroupIdx].GroupMeshes.IsEmpty())
+			{
+				if (!bQuiet) { ArenaGenLog_ErrorSilent("Cannot build section pattern because mesh group %d has no meshes.", Pattern.GroupIdx); }
+				return false;
+			}
+
+			//Determine arena parameters based off of current origin offsets etc.
+			Pattern.MeshSize = MeshGroups[Pattern.GroupIdx].MeshDimensions;
+			Pattern.MeshScale = MeshGroups[Pattern.GroupIdx].MeshScale;
+		}break;
+		case ETypeToPlace::Actors:
+		{
+			Pattern.GroupIdx = (Rules.ObjectGroupId < ActorGroups.Num() && Rules.ObjectGroupId > 0) ? Rules.ObjectGroupId : 0;
+
+			if (ActorGroups[Pattern.GroupIdx].ClassesToSpawn.IsEmpty())
+			{
+				if (!bQuiet) { ArenaGenLog_ErrorSilent("Cannot build section pattern because actor group %d has no classes to spawn.", Pattern.GroupIdx); }
+				return false;
+			}
+
+			Pattern.MeshSize = ActorGroups[Pattern.GroupIdx].ActorDimensions;
+			Pattern.MeshScale = ActorGroups[Pattern.GroupIdx].ActorScale;
+		}break;
+	}
+
+	const FVector MeshSize = Pattern.MeshSize;
+
+	if (State.PreviousMeshSize == FVector(0)) { State.PreviousMeshSize = MeshSize; } 
+	float MeshScalar = State.PreviousMeshSize.X != 0.f ? MeshSize.X / State.PreviousMeshSize.X: 1.f;
+
+	//TODO - adjust curr tiles per side to init and per-iteration width offsets
+	int CurrTilesPerSide = MeshScalar == 1.f ? Geometry.TilesPerArenaSide : //Tiles per Side of the pattern
+		FMath::Clamp(FMath::Floor((2.f * CalculateOpposite(Geometry.InscribedRadius, Geometry.InteriorAngle / 2.f)) / MeshSize.X), 1, Inputs.MaxTilesPerSideRow);
+
+	if (State.PreviousTilesPerSide == 0) { State.PreviousTilesPerSide = Geometry.TilesPerArenaSide; } // Prev Tiles cannot be zero
+
+	Pattern.TilesPerSide = CurrTilesPerSide;
+
+	//Lattice extents
+	switch (Rules.SectionType) {
+		case EArenaSectionType::Polygon:
+		{
+			Pattern.Slices = Geometry.ArenaSides;
+			Pattern.Columns = CurrTilesPerSide;
+			Pattern.Rows = SectionAmount;
+		}break;
+		case EArenaSectionType::HorizontalGrid:
+		{
+			const int32 SectionDimensions = (MeshSize.X == State.PreviousMeshSize.X) ? Geometry.ArenaDimensions :
+				FMath::Floor((2.f * Geometry.SideLength) / MeshSize.X);
+
+			Pattern.Slices = SectionAmount;
+			Pattern.Columns = FMath::Max(SectionDimensions, 0);
+			Pattern.Rows = FMath::Max(SectionDimensions, 0);
+		}break;
+	}
+
+	return true;
+}
+
+
+bool FArenaLayoutPlanner::PlanPattern(const FArenaSectionBuildRules& Rules, int32 SectionIdx, int32 PatternIdx, FArenaLayoutPlan& OutPlan)
+{
+	const FArenaSectionGeometry& Geometry = State.Geometry;
+
+	FArenaPlannedPattern Pattern;
+	if (!PreparePattern(Rules, SectionIdx, PatternIdx, Pattern)) { return false; }
+
+	const int32 SectionAmount = FMath::Max(Rules.SectionAmount, 1); //Make sure section amount is not negative or zero
+	const FVector MeshSize = Pattern.MeshSize;
+	const FVector MeshScale = Pattern.MeshScale;
+	const int CurrTilesPerSide = Pattern.TilesPerSide;
+
+	float HeightAdjustment = MeshSize.Z * Rules.InitOffsetByHeightScalar;
+	bool bConcavity = Rules.bWarpPlacement && Rules.WarpConcavityStrength != 0.f;
+
+	//Update Origin Offset based on Arena placement on actor option and previous parameters
+	State.OriginOffset = CalculatePatternOrigin(Rules.SectionType, MeshSize, MeshScale, CurrTilesPerSide);
+	const FVector OriginOffset = State.OriginOffset;
+
+	//Update rotation parameters
+	float RotationIncr = 360.f / Rules.YawPossibilities;
+	int YawPosMax = FMath::Clamp(Rules.YawPossibilities-1, 2, 720);
+
+	Pattern.FirstTile = OutPlan.Tiles.Num();
+
+	//Carve volumes become lattice ranges before any tile is placed. Carved tiles still draw from the stream so the rest of the layout stays the same.
+	TArray<const FArenaCarveVolume*> CarveVolumes;
+	GetCarveVolumes(SectionIdx, PatternIdx, CarveVolumes);
+
+	FArenaCarveMask Carve;
+	Carve.Init(Pattern);
+	for (const FArenaCarveVolume* Volume : CarveVolumes)
+	{
+		if (Volume->Shape == EArenaCarveShape::LatticeRange)
+		{
+			Carve.AddRange(Volume->Slices, Volume->Columns, Volume->Rows);
+		}
+		else if (Rules.SectionType == EArenaSectionType::HorizontalGrid)
+		{
+			//Middle of the cells before rotation offsets and warping, rows along X and columns along Y
+			Carve.AddGridBox(Volume->Box
+				, OriginOffset + FVector(0.5f * MeshSize.X, 0.5f * MeshSize.X, HeightAdjustment + 0.5f * MeshSize.Z)
+				, FVector(MeshSize.X * MeshScale.X, MeshSize.Y * MeshScale.Y, MeshSize.Z));
+		}
+	}
+
+	//Build Section
+	switch (Rules.SectionType) {
+		case EArenaSectionType::Polygon:
+		{
+			OutPlan.Tiles.Reserve(OutPlan.Tiles.Num() + Pattern.Slices * Pattern.Columns * Pattern.Rows);
+
+			FVector LastCachedPosition{ 0 };
+			FVector SideAngleFV{ 0 };
+
+			//Concavity only depends on the tile's position along the side and its height, so it is shared by every side
+			FArenaConcavityTable Concavity;
+			if (bConcavity) { Concavity.Build(CurrTilesPerSide / 2, CurrTilesPerSide / 2, CurrTilesPerSide, SectionAmount, Rules.WarpConcavityStrength); }
+
+			//Pivot offsets depend on the side's yaw, the table is rebuilt per side for every yaw possibility
+			TArray<FVector> PivotOffsets;
+			GetPivotOffsets(Inputs, Pattern, PivotOffsets);
+			FArenaPivotTable PivotTable;
+
+			for (int SideIdx = 0; SideIdx < Geometry.ArenaSides; ++SideIdx) //ArenaSides
+			{
+				//Cache last used position to update through next loop
+				LastCachedPosition = LastCachedPosition + ((SideAngleFV * MeshSize.X));
+
+				//Determine forward vector for placement
+				SideAngleFV = ForwardVectorFromYaw(Geometry.ExteriorAngle * SideIdx);
+
+				//Cache Yaw rotation for the side
+				float YawRotation = (360.f / Geometry.ArenaSides) * SideIdx;
+
+				//Determine right vector for placement offsets
+				FVector SideAngleRV = FRotationMatrix(FRotator(0, YawRotation, 0)).GetScaledAxis(EAxis::Y);
+
+				if (Rules.RotationRule != EPlacementOrientationRule::RotateYawRandomly) {
+					PivotTable.Build(PivotOffsets, Rules.DefaultRotation.Yaw + YawRotation, RotationIncr, YawPosMax + 1);
+				}
+
+				//Boxes become a range of positions along the side for each height band
+				for (const FArenaCarveVolume* Volume : CarveVolumes)
+				{
+					if (Volume->Shape != EArenaCarveShape::Box) { continue; }
+
+					for (int HeightIdx = 0; HeightIdx < SectionAmount; ++HeightIdx)
+					{
+						const FVector BandStart = LastCachedPosition + OriginOffset
+							+ FVector(0, 0, (MeshSize.Z * (HeightIdx * Rules.OffsetByHeightIncrement)) + HeightAdjustment + 0.5f * MeshSize.Z)
+							+ (SideAngleRV * MeshSize.Y * (Rules.InitOffsetByWidthScalar + Rules.OffsetByWidthIncrement * HeightIdx))
+							+ (SideAngleFV * 0.5f * MeshSize.X);
+
+						Carve.AddLineBox(Volume->Box, SideIdx, HeightIdx, BandStart, SideAngleFV * MeshSize.X);
+					}
+				}
+
+				for (int LenIdx = 0; LenIdx < CurrTilesPerSide; ++LenIdx) //CurrTilesPerSide
+				{
+					LastCachedPosition = (SideAngleFV * MeshSize.X * (LenIdx > 0 ? 1 : 0)) + LastCachedPosition;
+
+					for (int HeightIdx = 0; HeightIdx < SectionAmount; ++HeightIdx)
+					{
+						//TODO - determine meshIdx
+						int MeshIdx = 0;
+
+						//Cache value for rotational mesh offsets
+						int RandomVal{ 0 };
+
+						switch (Rules.RotationRule) {
+						case EPlacementOrientationRule::RotateByYP:
+							RandomVal = Stream.RandRange(0, YawPosMax);
+							break;
+						case EPlacementOrientationRule::RotateYawRandomly:
+							YawRotation = Stream.FRandRange(0, 360.f);
+							break;
+						}
+
+						FVector RotationOffsetAdjustment = FVector(0);
+
+						//We rotate the mesh around its center and reposition it by its half size after the calculation.
+						if (Rules.AssetToPlace == ETypeToPlace::StaticMeshes)
+						{
+							RotationOffsetAdjustment = (Rules.RotationRule == EPlacementOrientationRule::RotateYawRandomly
+								? PivotRotationOffset(PivotOffsets[MeshIdx], Rules.DefaultRotation.Yaw + YawRotation)
+								: PivotTable.Get(MeshIdx, RandomVal))
+							+ SideAngleFV * (FVector(0.5, 0.5, 0) * MeshSize.X);
+						}
+
+						FVector Location = LastCachedPosition // Iterate on position...
+							+ OriginOffset // Offset by the origin of our section 
+							+ FVector(0, 0, (MeshSize.Z * (HeightIdx * Rules.OffsetByHeightIncrement)) + HeightAdjustment) // Height Adjustment
+							+ (SideAngleRV * MeshSize.Y * Rules.InitOffsetByWidthScalar) // Initial width offset
+							+ (SideAngleRV * MeshSize.Y * Rules.OffsetByWidthIncrement * HeightIdx) // Offset by width each height increment
+							+ RotationOffsetAdjustment // Adjust by offset caused by rotation and mesh origin type
+							+ (bConcavity ? SideAngleRV * Concavity.Get(LenIdx, HeightIdx) : FVector(0.f)); // Concavity
+
+						//A warp field replaces the random warp, it is applied once the pattern's tiles are placed
+						if (Rules.bWarpPlacement && !Rules.WarpField.IsEnabled())
+						{
+							Location += PlacementWarpingDirectional(Rules.WarpRange, SideAngleFV, SideAngleRV); //Warping along placement
+						}
+
+						if (Carve.IsCarved(SideIdx, LenIdx, HeightIdx)) {
+							Pattern.NumCarvedTiles++;
+							continue;
+						}
+
+						FArenaPlannedTile& Tile = OutPlan.Tiles.AddDefaulted_GetRef();
+						Tile.MeshIdx = MeshIdx;
+						Tile.Coord = FArenaTileCoord{ SideIdx, LenIdx, HeightIdx };
+						Tile.Transform = FTransform(
+						//ROTATION
+							FRotator(
+							Rules.DefaultRotation.Pitch  //Pitch
+							, Rules.DefaultRotation.Yaw + YawRotation + (RotationIncr * RandomVal) //Yaw
+							, Rules.DefaultRotation.Roll), //Roll
+						//LOCATION
+							Location
+						//SCALE
+							, FVector( MeshScale.X, MeshScale.Y, MeshScale.Z));
+					}
+				}
+			}
+
+			//Cache values before scope ends
+			State.PreviousTilesPerSide = CurrTilesPerSide;
+			State.PreviousLastPosition = LastCachedPosition;
+		}
+		break;
+
+		case EArenaSectionType::HorizontalGrid:
+		{
+			const int SectionDimensions = Pattern.Columns;
+			OutPlan.Tiles.Reserve(OutPlan.Tiles.Num() + Pattern.Slices * Pattern.Columns * Pattern.Rows);
+
+			FVector PlacementFV = FVector(1.f, 0.f, 0.f);
+			FVector PlacementRV = FVector(0.f, 1.f, 0.f);
+
+			//Same concavity for every repetition of the grid, indexed by (Row, Col)
+			FArenaConcavityTable Concavity;
+			if (bConcavity) { Concavity.Build(CurrTilesPerSide / 2, CurrTilesPerSide / 2, SectionDimensions, SectionDimensions, Rules.WarpConcavityStrength); }
+
+			//Grid tiles share one yaw base, only the yaw possibility changes per tile
+			TArray<FVector> PivotOffsets;
+			GetPivotOffsets(Inputs, Pattern, PivotOffsets);
+			FArenaPivotTable PivotTable;
+			PivotTable.Build(PivotOffsets, Rules.DefaultRotation.Yaw, RotationIncr, YawPosMax + 1);
+
+			for (int TimesIdx = 0; TimesIdx < SectionAmount; TimesIdx++) {
+				for (int Row = 0; Row < SectionDimensions; Row++) {
+					for (int Col = 0; Col < SectionDimensions; Col++) {
+
+						//TODO - determine meshIdx
+						int MeshIdx = 0;
+
+						//Rotation values
+						int RandomVal=0;
+						float YawRotation{ 0.f };
+
+						switch (Rules.RotationRule) {
+							
+							case EPlacementOrientationRule::RotateByYP:
+							{
+								RandomVal = Stream.RandRange(0, YawPosMax);
+							}break;
+							case EPlacementOrientationRule::RotateYawRandomly:
+							{
+								YawRotation = Stream.FRandRange(0, 360.f);
+							}break;
+						}
+						
+						FVector RotationOffsetAdjustment =
+							(Rules.RotationRule == EPlacementOrientationRule::RotateYawRandomly
+								? PivotRotationOffset(PivotOffsets[MeshIdx], Rules.DefaultRotation.Yaw + YawRotation)
+								: PivotTable.Get(MeshIdx, RandomVal))
+							+ (FVector(0.5, 0.5, 0) * MeshSize.X);
+
+						FVector Location = OriginOffset //Cached Origin offset
+							+ FVector(0, 0, (MeshSize.Z * TimesIdx) + HeightAdjustment) //Height Offset for section amount and initial height adjustment
+							+ (PlacementFV * MeshSize.X * MeshScale.X * Row) // Relative X placement
+							+ (PlacementRV * MeshSize.Y * MeshScale.Y * Col) // Relative Y Placement
+							+ RotationOffsetAdjustment; //Offset from rotation by OriginType
+
+						if (Rules.bWarpPlacement && !Rules.WarpField.IsEnabled())
+						{
+							Location += PlacementWarpingDirectional(Rules.WarpRange, FVector(1, 0, 0), FVector(0, 1, 0)); //Warping along placement
+						}
+
+						if (bConcavity)
+						{
+							Location += FVector(0.f, 0.f, Concavity.Get(Row, Col));
+						}
+
+						if (Carve.IsCarved(TimesIdx, Col, Row)) {
+							Pattern.NumCarvedTiles++;
+							continue;
+						}
+
+						FArenaPlannedTile& Tile = OutPlan.Tiles.AddDefaulted_GetRef();
+						Tile.MeshIdx = MeshIdx;
+						Tile.Coord = FArenaTileCoord{ TimesIdx, Col, Row };
+						Tile.Transform = FTransform(
+							//ROTATION
+							FRotator(
+								Rules.DefaultRotation.Pitch  //Pitch
+								, YawRotation + (RotationIncr * RandomVal) //+ Rules.DefaultRotation.Yaw //Yaw
+								, Rules.DefaultRotation.Roll //Roll
+							),
+							//LOCATION
+							Location
+							//SCALE
+							, MeshScale
+						);
+					}
+				}
+			}
+		}
+		break;
+	}
+
+	Pattern.NumTiles = OutPlan.Tiles.Num() - Pattern.FirstTile;
+
+	//Neighbors are known once the whole lattice is planned. Autotiling draws nothing from the stream.
+	SolveAdjacency(Pattern, OutPlan);
+	ApplyAutoTiling(Pattern, OutPlan);
+
+	//Noise is seeded from the plan and sampled by position, so it draws nothing from the stream
+	if (Rules.bWarpPlacement && Rules.WarpField.IsEnabled())
+	{
+		ApplyWarpField(Rules.WarpField, Pattern, OutPlan);
+	}
+
+	//Sub meshes follow their tile, so they are placed once the tile is final
+	AddSubTiles(Pattern, OutPlan);
+
+	if (Rules.bUpdatesOriginOffsetHeight) {
+		State.OriginOffset = FVector(OriginOffset.X, OriginOffset.Y, OriginOffset.Z + (MeshSize.Z * SectionAmount * Rules.OffsetByHeightIncrement)); // Update OriginOffset by height of mesh times scalar of height increment
+	}
+
+	//Cache values for next section
+	State.PreviousMeshSize = MeshSize;
+
+	OutPlan.Patterns.Add(Pattern);
+
+	return Pattern.NumTiles > 0;
+}
+
+void FArenaLayoutPlanner::ApplyAutoTiling(const FArenaPlannedPattern& Pattern, FArenaLayoutPlan& OutPlan) const
+{
+	if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes || Pattern.NumTiles <= 0) { return; }
+
+	const FArenaMeshGroupConfig& Group = Inputs.MeshGroups[Pattern.GroupIdx];
+	if (!Group.bAutoTile || Group.AutoTileRules.IsEmpty()) { return; }
+
+	FArenaAutoTileTable Table;
+	Table.Build(Group.AutoTileRules, Group.GroupMeshes.Num());
+
+	//Polygon sides are laid end to end in one plane wrapping around, so side seams see the next side. Grids get a plane per repetition.
+	const bool bPolygon = Pattern.SectionType == EArenaSectionType::Polygon;
+	const int32 NumPlanes = bPolygon ? 1 : Pattern.Slices;
+	const int32 Columns = bPolygon ? Pattern.Slices * Pattern.Columns : Pattern.Columns;
+	const int32 Rows = Pattern.Rows;
+	const int32 Width = Columns + 2;
+	const int32 PlaneSize = Width * (Rows + 2);
+
+	auto CellOf = [&](const FArenaTileCoord& Coord) -> int32
+	{
+		const int32 Plane = bPolygon ? 0 : Coord.Slice;
+		const int32 Col = bPolygon ? Coord.Slice * Pattern.Columns + Coord.Column : Coord.Column;
+		return Plane * PlaneSize + (Coord.Row + 1) * Width + (Col + 1);
+	};
+
+	TArrayView<FArenaPlannedTile> Tiles(OutPlan.Tiles.GetData() + Pattern.FirstTile, Pattern.NumTiles);
+
+	TArray<uint8> Occupancy;
+	Occupancy.SetNumZeroed(NumPlanes * PlaneSize);
+	for (const FArenaPlannedTile& Tile : Tiles)
+	{
+		Occupancy[CellOf(Tile.Coord)] = 1;
+	}
+
+	TArray<uint8> Masks;
+	Masks.SetNumZeroed(Occupancy.Num());
+	for (int32 Plane = 0; Plane < NumPlanes; ++Plane)
+	{
+		FArenaAutoTileTable::ComputeMasks(TArrayView<uint8>(Occupancy.GetData() + Plane * PlaneSize, PlaneSize), Columns, Rows, bPolygon,
+			TArrayView<uint8>(Masks.GetData() + Plane * PlaneSize, PlaneSize));
+	}
+
+	TArray<FVector> PivotOffsets;
+	GetPivotOffsets(Inputs, Pattern, PivotOffsets);
+
+	for (FArenaPlannedTile& Tile : Tiles)
+	{
+		const FArenaAutoTileTable::FEntry& Entry = Table.Entries[Masks[CellOf(Tile.Coord)]];
+		if (!Entry.bMatched) { continue; }
+
+		SetTileMesh(Tile, Entry.MeshIdx != INDEX_NONE ? Entry.MeshIdx : Tile.MeshIdx, Entry.Yaw, PivotOffsets);
+	}
+}
+
+void FArenaLayoutPlanner::SolveAdjacency(FArenaPlannedPattern& Pattern, FArenaLayoutPlan& OutPlan)
+{
+	if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes || Pattern.NumTiles <= 0) { return; }
+
+	const FArenaMeshGroupConfig& Group = Inputs.MeshGroups[Pattern.GroupIdx];
+	if (!Group.bSolveAdjacency) { return; }
+
+	FArenaAdjacencyRules Rules;
+	if (!Rules.BuildFromGroup(Group))
+	{
+		if (!bQuiet) {
+			ArenaGenLog_WarningSilent("Mesh group %d cannot solve adjacency with %d meshes (1 to %d), keeping planned meshes.",
+				Pattern.GroupIdx, Group.GroupMeshes.Num(), FArenaAdjacencyRules::MaxMeshes);
+		}
+		return;
+	}
+
+	//Attempts are seeded from here, so they do not depend on how many retries each slice needed
+	const int32 Seed = Stream.RandHelper(MAX_int32);
+
+	TArray<FVector> PivotOffsets;
+	GetPivotOffsets(Inputs, Pattern, PivotOffsets);
+
+	TArrayView<FArenaPlannedTile> Tiles(OutPlan.Tiles.GetData() + Pattern.FirstTile, Pattern.NumTiles);
+
+	FArenaAdjacencySolver Solver(Rules);
+	FArenaAdjacencyResult Result;
+	TArray<TArray<int32>> SliceMeshes;
+	SliceMeshes.SetNum(Pattern.Slices);
+	int32 NumFailed = 0;
+	double Seconds = 0.0;
+
+	//Grid repetitions and polygon sides are solved as separate planes of columns by rows
+	for (int32 Slice = 0; Slice < Pattern.Slices; ++Slice)
+	{
+		Solver.Solve(Pattern.Columns, Pattern.Rows, int32(uint32(Seed) + uint32(Slice) * 7919u), Group.AdjacencyAttempts, Result);
+
+		Pattern.AdjacencyAttempts += Result.Attempts;
+		Pattern.AdjacencyContradictions += Result.Contradictions;
+		NumFailed += Result.IsSolved() ? 0 : 1;
+		Seconds += Result.Seconds;
+
+		SliceMeshes[Slice] = MoveTemp(Result.Meshes);
+	}
+
+	for (FArenaPlannedTile& Tile : Tiles)
+	{
+		//Unsolved slices keep their planned meshes
+		const int32 Slice = Tile.Coord.Slice;
+		if (!SliceMeshes.IsValidIndex(Slice) || SliceMeshes[Slice].IsEmpty()) { continue; }
+
+		SetTileMesh(Tile, SliceMeshes[Slice][Tile.Coord.Row * Pattern.Columns + Tile.Coord.Column], 0.f, PivotOffsets);
+	}
+
+	//Solved patterns are counted on the pattern, only contradictions and fallbacks are worth a line per plan
+	if (!bQuiet && (NumFailed > 0 || Pattern.AdjacencyContradictions > 0))
+	{
+		ArenaGenLog_WarningSilent("Adjacency of section %d pattern %d: %d attempts, %d contradictions, %d of %d slices unsolved kept planned meshes (%.3f ms)",
+			Pattern.SectionIdx, Pattern.PatternIdx, Pattern.AdjacencyAttempts, Pattern.AdjacencyContradictions, NumFailed, Pattern.Slices, Seconds * 1000.0);
+	}
+}
+
+void FArenaLayoutPlanner::SetTileMesh(FArenaPlannedTile& Tile, int32 NewMeshIdx, float AddedYaw, TConstArrayView<FVector> PivotOffsets)
+{
+	if (NewMeshIdx == Tile.MeshIdx && AddedYaw == 0.f) { return; }
+
+	//Tiles are placed at their pivot, keep the center where it was when the mesh or yaw changes
+	FRotator Rotation = Tile.Transform.Rotator();
+	const FVector OldPivot = PivotOffsets.IsValidIndex(Tile.MeshIdx) ? PivotOffsets[Tile.MeshIdx] : FVector(0);
+	const FVector NewPivot = PivotOffsets.IsValidIndex(NewMeshIdx) ? PivotOffsets[NewMeshIdx] : FVector(0);
+	const FVector Center = Tile.Transform.GetLocation() + FRotator(0, Rotation.Yaw, 0).RotateVector(FVector(OldPivot.X, OldPivot.Y, 0));
+
+	Rotation.Yaw += AddedYaw;
+	Tile.Transform.SetRotation(Rotation.Quaternion());
+	Tile.Transform.SetLocation(Center - FRotator(0, Rotation.Yaw, 0).RotateVector(FVector(NewPivot.X, NewPivot.Y, 0)));
+	Tile.MeshIdx = NewMeshIdx;
+}
+
+int32 FArenaLayoutPlanner::RemoveDuplicateTiles(FArenaLayoutPlan& OutPlan) const
+{
+	if (!Inputs.bRemoveDuplicateTiles || OutPlan.Tiles.IsEmpty()) { return 0; }
+
+	const double Tolerance = FMath::Max(double(Inputs.DuplicateTolerance), UE_KINDA_SMALL_NUMBER);
+	const double ToleranceSquared = Tolerance * Tolerance;
+	constexpr float YawTolerance = 1.f;
+
+	auto GetPriority = [this](const FArenaPlannedPattern& Pattern) -> int32
+	{
+		const FArenaSection* Section = Inputs.SectionList.IsValidIndex(Pattern.SectionIdx) ? &Inputs.SectionList[Pattern.SectionIdx] : nullptr;
+		return Section && Section->BuildRules.IsValidIndex(Pattern.PatternIdx) ? Section->BuildRules[Pattern.PatternIdx].DuplicatePriority : 0;
+	};
+
+	TArray<int32> PatternOrder;
+	PatternOrder.Reserve(OutPlan.Patterns.Num());
+	for (int32 PatternIdx = 0; PatternIdx < OutPlan.Patterns.Num(); ++PatternIdx)
+	{
+		PatternOrder.Add(PatternIdx);
+	}
+	Algo::StableSort(PatternOrder, [&](int32 A, int32 B) { return GetPriority(OutPlan.Patterns[A]) > GetPriority(OutPlan.Patterns[B]); });
+
+	//Kept tiles by position cell, meshes and actors never replace each other
+	TMultiMap<FIntVector, int32> KeptTiles[2];
+	KeptTiles[0].Reserve(OutPlan.Tiles.Num());
+
+	TBitArray<> Removed(false, OutPlan.Tiles.Num());
+	int32 NumRemoved = 0;
+
+	for (const int32 PatternIdx : PatternOrder)
+	{
+		const FArenaPlannedPattern& Pattern = OutPlan.Patterns[PatternIdx];
+		TMultiMap<FIntVector, int32>& Kept = KeptTiles[Pattern.AssetToPlace == ETypeToPlace::Actors ? 1 : 0];
+
+		for (int32 TileIdx = Pattern.FirstTile; TileIdx < Pattern.FirstTile + Pattern.NumTiles; ++TileIdx)
+		{
+			const FTransform& Transform = OutPlan.Tiles[TileIdx].Transform;
+			const FVector Location = Transform.GetLocation();
+			const float Yaw = Transform.Rotator().Yaw;
+			const FIntVector Cell(FMath::FloorToInt(Location.X / Tolerance), FMath::FloorToInt(Location.Y / Tolerance), FMath::FloorToInt(Location.Z / Tolerance));
+
+			//Coincident tiles within tolerance can straddle a cell boundary
+			bool bDuplicate = false;
+			for (int32 Neighbor = 0; Neighbor < 27 && !bDuplicate; ++Neighbor)
+			{
+				const FIntVector NeighborCell = Cell + FIntVector(Neighbor % 3 - 1, (Neighbor / 3) % 3 - 1, Neighbor / 9 - 1);
+
+				for (auto It = Kept.CreateConstKeyIterator(NeighborCell); It && !bDuplicate; ++It)
+				{
+					const FTransform& Other = OutPlan.Tiles[It.Value()].Transform;
+					if (FVector::DistSquared(Location, Other.GetLocation()) > ToleranceSquared) { continue; }
+
+					bDuplicate = Inputs.bDuplicatesIgnoreYaw || FMath::Abs(FRotator::NormalizeAxis(Yaw - Other.Rotator().Yaw)) <= YawTolerance;
+				}
+			}
+
+			if (bDuplicate)
+			{
+				Removed[TileIdx] = true;
+				NumRemoved++;
+			}
+			else
+			{
+				Kept.Add(Cell, TileIdx);
+			}
+		}
+	}
+
+	if (NumRemoved == 0) { return 0; }
+
+	//Compact tiles in plan order, and drop the sub meshes of removed composite tiles
+	TArray<FArenaPlannedTile> Tiles;
+	TArray<FArenaPlannedTile> SubTiles;
+	Tiles.Reserve(OutPlan.Tiles.Num() - NumRemoved);
+	SubTiles.Reserve(OutPlan.SubTiles.Num());
+
+	for (FArenaPlannedPattern& Pattern : OutPlan.Patterns)
+	{
+		TSet<FIntVector> RemovedCoords;
+		const int32 FirstTile = Tiles.Num();
+
+		for (int32 TileIdx = Pattern.FirstTile; TileIdx < Pattern.FirstTile + Pattern.NumTiles; ++TileIdx)
+		{
+			const FArenaPlannedTile& Tile = OutPlan.Tiles[TileIdx];
+			if (Removed[TileIdx]) {
+				RemovedCoords.Add(FIntVector(Tile.Coord.Slice, Tile.Coord.Column, Tile.Coord.Row));
+			}
+			else {
+				Tiles.Add(Tile);
+			}
+		}
+
+		const int32 FirstSubTile = SubTiles.Num();
+		for (const FArenaPlannedTile& SubTile : OutPlan.GetPatternSubTiles(Pattern))
+		{
+			if (!RemovedCoords.Contains(FIntVector(SubTile.Coord.Slice, SubTile.Coord.Column, SubTile.Coord.Row))) {
+				SubTiles.Add(SubTile);
+			}
+		}
+
+		Pattern.FirstTile = FirstTile;
+		Pattern.NumTiles = Tiles.Num() - FirstTile;
+		Pattern.FirstSubTile = FirstSubTile;
+		Pattern.NumSubTiles = SubTiles.Num() - FirstSubTile;
+	}
+
+	OutPlan.Tiles = MoveTemp(Tiles);
+	OutPlan.SubTiles = MoveTemp(SubTiles);
+
+	ArenaGenLog_InfoSilent("Removed %d duplicate tiles", NumRemoved);
+	return NumRemoved;
+}
+
+void FArenaLayoutPlanner::AddSubTiles(FArenaPlannedPattern& Pattern, FArenaLayoutPlan& OutPlan) const
+{
+	Pattern.FirstSubTile = OutPlan.SubTiles.Num();
+	Pattern.NumSubTiles = 0;
+
+	if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes || Pattern.NumTiles <= 0) { return; }
+
+	const FArenaMeshGroupConfig& Group = Inputs.MeshGroups[Pattern.GroupIdx];
+
+	int32 SubMeshesPerTile = 0;
+	for (const FArenaMesh& ArenaMesh : Group.GroupMeshes)
+	{
+		SubMeshesPerTile = FMath::Max(SubMeshesPerTile, ArenaMesh.SubMeshes.Num());
+	}
+	if (SubMeshesPerTile == 0) { return; }
+
+	TArray<int32> FirstSlots;
+	Group.GetSubMeshSlots(FirstSlots);
+
+	OutPlan.SubTiles.Reserve(OutPlan.SubTiles.Num() + Pattern.NumTiles * SubMeshesPerTile);
+
+	for (const FArenaPlannedTile& Tile : OutPlan.GetPatternTiles(Pattern))
+	{
+		if (!Group.GroupMeshes.IsValidIndex(Tile.MeshIdx)) { continue; }
+
+		const TArray<FArenaSubMesh>& SubMeshes = Group.GroupMeshes[Tile.MeshIdx].SubMeshes;
+		for (int32 SubIdx = 0; SubIdx < SubMeshes.Num(); ++SubIdx)
+		{
+			FArenaPlannedTile& SubTile = OutPlan.SubTiles.AddDefaulted_GetRef();
+			SubTile.Transform = SubMeshes[SubIdx].RelativeTransform * Tile.Transform;
+			SubTile.Coord = Tile.Coord;
+			SubTile.MeshIdx = FirstSlots[Tile.MeshIdx] + SubIdx;
+		}
+	}
+
+	Pattern.NumSubTiles = OutPlan.SubTiles.Num() - Pattern.FirstSubTile;
+}
+
+void FArenaLayoutPlanner::ApplyWarpField(const FArenaWarpField& Field, const FArenaPlannedPattern& Pattern, FArenaLayoutPlan& OutPlan) const
+{
+	if (Pattern.NumTiles <= 0) { return; }
+
+	TArrayView<FArenaPlannedTile> Tiles(OutPlan.Tiles.GetData() + Pattern.FirstTile, Pattern.NumTiles);
+
+	TArray<FVector> Positions;
+	Positions.SetNumUninitialized(Tiles.Num());
+	for (int32 i = 0; i < Tiles.Num(); ++i)
+	{
+		Positions[i] = Tiles[i].Transform.GetLocation();
+	}
+
+	TArray<FVector> Offsets;
+	Offsets.SetNumUninitialized(Tiles.Num());
+	FArenaNoise::SampleWarpField(Field, Stream.GetInitialSeed(), Positions, Offsets);
+
+	const FArenaSectionGeometry& Geometry = State.Geometry;
+	for (int32 i = 0; i < Tiles.Num(); ++i)
+	{
+		FVector DirFV(1.f, 0.f, 0.f);
+		FVector DirRV(0.f, 1.f, 0.f);
+
+		//Polygon tiles warp along their side, grids along the generator axes
+		if (Pattern.SectionType == EArenaSectionType::Polygon)
+		{
+			const int32 SideIdx = Tiles[i].Coord.Slice;
+			DirFV = ForwardVectorFromYaw(Geometry.ExteriorAngle * SideIdx);
+			DirRV = FRotationMatrix(FRotator(0, (360.f / Geometry.ArenaSides) * SideIdx, 0)).GetScaledAxis(EAxis::Y);
+		}
+
+		Tiles[i].Transform.AddToTranslation(DirFV * Offsets[i].X + DirRV * Offsets[i].Y + FVector(0.f, 0.f, Offsets[i].Z));
+	}
+}
+
+FVector FArenaLayoutPlanner::CalculatePatternOrigin(EArenaSectionType SectionType, const FVector& MeshSize, const FVector& MeshScale, int32 CurrTilesPerSide) const
+{
+	const FArenaSectionGeometry& Geometry = State.Geometry;
+	const EArenaBuildOrderRules CurrentBOR = Geometry.BuildOrderRules;
+	const float Apothem = Geometry.Apothem;
+	const float SideLength = Geometry.SideLength;
+	const int32 ArenaDimensions = Geometry.ArenaDimensions;
+
+	FVector OriginOffset = State.OriginOffset;
+
+	switch (Inputs.ArenaPlacementOnActor) {
+		default:
+		ArenaGenLog_InfoSilent("Hit default case on ArenaPlacement! Placing in center.");
+		case EOriginPlacementType::Center:
+		{
+			if (SectionType == EArenaSectionType::HorizontalGrid) {
+				OriginOffset = FVector(
+					(MeshSize.X * (-0.5f * ArenaDimensions) * MeshScale.X),//X
+					(MeshSize.Y * (-0.5f * ArenaDimensions) * MeshScale.Y),//Y
+					OriginOffset.Z);
+			}
+			else if (SectionType == EArenaSectionType::Polygon) {
+				FVector PolygonOffset = (
+					(ForwardVectorFromYaw(Geometry.InteriorAngle / 2) * Geometry.InscribedRadius) * FVector(static_cast<float>(CurrTilesPerSide) / (SideLength / MeshSize.X))
+					);
+
+				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
+				{
+					OriginOffset = FVector(-PolygonOffset.X, -PolygonOffset.Y, OriginOffset.Z); //for Grid BOR
+				}
+				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
+				{
+					OriginOffset = FVector(-(SideLength / 2), -Apothem, OriginOffset.Z);
+				}
+			}
+		}break;
+		case EOriginPlacementType::XY_Positive:
+		{
+			if (SectionType == EArenaSectionType::HorizontalGrid) {
+				OriginOffset = FVector(0, 0, OriginOffset.Z);
+					
+			}
+			else if (SectionType == EArenaSectionType::Polygon) {
+
+				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
+				{
+					OriginOffset = FVector(((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2))/2
+						, ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2))/2
+						, OriginOffset.Z);
+				}
+				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
+				{
+					OriginOffset = FVector((MeshSize.X * (0.5f * ArenaDimensions) * MeshScale.X) - (SideLength / 2)
+						, ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2
+						, OriginOffset.Z);
+				}
+			}
+		}
+		break;
+		case EOriginPlacementType::X_Positive_Y_Negative:
+		{
+			if (SectionType == EArenaSectionType::HorizontalGrid) {
+				OriginOffset = FVector(
+					0,//X
+					(MeshSize.Y * -ArenaDimensions * MeshScale.Y),//Y
+					OriginOffset.Z);
+			}
+			else if (SectionType == EArenaSectionType::Polygon) {
+
+				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
+				{
+					OriginOffset = FVector(((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2
+						, (-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
+						, OriginOffset.Z);
+				}
+				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
+				{
+					OriginOffset = FVector((MeshSize.X * (0.5f * ArenaDimensions) * MeshScale.X) - (SideLength / 2)
+						, (-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
+						, OriginOffset.Z);
+				}
+			}
+		}break;
+		case EOriginPlacementType::XY_Negative:
+		{
+			if (SectionType == EArenaSectionType::HorizontalGrid) {
+				OriginOffset = FVector(
+					(MeshSize.X * -ArenaDimensions * MeshScale.X),//X
+					(MeshSize.Y * -ArenaDimensions * MeshScale.Y),//Y
+					OriginOffset.Z);
+			}
+			else if (SectionType == EArenaSectionType::Polygon) {
+			
+				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
+				{
+					OriginOffset = FVector((-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
+						, (-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
+						, OriginOffset.Z); //for Grid BOR
+				}
+				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
+				{
+					
+					OriginOffset = FVector(-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * (0.5f * ArenaDimensions) * MeshScale.X) - (SideLength / 2))
+						, (-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
+						, OriginOffset.Z);
+				}
+			}
+		}break;
+		case EOriginPlacementType::X_Negative_Y_Positive:
+		{
+			if (SectionType == EArenaSectionType::HorizontalGrid) {
+				OriginOffset = FVector(
+					(MeshSize.X * -ArenaDimensions * MeshScale.X),//X
+					0,//Y
+					OriginOffset.Z);
+			}
+			else if (SectionType == EArenaSectionType::Polygon) {
+
+				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
+				{
+					OriginOffset = FVector(-Apothem - (SideLength / 2) - (MeshSize.X * 3) / 4
+						, ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2
+						, OriginOffset.Z);
+				}
+				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
+				{
+					OriginOffset = FVector(-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * (0.5f * ArenaDimensions) * MeshScale.X) - (SideLength / 2))
+						, ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2
+						, OriginOffset.Z);
+				}
+			}
+		}break;
+		
+	}
+
+	return OriginOffset;
+}
+
+void FArenaLayoutPlanner::GetPivotOffsets(const FArenaLayoutInputs& Inputs, const FArenaPlannedPattern& Pattern, TArray<FVector>& OutOffsets)
+{
+	OutOffsets.Reset();
+
+	if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes)
+	{
+		OutOffsets.Add(FVector(0));
+		return;
+	}
+
+	const TArray<FArenaMesh>& GroupMeshes = Inputs.MeshGroups[Pattern.GroupIdx].GroupMeshes;
+	if (Inputs.MeshPivotOffsets.IsValidIndex(Pattern.GroupIdx) && Inputs.MeshPivotOffsets[Pattern.GroupIdx].Num() == GroupMeshes.Num())
+	{
+		OutOffsets = Inputs.MeshPivotOffsets[Pattern.GroupIdx];
+	}
+	else
+	{
+		//Inputs not resolved against the meshes only know the corner origins
+		for (const FArenaMesh& ArenaMesh : GroupMeshes)
+		{
+			OutOffsets.Add(OriginOffsetScalar(ArenaMesh.OriginType) * Pattern.MeshSize);
+		}
+	}
+
+	//Empty groups still get planned tiles
+	if (OutOffsets.IsEmpty()) { OutOffsets.Add(FVector(0)); }
+}
+
+void FArenaLayoutPlanner::PlanLayoutsForSeeds(const FArenaLayoutInputs& Inputs, TArrayView<const int32> Seeds, TArray<FArenaLayoutPlan>& OutPlans)
+{
+	OutPlans.SetNum(Seeds.Num());
+
+	ParallelFor(Seeds.Num(), [&Inputs, &Seeds, &OutPlans](int32 Idx)
+	{
+		FArenaLayoutPlanner Planner(Inputs, FRandomStream(Seeds[Idx]));
+
+		//Every seed shares the inputs, their problems are reported once
+		Planner.SetQuiet(Idx > 0);
+		Planner.PlanLayout(OutPlans[Idx]);
+	});
+}
+
+FArenaBakedLayout FArenaLayoutPlanner::BakePlan(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs)
+{
+	FArenaBakedLayout Layout;
+	Layout.Seed = Plan.Seed;
+
+	//Baked entries per (group, mesh), so each mesh ends up in a single entry
+	TMap<TPair<int32, int32>, int32> MeshEntries;
+
+	TArray<UStaticMesh*> ComponentMeshes;
+
+	for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+	{
+		if (Pattern.AssetToPlace == ETypeToPlace::Actors)
+		{
+			for (const FArenaPlannedTile& Tile : Plan.GetPatternTiles(Pattern))
+			{
+				FArenaBakedActor& Baked = Layout.Actors.AddDefaulted_GetRef();
+				Baked.ActorClass = Inputs.ActorGroups[Pattern.GroupIdx].ClassesToSpawn[Tile.MeshIdx];
+				Baked.Transform = Tile.Transform;
+			}
+			continue;
+		}
+
+		Inputs.MeshGroups[Pattern.GroupIdx].GetComponentMeshes(ComponentMeshes);
+
+		auto BakeTiles = [&](TArrayView<const FArenaPlannedTile> Tiles)
+		{
+			for (const FArenaPlannedTile& Tile : Tiles)
+			{
+				UStaticMesh* Mesh = ComponentMeshes.IsValidIndex(Tile.MeshIdx) ? ComponentMeshes[Tile.MeshIdx] : nullptr;
+				if (!Mesh) { continue; }
+
+				const TPair<int32, int32> Key(Pattern.GroupIdx, Tile.MeshIdx);
+				int32* EntryIdx = MeshEntries.Find(Key);
+				if (!EntryIdx)
+				{
+					FArenaBakedMeshInstances& Baked = Layout.MeshInstances.AddDefaulted_GetRef();
+					Baked.Mesh = Mesh;
+					Baked.GroupIndex = Pattern.GroupIdx;
+					Baked.MeshIndex = Tile.MeshIdx;
+					EntryIdx = &MeshEntries.Add(Key, Layout.MeshInstances.Num() - 1);
+				}
+
+				Layout.MeshInstances[*EntryIdx].Transforms.Add(Tile.Transform);
+			}
+		};
+
+		BakeTiles(Plan.GetPatternTiles(Pattern));
+		BakeTiles(Plan.GetPatternSubTiles(Pattern));
+	}
+
+	for (FArenaBakedMeshInstances& Baked : Layout.MeshInstances)
+	{
+		Baked.Transforms.Shrink();
+	}
+
+	Layout.Annotations = Plan.Annotations;
+
+	Layout.UpdateStats();
+	return Layout;
+}
+
+void FArenaLayoutPlanner::BuildAnnotations(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, FArenaAnnotations& OutAnnotations)
+{
+	OutAnnotations.Reset();
+
+	TArray<FVector> PivotOffsets;
+	auto GetCenter = [&PivotOffsets](const FArenaPlannedTile& Tile)
+	{
+		const FVector Pivot = PivotOffsets.IsValidIndex(Tile.MeshIdx) ? PivotOffsets[Tile.MeshIdx] : FVector(0);
+		return Tile.Transform.GetLocation() + FRotator(0, Tile.Transform.Rotator().Yaw, 0).RotateVector(FVector(Pivot.X, Pivot.Y, 0));
+	};
+
+	//Spawn points and their clearance, sorted once all floors are known
+	TArray<FVector3f> SpawnLocations;
+	TArray<uint16> SpawnClearance;
+
+	TArray<int32> Cells;
+	TArray<uint16> Distance;
+
+	for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+	{
+		if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes || Pattern.NumTiles <= 0) { continue; }
+
+		TArrayView<const FArenaPlannedTile> Tiles = Plan.GetPatternTiles(Pattern);
+		GetPivotOffsets(Inputs, Pattern, PivotOffsets);
+
+		if (Pattern.SectionType == EArenaSectionType::HorizontalGrid)
+		{
+			//Only the top repetition of a floor can be stood on
+			int32 TopSlice = 0;
+			for (const FArenaPlannedTile& Tile : Tiles)
+			{
+				TopSlice = FMath::Max(TopSlice, Tile.Coord.Slice);
+			}
+
+			const int32 Columns = Pattern.Columns;
+			const int32 Rows = Pattern.Rows;
+			Cells.Init(INDEX_NONE, Columns * Rows);
+			for (int32 TileIdx = 0; TileIdx < Tiles.Num(); ++TileIdx)
+			{
+				if (Tiles[TileIdx].Coord.Slice == TopSlice) {
+					Cells[Tiles[TileIdx].Coord.Row * Columns + Tiles[TileIdx].Coord.Column] = TileIdx;
+				}
+			}
+
+			//Chessboard distance to the nearest missing tile, two passes over the lattice. Outside the lattice counts as missing.
+			Distance.SetNumUninitialized(Cells.Num());
+			auto Get = [&](int32 Col, int32 Row) -> uint16 { return (Col < 0 || Row < 0 || Col >= Columns || Row >= Rows) ? 0 : Distance[Row * Columns + Col]; };
+
+			for (int32 Row = 0; Row < Rows; ++Row)
+			{
+				for (int32 Col = 0; Col < Columns; ++Col)
+				{
+					const int32 Cell = Row * Columns + Col;
+					Distance[Cell] = Cells[Cell] == INDEX_NONE ? 0
+						: uint16(FMath::Min<int32>(MAX_uint16 - 1, 1 + FMath::Min(FMath::Min(Get(Col - 1, Row), Get(Col - 1, Row - 1)), FMath::Min(Get(Col, Row - 1), Get(Col + 1, Row - 1)))));
+				}
+			}
+			for (int32 Row = Rows - 1; Row >= 0; --Row)
+			{
+				for (int32 Col = Columns - 1; Col >= 0; --Col)
+				{
+					const int32 Cell = Row * Columns + Col;
+					if (Distance[Cell] == 0) { continue; }
+
+					const int32 Backward = 1 + FMath::Min(FMath::Min(Get(Col + 1, Row), Get(Col + 1, Row + 1)), FMath::Min(Get(Col, Row + 1), Get(Col - 1, Row + 1)));
+					Distance[Cell] = uint16(FMath::Min<int32>(Distance[Cell], Backward));
+				}
+			}
+
+			const float FloorHeight = Pattern.MeshSize.Z * Pattern.MeshScale.Z;
+			for (int32 Cell = 0; Cell < Cells.Num(); ++Cell)
+			{
+				if (Cells[Cell] == INDEX_NONE) { continue; }
+
+				SpawnLocations.Add(FVector3f(GetCenter(Tiles[Cells[Cell]]) + FVector(0, 0, FloorHeight)));
+				SpawnClearance.Add(Distance[Cell]);
+			}
+		}
+		else if (Pattern.SectionType == EArenaSectionType::Polygon && Pattern.Slices > 0)
+		{
+			//Cover and patrols run along the bottom band of the walls, on the side facing the middle of the ring
+			FVector RingCenter(0);
+			int32 NumBottom = 0;
+			for (const FArenaPlannedTile& Tile : Tiles)
+			{
+				if (Tile.Coord.Row == 0) {
+					RingCenter += GetCenter(Tile);
+					NumBottom++;
+				}
+			}
+			if (NumBottom == 0) { continue; }
+			RingCenter /= NumBottom;
+
+			const float HalfDepth = Pattern.MeshSize.Y * Pattern.MeshScale.Y * 0.5f;
+			TArray<FVector> SideSums;
+			TArray<int32> SideCounts;
+			SideSums.Init(FVector(0), Pattern.Slices);
+			SideCounts.Init(0, Pattern.Slices);
+
+			for (const FArenaPlannedTile& Tile : Tiles)
+			{
+				if (Tile.Coord.Row != 0 || !SideSums.IsValidIndex(Tile.Coord.Slice)) { continue; }
+
+				const FVector Center = GetCenter(Tile);
+
+				//Right vector of the side, flipped toward the inside of the ring
+				const FVector SideAngleRV = FRotationMatrix(FRotator(0, (360.f / Pattern.Slices) * Tile.Coord.Slice, 0)).GetScaledAxis(EAxis::Y);
+				const FVector Inward = FVector::DotProduct(SideAngleRV, RingCenter - Center) >= 0.f ? SideAngleRV : -SideAngleRV;
+
+				OutAnnotations.CoverPoints.Locations.Add(FVector3f(Center + Inward * (HalfDepth + Inputs.CoverOffset)));
+				OutAnnotations.CoverPoints.Facing.Add(FVector3f(-Inward));
+
+				SideSums[Tile.Coord.Slice] += Center + Inward * (HalfDepth + Inputs.PatrolInset);
+				SideCounts[Tile.Coord.Slice]++;
+			}
+
+			FArenaPatrolLoop& Loop = OutAnnotations.PatrolLoops.AddDefaulted_GetRef();
+			for (int32 Side = 0; Side < Pattern.Slices; ++Side)
+			{
+				if (SideCounts[Side] > 0) {
+					Loop.Points.Add(FVector3f(SideSums[Side] / SideCounts[Side]));
+				}
+			}
+		}
+	}
+
+	//Counting sort by clearance so points clear enough for a query are a prefix
+	FArenaSpawnPoints& Spawns = OutAnnotations.SpawnPoints;
+	int32 MaxClearance = 0;
+	for (const uint16 Clearance : SpawnClearance)
+	{
+		MaxClearance = FMath::Max<int32>(MaxClearance, Clearance);
+	}
+
+	Spawns.NumWithClearance.Init(0, MaxClearance + 2);
+	for (const uint16 Clearance : SpawnClearance)
+	{
+		Spawns.NumWithClearance[Clearance]++;
+	}
+	for (int32 Clearance = MaxClearance - 1; Clearance >= 0; --Clearance)
+	{
+		Spawns.NumWithClearance[Clearance] += Spawns.NumWithClearance[Clearance + 1];
+	}
+
+	//Points with a clearance of C fill [NumWithClearance[C + 1], NumWithClearance[C])
+	TArray<int32> NextSlot;
+	NextSlot.SetNumUninitialized(MaxClearance + 1);
+	for (int32 Clearance = 0; Clearance <= MaxClearance; ++Clearance)
+	{
+		NextSlot[Clearance] = Spawns.NumWithClearance[Clearance + 1];
+	}
+
+	Spawns.Locations.SetNumUninitialized(SpawnLocations.Num());
+	Spawns.Clearance.SetNumUninitialized(SpawnLocations.Num());
+	for (int32 Idx = 0; Idx < SpawnLocations.Num(); ++Idx)
+	{
+		const int32 Slot = NextSlot[SpawnClearance[Idx]]++;
+		Spawns.Locations[Slot] = SpawnLocations[Idx];
+		Spawns.Clearance[Slot] = SpawnClearance[Idx];
+	}
+}
+
+#pragma region Utility
+
+float FArenaLayoutPlanner::CalculateOpposite(float length, float angle)
+{
+	return (length * FMath::Cos(FMath::DegreesToRadians(angle)));
+}
+
+float FArenaLayoutPlanner::CalculateAdjacent(float length, float angle)
+{
+	return (length * FMath::Sin(FMath::DegreesToRadians(angle)));
+}
+
+FVector FArenaLayoutPlanner::ForwardVectorFromYaw(float yaw)
+{
+	float YawRad = FMath::DegreesToRadians(yaw);
+	
+	return FVector(FMath::Cos(YawRad),
+		FMath::Sin(YawRad),
+	0.f);
+}
+
+FVector FArenaLayoutPlanner::RotatedMeshOffset(EOriginPlacementType OriginType, const FVector& MeshSize, int RotationIndex)
+{
+	float X1 = 0;
+	float Y1 = 0;
+
+	switch (OriginType) {
+	case(EOriginPlacementType::XY_Positive):
+		if (RotationIndex == 1) {
+			X1 = MeshSize.X;
+		}
+		else if (RotationIndex == 2) {
+			X1 = MeshSize.X; Y1 = MeshSize.Y;
+		}
+		else if (RotationIndex == 3) {
+			Y1 = MeshSize.Y;
+		}
+		break;
+
+	case(EOriginPlacementType::XY_Negative):
+		if (RotationIndex == 0) {
+			X1 = MeshSize.X; Y1 = MeshSize.Y;
+		}
+		else if (RotationIndex == 1) {
+			Y1 = MeshSize.Y;
+		}
+		else if (RotationIndex == 3) {
+			X1 = MeshSize.X;
+		}
+		break;
+
+	case(EOriginPlacementType::X_Positive_Y_Negative):
+		if (RotationIndex == 0) {
+			Y1 = MeshSize.Y;
+		}
+		else if (RotationIndex == 2) {
+			X1 = MeshSize.X; 
+		}
+		else if (RotationIndex == 3) {
+			X1 = MeshSize.X; Y1 = MeshSize.Y;
+		}
+		break;
+
+	case(EOriginPlacementType::X_Negative_Y_Positive):
+		if (RotationIndex == 0) {
+			X1 = MeshSize.X;
+		}
+		else if (RotationIndex == 1) {
+			X1 = MeshSize.X; Y1 = MeshSize.Y;
+		}
+		else if (RotationIndex == 2) {
+			Y1 = MeshSize.Y;
+		}
+		break;
+
+	case(EOriginPlacementType::Center):
+		return FVector(0);
+		break;
+	}
+
+	return FVector(X1, Y1, 0);
+}
+
+FVector FArenaLayoutPlanner::OffsetMeshAlongDirections(const FVector& FV, const FVector& RV, EOriginPlacementType OriginType, const FVector& MeshSize, int RotationIndex)
+{
+	FVector Span;
+
+	switch (OriginType) {
+	case(EOriginPlacementType::XY_Positive):
+		if (RotationIndex == 1) {
+			Span = FV * MeshSize.X;
+		}
+		else if (RotationIndex == 2) {
+			Span = FV * MeshSize.X + RV * MeshSize.Y;
+		}
+		else if (RotationIndex == 3) {
+			Span = RV * MeshSize.Y;
+		}
+		break;
+
+	case(EOriginPlacementType::XY_Negative):
+		if (RotationIndex == 0) {
+			Span = FV * MeshSize.X + RV * MeshSize.Y;
+		}
+		else if (RotationIndex == 1) {
+			Span = RV * MeshSize.Y;
+		}
+		else if (RotationIndex == 3) {
+			Span = FV * MeshSize.X;
+		}
+		break;
+
+	case(EOriginPlacementType::X_Positive_Y_Negative):
+		if (RotationIndex == 0) {
+			Span = RV * MeshSize.Y;
+		}
+		else if (RotationIndex == 2) {
+			Span = FV * MeshSize.X;
+		}
+		else if (RotationIndex == 3) {
+			Span = FV * MeshSize.X + RV * MeshSize.Y;
+		}
+		break;
+
+	case(EOriginPlacementType::X_Negative_Y_Positive):
+		if (RotationIndex == 0) {
+			Span = FV * MeshSize.X;
+		}
+		else if (RotationIndex == 1) {
+			Span = FV * MeshSize.X + RV * MeshSize.Y;
+		}
+		else if (RotationIndex == 2) {
+			Span = RV * MeshSize.Y;
+		}
+		break;
+
+	case(EOriginPlacementType::Center):
+		return FVector(0);
+		break;
+	}
+	return Span;
+}
+
+FVector FArenaLayoutPlanner::OriginOffsetScalar(EOriginPlacementType OriginType)
+{
+	switch (OriginType) {
+	case(EOriginPlacementType::XY_Positive):
+		return FVector(0.5, 0.5, 0);
+		break;
+	case(EOriginPlacementType::XY_Negative):
+		return FVector(-0.5, -0.5, 0);
+		break;
+	case(EOriginPlacementType::X_Positive_Y_Negative):
+		return FVector(0.5, -0.5, 0);
+		break;
+	case(EOriginPlacementType::X_Negative_Y_Positive):
+		return FVector(-0.5, 0.5, 0); 
+		break;
+	case(EOriginPlacementType::Center):
+		return FVector(0);
+		break;
+	}
+
+	return FVector(0);
+}
+
+FVector FArenaLayoutPlanner::PlacementWarpingConcavity(int ColMidpoint, int RowMidpoint, int Col, int Row, float ConcavityStrength, FVector WarpDirection)
+{
+	return  (WarpDirection * ConcavityWeight(ColMidpoint, RowMidpoint, Col, Row, ConcavityStrength)); 
+
+}
+
+float FArenaLayoutPlanner::ConcavityWeight(int ColMidpoint, int RowMidpoint, int Col, int Row, float ConcavityStrength)
+{
+	return ConcavityStrength *
+		(FMath::Clamp((FMath::Lerp(0.f, 1.f, FMath::Clamp((static_cast<float>(abs(Col - ColMidpoint)) / RowMidpoint), 0.f, 1.f)) *
+		FMath::Lerp(0.f, 1.f, FMath::Clamp((static_cast<float>(abs(Row - RowMidpoint)) / RowMidpoint), 0.f, 1.f))), 0.f, 1.f));
+}
+
+FVector FArenaLayoutPlanner::PlacementWarpingDirectional(FVector OffsetRanges, const FVector& DirFV, const FVector& DirRV)
+{
+	//Draw in a fixed order so plans are reproducible across compilers
+	const float ForwardWarp = Stream.FRandRange(OffsetRanges.X * -1, OffsetRanges.X);
+	const float RightWarp = Stream.FRandRange(OffsetRanges.Y * -1, OffsetRanges.Y);
+	const float UpWarp = Stream.FRandRange(OffsetRanges.Z * -1, OffsetRanges.Z);
+
+	return (ForwardWarp * DirFV)
+		+ (RightWarp * DirRV)
+		+ FVector(0,0, UpWarp);
+}
+
+FVector FArenaLayoutPlanner::PivotRotationOffset(const FVector& PivotToCenter, float angle)
+{
+	float AngleRad = FMath::DegreesToRadians(angle);
+	float cosTheta = FMath::Cos(AngleRad);
+	float sinTheta = FMath::Sin(AngleRad);
+
+	FVector RotatedCenter = FVector(((PivotToCenter.X * cosTheta) - (PivotToCenter.Y * sinTheta)), ((PivotToCenter.X * sinTheta) + (PivotToCenter.Y * cosTheta)), 0);
+
+	return (PivotToCenter - RotatedCenter) - PivotToCenter;
+}
+
+FVector FArenaLayoutPlanner::OffsetMeshToCenter(EOriginPlacementType OriginType, const FVector& MeshSize, float angle)
+{
+	if (OriginType == EOriginPlacementType::Center) { return FVector(0); } //early return if origin type is zero
+
+	float AngleRad = FMath::DegreesToRadians(angle);
+	float cosTheta = FMath::Cos(AngleRad);
+	float sinTheta = FMath::Sin(AngleRad);
+	FVector InitialCenter = OriginOffsetScalar(OriginType) * MeshSize; //determines the offset direction for calculation based on origin type
+
+	FVector RotatedCenter = FVector(((InitialCenter.X * cosTheta) - (InitialCenter.Y * sinTheta)), ((InitialCenter.X * sinTheta) + (InitialCenter.Y * cosTheta)), 0);
+
+	return InitialCenter - RotatedCenter;
+}
+
+#pragma endregion
@@ -0,0 +1,307 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaLayoutRaster.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+#include "ArenaLayoutPlanner.h"
+
+namespace
+{
+	//Pixel rows rasterized by the same worker
+	constexpr int32 ChunkRows = 16;
+
+	//Tile footprint in pixel space
+	struct FRasterFootprint
+	{
+		FVector2f Corners[4];
+		float Top = 0.f;
+		uint8 SectionId = 0;
+		uint8 GroupId = 0;
+	};
+
+	//Interval of a convex footprint at a scanline, false if the scanline misses it
+	bool ScanlineSpan(const FRasterFootprint& Footprint, float Y, float& OutMinX, float& OutMaxX)
+	{
+		OutMinX = MAX_flt;
+		OutMaxX = -MAX_flt;
+
+		for (int32 Corner = 0; Corner < 4; ++Corner)
+		{
+			const FVector2f& A = Footprint.Corners[Corner];
+			const FVector2f& B = Footprint.Corners[(Corner + 1) & 3];
+			if ((A.Y <= Y) == (B.Y <= Y)) { continue; }
+
+			const float X = A.X + (Y - A.Y) * (B.X - A.X) / (B.Y - A.Y);
+			OutMinX = FMath::Min(OutMinX, X);
+			OutMaxX = FMath::Max(OutMaxX, X);
+		}
+
+		return OutMinX <= OutMaxX;
+	}
+}
+
+void FArenaLayoutRaster::Rasterize(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, int32 Resolution, FArenaLayoutRaster& Out)
+{
+	Out.Reset();
+	if (Resolution <= 0) { return; }
+
+	//Footprints in generator space first, the pixel size depends on their bounds
+	TArray<FRasterFootprint> Footprints;
+	Footprints.Reserve(Plan.Tiles.Num());
+
+	TArray<FVector> PivotOffsets;
+	FBox2D Bounds(ForceInit);
+
+	for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+	{
+		if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes || Pattern.NumTiles <= 0) { continue; }
+
+		FArenaLayoutPlanner::GetPivotOffsets(Inputs, Pattern, PivotOffsets);
+
+		const FVector2f HalfSize = FVector2f(Pattern.MeshSize.X * Pattern.MeshScale.X, Pattern.MeshSize.Y * Pattern.MeshScale.Y) * 0.5f;
+		const float TileHeight = Pattern.MeshSize.Z * Pattern.MeshScale.Z;
+		const uint8 SectionId = uint8(FMath::Clamp(Pattern.SectionIdx + 1, 1, 255));
+		const uint8 GroupId = uint8(FMath::Clamp(Pattern.GroupIdx + 1, 1, 255));
+
+		for (const FArenaPlannedTile& Tile : Plan.GetPatternTiles(Pattern))
+		{
+			const FVector Location = Tile.Transform.GetLocation();
+			const FRotator Yaw(0, Tile.Transform.Rotator().Yaw, 0);
+			const FVector Pivot = PivotOffsets.IsValidIndex(Tile.MeshIdx) ? PivotOffsets[Tile.MeshIdx] : FVector(0);
+			const FVector Center = Location + Yaw.RotateVector(FVector(Pivot.X, Pivot.Y, 0));
+
+			const FVector2f Forward = FVector2f(FVector2D(Yaw.Vector()));
+			const FVector2f Right(-Forward.Y, Forward.X);
+
+			FRasterFootprint& Footprint = Footprints.AddDefaulted_GetRef();
+			Footprint.Corners[0] = FVector2f(FVector2D(Center)) - Forward * HalfSize.X - Right * HalfSize.Y;
+			Footprint.Corners[1] = FVector2f(FVector2D(Center)) + Forward * HalfSize.X - Right * HalfSize.Y;
+			Footprint.Corners[2] = FVector2f(FVector2D(Center)) + Forward * HalfSize.X + Right * HalfSize.Y;
+			Footprint.Corners[3] = FVector2f(FVector2D(Center)) - Forward * HalfSize.X + Right * HalfSize.Y;
+			Footprint.Top = float(Location.Z) + TileHeight;
+			Footprint.SectionId = SectionId;
+			Footprint.GroupId = GroupId;
+
+			for (const FVector2f& Corner : Footprint.Corners)
+			{
+				Bounds += FVector2D(Corner);
+			}
+		}
+	}
+
+	const FVector2D Size = Bounds.GetSize();
+	if (!Bounds.bIsValid || FMath::Max(Size.X, Size.Y) <= KINDA_SMALL_NUMBER) { return; }
+
+	Out.Bounds = Bounds;
+	Out.PixelSize = float(FMath::Max(Size.X, Size.Y) / Resolution);
+	Out.Width = FMath::Clamp(FMath::CeilToInt(Size.X / Out.PixelSize), 1, Resolution);
+	Out.Height = FMath::Clamp(FMath::CeilToInt(Size.Y / Out.PixelSize), 1, Resolution);
+
+	const int32 NumPixels = Out.Width * Out.Height;
+	Out.SectionIds.SetNumZeroed(NumPixels);
+	Out.GroupIds.SetNumZeroed(NumPixels);
+	Out.Heights.SetNumZeroed(NumPixels);
+
+	//Move footprints to pixel space and bin them by the chunks of rows they cover
+	const int32 NumChunks = FMath::DivideAndRoundUp(Out.Height, ChunkRows);
+	TArray<TArray<int32>> Bins;
+	Bins.SetNum(NumChunks);
+
+	const FVector2f Origin = FVector2f(Bounds.Min);
+	const float InvPixelSize = 1.f / Out.PixelSize;
+
+	for (int32 FootprintIdx = 0; FootprintIdx < Footprints.Num(); ++FootprintIdx)
+	{
+		FRasterFootprint& Footprint = Footprints[FootprintIdx];
+
+		float MinY = MAX_flt;
+		float MaxY = -MAX_flt;
+		for (FVector2f& Corner : Footprint.Corners)
+		{
+			Corner = (Corner - Origin) * InvPixelSize;
+			MinY = FMath::Min(MinY, Corner.Y);
+			MaxY = FMath::Max(MaxY, Corner.Y);
+		}
+
+		//Rows whose center lies within the footprint
+		const int32 FirstRow = FMath::Max(FMath::CeilToInt(MinY - 0.5f), 0);
+		const int32 LastRow = FMath::Min(FMath::FloorToInt(MaxY - 0.5f), Out.Height - 1);
+
+		for (int32 Chunk = FirstRow / ChunkRows; FirstRow <= LastRow && Chunk <= LastRow / ChunkRows; ++Chunk)
+		{
+			Bins[Chunk].Add(FootprintIdx);
+		}
+	}
+
+	//Chunks own disjoint rows. Footprints are drawn in plan order and the highest one wins, so the result does not depend on scheduling.
+	TArray<float> ChunkMin;
+	TArray<float> ChunkMax;
+	ChunkMin.Init(MAX_flt, NumChunks);
+	ChunkMax.Init(-MAX_flt, NumChunks);
+
+	ParallelFor(NumChunks, [&Out, &Footprints, &Bins, &ChunkMin, &ChunkMax](int32 Chunk)
+	{
+		const int32 ChunkFirstRow = Chunk * ChunkRows;
+		const int32 ChunkLastRow = FMath::Min(ChunkFirstRow + ChunkRows, Out.Height) - 1;
+
+		for (int32 FootprintIdx : Bins[Chunk])
+		{
+			const FRasterFootprint& Footprint = Footprints[FootprintIdx];
+
+			for (int32 Row = ChunkFirstRow; Row <= ChunkLastRow; ++Row)
+			{
+				float MinX, MaxX;
+				if (!ScanlineSpan(Footprint, Row + 0.5f, MinX, MaxX)) { continue; }
+
+				const int32 FirstCol = FMath::Max(FMath::CeilToInt(MinX - 0.5f), 0);
+				const int32 LastCol = FMath::Min(FMath::FloorToInt(MaxX - 0.5f), Out.Width - 1);
+
+				for (int32 Pixel = Row * Out.Width + FirstCol; Pixel <= Row * Out.Width + LastCol; ++Pixel)
+				{
+					if (Out.SectionIds[Pixel] != 0 && Out.Heights[Pixel] >= Footprint.Top) { continue; }
+
+					Out.SectionIds[Pixel] = Footprint.SectionId;
+					Out.GroupIds[Pixel] = Footprint.GroupId;
+					Out.Heights[Pixel] = Footprint.Top;
+				}
+			}
+		}
+
+		for (int32 Pixel = ChunkFirstRow * Out.Width; Pixel < (ChunkLastRow + 1) * Out.Width; ++Pixel)
+		{
+			if (Out.SectionIds[Pixel] == 0) { continue; }
+
+			ChunkMin[Chunk] = FMath::Min(ChunkMin[Chunk], Out.Heights[Pixel]);
+			ChunkMax[Chunk] = FMath::Max(ChunkMax[Chunk], Out.Heights[Pixel]);
+		}
+	});
+
+	float MinHeight = MAX_flt;
+	float MaxHeight = -MAX_flt;
+	for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+	{
+		MinHeight = FMath::Min(MinHeight, ChunkMin[Chunk]);
+		MaxHeight = FMath::Max(MaxHeight, ChunkMax[Chunk]);
+	}
+
+	if (MinHeight <= MaxHeight)
+	{
+		Out.MinHeight = MinHeight;
+		Out.MaxHeight = MaxHeight;
+	}
+}
+
+void FArenaLayoutRaster::ToColors(TArray<FColor>& OutColors) const
+{
+	const int32 NumPixels = Width * Height;
+	OutColors.SetNumUninitialized(NumPixels);
+
+	const float HeightRange = MaxHeight - MinHeight;
+
+	for (int32 Pixel = 0; Pixel < NumPixels; ++Pixel)
+	{
+		if (SectionIds[Pixel] == 0)
+		{
+			OutColors[Pixel] = FColor(0, 0, 0, 0);
+			continue;
+		}
+
+		const uint8 HeightValue = HeightRange > 0.f ? uint8(FMath::RoundToInt(255.f * (Heights[Pixel] - MinHeight) / HeightRange)) : 255;
+		OutColors[Pixel] = FColor(SectionIds[Pixel], HeightValue, GroupIds[Pixel], 255);
+	}
+}
+
+UTexture2D* FArenaLayoutRaster::CreateTexture(FName Name) const
+{
+	check(IsInGameThread());
+
+	if (IsEmpty()) { return nullptr; }
+
+	TArray<FColor> Colors;
+	ToColors(Colors);
+
+	//FColor is laid out as BGRA
+	UTexture2D* Texture = UTexture2D::CreateTransient(Width, Height, PF_B8G8R8A8, Name);
+	if (!Texture) { return nullptr; }
+
+	Texture->Filter = TF_Nearest;
+	Texture->SRGB = false;
+	Texture->CompressionSettings = TC_VectorDisplacementmap;
+
+	FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+	void* Data = Mip.BulkData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(Data, Colors.GetData(), Colors.Num() * sizeof(FColor));
+	Mip.BulkData.Unlock();
+
+	Texture->UpdateResource();
+	return Texture;
+}
+
+int32 FArenaLayoutRaster::CountDifferences(const FArenaLayoutRaster& Other, float HeightTolerance) const
+{
+	if (Width != Other.Width || Height != Other.Height || !Bounds.Min.Equals(Other.Bounds.Min, PixelSize * 0.5f)) {
+		return INDEX_NONE;
+	}
+
+	int32 Differences = 0;
+	for (int32 Pixel = 0; Pixel < SectionIds.Num(); ++Pixel)
+	{
+		Differences += (SectionIds[Pixel] != Other.SectionIds[Pixel] || GroupIds[Pixel] != Other.GroupIds[Pixel]
+			|| FMath::Abs(Heights[Pixel] - Other.Heights[Pixel]) > HeightTolerance) ? 1 : 0;
+	}
+
+	return Differences;
+}
+
+void FArenaLayoutRaster::Reset()
+{
+	Width = 0;
+	Height = 0;
+	Bounds = FBox2D(ForceInit);
+	PixelSize = 0.f;
+	SectionIds.Reset();
+	GroupIds.Reset();
+	Heights.Reset();
+	MinHeight = 0.f;
+	MaxHeight = 0.f;
+}
+
+FArchive& operator<<(FArchive& Ar, FArenaLayoutRaster& Raster)
+{
+	//Bounds are written as floats so raw files read the same with or without large world coordinates
+	FVector2f Min = FVector2f(Raster.Bounds.Min);
+	FVector2f Max = FVector2f(Raster.Bounds.Max);
+
+	Ar << Raster.Width << Raster.Height << Min << Max << Raster.PixelSize << Raster.MinHeight << Raster.MaxHeight;
+	Ar << Raster.SectionIds << Raster.GroupIds << Raster.Heights;
+
+	if (Ar.IsLoading())
+	{
+		Raster.Bounds = Raster.IsEmpty() ? FBox2D(ForceInit) : FBox2D(FVector2D(Min), FVector2D(Max));
+	}
+
+	return Ar;
+}
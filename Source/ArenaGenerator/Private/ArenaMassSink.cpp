@@ -0,0 +1,479 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaMassSink.h"
+#include "MassEntitySubsystem.h"
+#include "MassEntityManager.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Async/ParallelFor.h"
+#include "BaseArenaGenerator.h"
+#include "ArenaGeneratorLog.h"
+
+const FName FArenaMassSink::SinkName(TEXT("MassEntities"));
+
+FArenaMassSink::~FArenaMassSink()
+{
+	for (FEntityBatch& Batch : Batches)
+	{
+		DestroyBatch(Batch);
+	}
+}
+
+#pragma region Commit
+
+void FArenaMassSink::BeginCommit(FArenaSinkContext& Context, const FArenaLayoutPlan& Plan)
+{
+	//Batches whose set was destroyed or released take their entities with them
+	for (int32 i = Batches.Num() - 1; i >= 0; --i)
+	{
+		if (!Batches[i].Proxies.ContainsByPredicate([](const TWeakObjectPtr<UInstancedStaticMeshComponent>& Proxy) { return Proxy.IsValid(); }))
+		{
+			DestroyBatch(Batches[i]);
+			Batches.RemoveAt(i);
+		}
+	}
+
+	Batches.AddDefaulted();
+	CommitProxies.Reset();
+	bPromotionCacheDirty = true;
+}
+
+void FArenaMassSink::CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles)
+{
+	const TArray<FArenaActorConfig>& ActorGroups = Context.Generator.ActorGroups;
+	if (!ActorGroups.IsValidIndex(Pattern.GroupIdx) || Tiles.IsEmpty()) { return; }
+
+	if (!EntitySubsystem.IsValid())
+	{
+		UWorld* World = Context.Generator.GetWorld();
+		EntitySubsystem = World ? World->GetSubsystem<UMassEntitySubsystem>() : nullptr;
+		if (!EntitySubsystem.IsValid())
+		{
+			ArenaGenLog_Warning("No Mass entity subsystem in this world, actor group %d is not placed", Pattern.GroupIdx);
+			return;
+		}
+	}
+
+	FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+	if (!Archetype.IsValid())
+	{
+		Archetype = EntityManager.CreateArchetype({
+			FArenaTileTransformFragment::StaticStruct(),
+			FArenaTileClassFragment::StaticStruct(),
+			FArenaTileCoordFragment::StaticStruct(),
+			FArenaTileVisualFragment::StaticStruct() });
+	}
+
+	const FArenaActorConfig& Config = ActorGroups[Pattern.GroupIdx];
+	FEntityBatch& Batch = Batches.Last();
+
+	//One proxy component per actor group, created even without a proxy mesh so the batch is tied to the set
+	UInstancedStaticMeshComponent*& Proxy = CommitProxies.FindOrAdd(Pattern.GroupIdx, nullptr);
+	if (!Proxy)
+	{
+		Proxy = Context.Generator.CreateInstancedMeshComponent(Config.EntityProxyMesh, Context.Target.bHidden);
+		Context.Target.SinkComponents.Add(Proxy);
+		Batch.Proxies.Add(Proxy);
+	}
+
+	TArray<const FArenaPlannedTile*> ValidTiles;
+	TArray<FTransform> Transforms;
+	ValidTiles.Reserve(Tiles.Num());
+	Transforms.Reserve(Tiles.Num());
+
+	for (const FArenaPlannedTile& Tile : Tiles)
+	{
+		if (Config.ClassesToSpawn.IsValidIndex(Tile.MeshIdx))
+		{
+			ValidTiles.Add(&Tile);
+			Transforms.Add(Tile.Transform);
+		}
+	}
+
+	if (ValidTiles.IsEmpty()) { return; }
+
+	TArray<int32> InstanceIndices;
+	if (Config.EntityProxyMesh)
+	{
+		InstanceIndices = Proxy->AddInstances(Transforms, true, false);
+	}
+
+	TArray<FMassEntityHandle> NewEntities;
+	EntityManager.BatchCreateEntities(Archetype, ValidTiles.Num(), NewEntities);
+
+	for (int32 i = 0; i < NewEntities.Num(); ++i)
+	{
+		const FArenaPlannedTile& Tile = *ValidTiles[i];
+		const FMassEntityHandle Entity = NewEntities[i];
+
+		EntityManager.GetFragmentDataChecked<FArenaTileTransformFragment>(Entity).RelativeTransform = Tile.Transform;
+
+		FArenaTileClassFragment& ClassFragment = EntityManager.GetFragmentDataChecked<FArenaTileClassFragment>(Entity);
+		ClassFragment.ActorClass = Config.ClassesToSpawn[Tile.MeshIdx];
+		ClassFragment.GroupIdx = Pattern.GroupIdx;
+		ClassFragment.ClassIdx = Tile.MeshIdx;
+
+		FArenaTileCoordFragment& CoordFragment = EntityManager.GetFragmentDataChecked<FArenaTileCoordFragment>(Entity);
+		CoordFragment.SectionIdx = Pattern.SectionIdx;
+		CoordFragment.PatternIdx = Pattern.PatternIdx;
+		CoordFragment.Slice = Tile.Coord.Slice;
+		CoordFragment.Column = Tile.Coord.Column;
+		CoordFragment.Row = Tile.Coord.Row;
+
+		FArenaTileVisualFragment& VisualFragment = EntityManager.GetFragmentDataChecked<FArenaTileVisualFragment>(Entity);
+		VisualFragment.Proxy = Proxy;
+		VisualFragment.InstanceIdx = InstanceIndices.IsValidIndex(i) ? InstanceIndices[i] : INDEX_NONE;
+	}
+
+	Batch.Entities.Append(NewEntities);
+	bPromotionCacheDirty = true;
+}
+
+void FArenaMassSink::Clear(ABaseArenaGenerator& Generator)
+{
+	for (FEntityBatch& Batch : Batches)
+	{
+		DestroyBatch(Batch);
+	}
+
+	Batches.Reset();
+	CommitProxies.Reset();
+	DirtyProxies.Reset();
+	bPromotionCacheDirty = true;
+}
+
+void FArenaMassSink::DestroyBatch(FEntityBatch& Batch)
+{
+	//Promoted actors are tracked by the set and destroyed with it
+	if (FMassEntityManager* EntityManager = GetEntityManager())
+	{
+		Batch.Entities.RemoveAllSwap([EntityManager](const FMassEntityHandle& Entity) { return !EntityManager->IsEntityValid(Entity); });
+		EntityManager->BatchDestroyEntities(Batch.Entities);
+	}
+
+	Batch.Entities.Reset();
+	Batch.ActorPool.Reset();
+}
+
+void FArenaMassSink::ReleaseBatches(ABaseArenaGenerator& Generator, TConstArrayView<UInstancedStaticMeshComponent*> Proxies)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	TArray<AActor*> ToDestroy;
+
+	for (int32 i = Batches.Num() - 1; i >= 0; --i)
+	{
+		FEntityBatch& Batch = Batches[i];
+		if (!Batch.Proxies.ContainsByPredicate([Proxies](const TWeakObjectPtr<UInstancedStaticMeshComponent>& Proxy) { return Proxies.Contains(Proxy.Get()); })) { continue; }
+
+		if (EntityManager)
+		{
+			for (const FMassEntityHandle& Entity : Batch.Entities)
+			{
+				if (!EntityManager->IsEntityValid(Entity)) { continue; }
+				if (AActor* Actor = EntityManager->GetFragmentDataChecked<FArenaTileVisualFragment>(Entity).PromotedActor.Get()) {
+					ToDestroy.Add(Actor);
+				}
+			}
+		}
+
+		for (TPair<UClass*, TArray<TWeakObjectPtr<AActor>>>& Pool : Batch.ActorPool)
+		{
+			for (const TWeakObjectPtr<AActor>& Actor : Pool.Value) {
+				if (Actor.IsValid()) { ToDestroy.Add(Actor.Get()); }
+			}
+		}
+
+		DestroyBatch(Batch);
+		Batches.RemoveAt(i);
+	}
+
+	//The actors outlive their batch in the active arena otherwise
+	FArenaInstanceSet& ActiveArena = Generator.GetActiveArena();
+	for (AActor* Actor : ToDestroy)
+	{
+		ActiveArena.SpawnedActors.RemoveSingleSwap(Actor, false);
+		Actor->Destroy();
+	}
+
+	bPromotionCacheDirty = true;
+}
+
+FArenaMassSink::FEntityBatch* FArenaMassSink::FindBatch(const UInstancedStaticMeshComponent* Proxy)
+{
+	return Batches.FindByPredicate([Proxy](const FEntityBatch& Batch) { return Batch.Proxies.Contains(Proxy); });
+}
+
+bool FArenaMassSink::FEntityBatch::IsActive() const
+{
+	//Proxies of a batch share their set, so they are hidden and destroyed together
+	for (const TWeakObjectPtr<UInstancedStaticMeshComponent>& Proxy : Proxies)
+	{
+		if (const UInstancedStaticMeshComponent* Component = Proxy.Get()) {
+			return Component->GetVisibleFlag();
+		}
+	}
+
+	return false;
+}
+
+#pragma endregion
+
+#pragma region Promotion
+
+AActor* FArenaMassSink::PromoteTile(ABaseArenaGenerator& Generator, FMassEntityHandle Entity)
+{
+	AActor* Actor = PromoteTileDeferred(Generator, Entity);
+	bPromotionCacheDirty = true;
+
+	for (UInstancedStaticMeshComponent* Proxy : DirtyProxies) {
+		Proxy->MarkRenderStateDirty();
+	}
+	DirtyProxies.Reset();
+
+	return Actor;
+}
+
+void FArenaMassSink::DemoteTile(ABaseArenaGenerator& Generator, FMassEntityHandle Entity)
+{
+	DemoteTileDeferred(Generator, Entity);
+	bPromotionCacheDirty = true;
+
+	for (UInstancedStaticMeshComponent* Proxy : DirtyProxies) {
+		Proxy->MarkRenderStateDirty();
+	}
+	DirtyProxies.Reset();
+}
+
+AActor* FArenaMassSink::PromoteTileDeferred(ABaseArenaGenerator& Generator, FMassEntityHandle Entity)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager || !EntityManager->IsEntityValid(Entity)) { return nullptr; }
+
+	FArenaTileVisualFragment& Visual = EntityManager->GetFragmentDataChecked<FArenaTileVisualFragment>(Entity);
+	if (Visual.PromotedActor.IsValid()) { return Visual.PromotedActor.Get(); }
+
+	//Tiles of an arena prepared in the background belong to a hidden set, not the active arena
+	UInstancedStaticMeshComponent* Proxy = Visual.Proxy.Get();
+	FEntityBatch* Batch = Proxy ? FindBatch(Proxy) : nullptr;
+	if (!Batch || !Proxy->GetVisibleFlag())
+	{
+		ArenaGenLog_Warning("Cannot promote a tile outside of the active arena");
+		return nullptr;
+	}
+
+	const FTransform& RelativeTransform = EntityManager->GetFragmentDataChecked<FArenaTileTransformFragment>(Entity).RelativeTransform;
+	const FArenaTileClassFragment& Class = EntityManager->GetFragmentDataChecked<FArenaTileClassFragment>(Entity);
+
+	//Reuse a demoted actor of the same class before spawning
+	AActor* Actor = nullptr;
+	if (TArray<TWeakObjectPtr<AActor>>* Pool = Batch->ActorPool.Find(Class.ActorClass))
+	{
+		while (!Actor && !Pool->IsEmpty())
+		{
+			Actor = Pool->Pop(false).Get();
+		}
+	}
+
+	if (Actor)
+	{
+		Actor->SetActorRelativeTransform(RelativeTransform, false);
+		Actor->SetActorHiddenInGame(false);
+		Actor->SetActorEnableCollision(true);
+		Actor->SetActorTickEnabled(true);
+	}
+	else
+	{
+		Actor = Generator.SpawnArenaActor(Generator.GetActiveArena(), Class.ActorClass, RelativeTransform);
+		if (!Actor) { return nullptr; }
+	}
+
+	Visual.PromotedActor = Actor;
+
+	//Indices of the other instances must not shift, so the proxy instance is collapsed rather than removed
+	if (Visual.InstanceIdx != INDEX_NONE)
+	{
+		FTransform Collapsed = RelativeTransform;
+		Collapsed.SetScale3D(FVector::ZeroVector);
+		Proxy->UpdateInstanceTransform(Visual.InstanceIdx, Collapsed, false, false);
+		DirtyProxies.Add(Proxy);
+	}
+
+	return Actor;
+}
+
+void FArenaMassSink::DemoteTileDeferred(ABaseArenaGenerator& Generator, FMassEntityHandle Entity)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager || !EntityManager->IsEntityValid(Entity)) { return; }
+
+	FArenaTileVisualFragment& Visual = EntityManager->GetFragmentDataChecked<FArenaTileVisualFragment>(Entity);
+	UInstancedStaticMeshComponent* Proxy = Visual.Proxy.Get();
+
+	if (AActor* Actor = Visual.PromotedActor.Get())
+	{
+		//Pooled actors stay in their set, so they are destroyed with it
+		Actor->SetActorHiddenInGame(true);
+		Actor->SetActorEnableCollision(false);
+		Actor->SetActorTickEnabled(false);
+
+		if (FEntityBatch* Batch = Proxy ? FindBatch(Proxy) : nullptr) {
+			Batch->ActorPool.FindOrAdd(Actor->GetClass()).Add(Actor);
+		}
+	}
+	Visual.PromotedActor.Reset();
+
+	if (Proxy && Visual.InstanceIdx != INDEX_NONE)
+	{
+		const FTransform& RelativeTransform = EntityManager->GetFragmentDataChecked<FArenaTileTransformFragment>(Entity).RelativeTransform;
+		Proxy->UpdateInstanceTransform(Visual.InstanceIdx, RelativeTransform, false, false);
+		DirtyProxies.Add(Proxy);
+	}
+}
+
+bool FArenaMassSink::IsTilePromoted(FMassEntityHandle Entity) const
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager || !EntityManager->IsEntityValid(Entity)) { return false; }
+
+	return EntityManager->GetFragmentDataChecked<FArenaTileVisualFragment>(Entity).PromotedActor.IsValid();
+}
+
+int32 FArenaMassSink::UpdatePromotion(ABaseArenaGenerator& Generator, TConstArrayView<FVector> Sources, float PromoteRadius, float DemoteRadius, int32 MaxChanges)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager) { return 0; }
+
+	RefreshPromotionCache(*EntityManager);
+
+	const int32 NumTiles = CachedEntities.Num();
+	if (NumTiles == 0) { return 0; }
+
+	const float PromoteRadiusSq = FMath::Square(PromoteRadius);
+	const float DemoteRadiusSq = FMath::Square(FMath::Max(DemoteRadius, PromoteRadius));
+
+	//Tiles between both radii keep their state so sources moving along the edge do not make them flicker
+	TArray<int8> Wanted;
+	Wanted.SetNumZeroed(NumTiles);
+
+	ParallelFor(TEXT("ArenaPromotionDistances"), NumTiles, 1024, [&](int32 TileIdx)
+	{
+		float ClosestSq = MAX_flt;
+		for (const FVector& Source : Sources)
+		{
+			ClosestSq = FMath::Min(ClosestSq, FVector::DistSquared(CachedLocations[TileIdx], Source));
+		}
+
+		const bool bPromoted = CachedPromoted[TileIdx];
+		if (!bPromoted && ClosestSq <= PromoteRadiusSq) { Wanted[TileIdx] = 1; }
+		else if (bPromoted && ClosestSq > DemoteRadiusSq) { Wanted[TileIdx] = -1; }
+	});
+
+	//Demotions first so their actors are pooled for the promotions of the same update
+	int32 NumChanges = 0;
+	for (int32 TileIdx = 0; TileIdx < NumTiles && NumChanges < MaxChanges; ++TileIdx)
+	{
+		if (Wanted[TileIdx] < 0)
+		{
+			DemoteTileDeferred(Generator, CachedEntities[TileIdx]);
+			CachedPromoted[TileIdx] = false;
+			NumChanges++;
+		}
+	}
+
+	for (int32 TileIdx = 0; TileIdx < NumTiles && NumChanges < MaxChanges; ++TileIdx)
+	{
+		//Failed promotions are retried on the next update and do not use up the budget
+		if (Wanted[TileIdx] > 0 && PromoteTileDeferred(Generator, CachedEntities[TileIdx]))
+		{
+			CachedPromoted[TileIdx] = true;
+			NumChanges++;
+		}
+	}
+
+	//One render state update per proxy for the whole batch of swaps
+	for (UInstancedStaticMeshComponent* Proxy : DirtyProxies) {
+		Proxy->MarkRenderStateDirty();
+	}
+	DirtyProxies.Reset();
+
+	return NumChanges;
+}
+
+bool FArenaMassSink::HasPromotedTiles()
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (!EntityManager) { return false; }
+
+	RefreshPromotionCache(*EntityManager);
+	return CachedPromoted.Find(true) != INDEX_NONE;
+}
+
+void FArenaMassSink::RefreshPromotionCache(FMassEntityManager& EntityManager)
+{
+	TArray<const FEntityBatch*> ActiveBatches;
+	for (const FEntityBatch& Batch : Batches)
+	{
+		if (Batch.IsActive()) { ActiveBatches.Add(&Batch); }
+	}
+
+	//A swap reveals another set without a commit, so the active batches are compared too
+	if (!bPromotionCacheDirty && ActiveBatches == CachedBatches) { return; }
+
+	CachedBatches = MoveTemp(ActiveBatches);
+	CachedEntities.Reset();
+	CachedLocations.Reset();
+	CachedPromoted.Reset();
+
+	for (const FEntityBatch* Batch : CachedBatches)
+	{
+		for (const FMassEntityHandle& Entity : Batch->Entities)
+		{
+			if (!EntityManager.IsEntityValid(Entity)) { continue; }
+
+			CachedEntities.Add(Entity);
+			CachedLocations.Add(EntityManager.GetFragmentDataChecked<FArenaTileTransformFragment>(Entity).RelativeTransform.GetLocation());
+			CachedPromoted.Add(EntityManager.GetFragmentDataChecked<FArenaTileVisualFragment>(Entity).PromotedActor.IsValid());
+		}
+	}
+
+	bPromotionCacheDirty = false;
+}
+
+#pragma endregion
+
+void FArenaMassSink::GetEntities(TArray<FMassEntityHandle>& OutEntities) const
+{
+	OutEntities.Reset();
+	for (const FEntityBatch& Batch : Batches)
+	{
+		OutEntities.Append(Batch.Entities);
+	}
+}
+
+FMassEntityManager* FArenaMassSink::GetEntityManager() const
+{
+	UMassEntitySubsystem* Subsystem = EntitySubsystem.Get();
+	return Subsystem ? &Subsystem->GetMutableEntityManager() : nullptr;
+}
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaMeshMetrics.h"
+#include "Engine/StaticMesh.h"
+#include "ArenaLayoutPlanner.h"
+
+TMap<FObjectKey, FArenaMeshMetrics>& FArenaMeshMetricsCache::GetCache()
+{
+	static TMap<FObjectKey, FArenaMeshMetrics> Cache;
+	return Cache;
+}
+
+const FArenaMeshMetrics& FArenaMeshMetricsCache::Get(const UStaticMesh* Mesh)
+{
+	check(IsInGameThread());
+
+	static const FArenaMeshMetrics Empty;
+	if (!Mesh) { return Empty; }
+
+	TMap<FObjectKey, FArenaMeshMetrics>& Cache = GetCache();
+	if (const FArenaMeshMetrics* Cached = Cache.Find(Mesh)) {
+		return *Cached;
+	}
+
+	const FBoxSphereBounds Bounds = Mesh->GetBounds();
+
+	FArenaMeshMetrics& Metrics = Cache.Add(Mesh);
+	Metrics.Dimensions = Bounds.BoxExtent * 2.0;
+	Metrics.PivotToCenter = FVector(Bounds.Origin.X, Bounds.Origin.Y, 0.0);
+
+	return Metrics;
+}
+
+void FArenaMeshMetricsCache::Reset()
+{
+	GetCache().Empty();
+}
+
+FVector FArenaMeshMetricsCache::GetPivotToCenter(const FArenaMesh& ArenaMesh, const FVector& GroupDimensions)
+{
+	switch (ArenaMesh.OriginType) {
+		case EOriginPlacementType::FromMeshBounds:
+		{
+			return Get(ArenaMesh.Mesh).PivotToCenter;
+		}
+		case EOriginPlacementType::Custom:
+		{
+			return ArenaMesh.CustomPivotToCenter;
+		}
+		default:
+		{
+			//Corner origins span the group's dimensions
+			return FArenaLayoutPlanner::OriginOffsetScalar(ArenaMesh.OriginType) * GroupDimensions;
+		}
+	}
+}
+
+void FArenaMeshMetricsCache::ResolveInputs(FArenaLayoutInputs& Inputs)
+{
+	Inputs.MeshPivotOffsets.SetNum(Inputs.MeshGroups.Num());
+
+	for (int32 GroupIdx = 0; GroupIdx < Inputs.MeshGroups.Num(); ++GroupIdx)
+	{
+		FArenaMeshGroupConfig& Group = Inputs.MeshGroups[GroupIdx];
+
+		if (Group.bDimensionsFromMeshBounds)
+		{
+			FVector Dimensions(0.f);
+			for (const FArenaMesh& ArenaMesh : Group.GroupMeshes)
+			{
+				Dimensions = Dimensions.ComponentMax(Get(ArenaMesh.Mesh).Dimensions);
+			}
+
+			//A group without meshes keeps its typed dimensions, the planner reports it
+			if (!Dimensions.IsNearlyZero()) {
+				Group.MeshDimensions = Dimensions;
+			}
+		}
+
+		TArray<FVector>& Offsets = Inputs.MeshPivotOffsets[GroupIdx];
+		Offsets.Reset(Group.GroupMeshes.Num());
+		for (const FArenaMesh& ArenaMesh : Group.GroupMeshes)
+		{
+			FVector Offset = GetPivotToCenter(ArenaMesh, Group.MeshDimensions);
+
+			//Measured offsets follow the mesh's scale, corner origins span the unscaled dimensions like tile spacing does
+			if (ArenaMesh.OriginType == EOriginPlacementType::FromMeshBounds || ArenaMesh.OriginType == EOriginPlacementType::Custom) {
+				Offset *= Group.MeshScale;
+			}
+
+			Offsets.Add(Offset);
+		}
+	}
+}
@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaNoise.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	//Positions per worker task, small batches are not worth the dispatch
+	constexpr int32 WarpBatchSize = 1024;
+
+	FORCEINLINE float Fade(float T) { return T * T * T * (T * (T * 6.f - 15.f) + 10.f); }
+
+	//One of 12 gradients pointing to the edges of a cube
+	FORCEINLINE float GradDot(uint32 Hash, float X, float Y, float Z)
+	{
+		switch (Hash % 12)
+		{
+			case 0: { return  X + Y; }
+			case 1: { return -X + Y; }
+			case 2: { return  X - Y; }
+			case 3: { return -X - Y; }
+			case 4: { return  X + Z; }
+			case 5: { return -X + Z; }
+			case 6: { return  X - Z; }
+			case 7: { return -X - Z; }
+			case 8: { return  Y + Z; }
+			case 9: { return -Y + Z; }
+			case 10: { return  Y - Z; }
+			default: { return -Y - Z; }
+		}
+	}
+
+	FORCEINLINE float HashToUnit(uint32 Hash) { return (Hash & 0xFFFFFF) * (2.f / 16777215.f) - 1.f; }
+}
+
+uint32 FArenaNoise::Hash(int32 X, int32 Y, int32 Z, uint32 Seed)
+{
+	uint32 H = Seed ^ (uint32(X) * 0x8da6b343u) ^ (uint32(Y) * 0xd8163841u) ^ (uint32(Z) * 0xcb1ab31fu);
+	H ^= H >> 16;
+	H *= 0x7feb352du;
+	H ^= H >> 15;
+	H *= 0x846ca68bu;
+	H ^= H >> 16;
+	return H;
+}
+
+float FArenaNoise::Value3D(const FVector& P, uint32 Seed)
+{
+	const int32 X0 = FMath::FloorToInt(P.X), Y0 = FMath::FloorToInt(P.Y), Z0 = FMath::FloorToInt(P.Z);
+	const float U = Fade(P.X - X0), V = Fade(P.Y - Y0), W = Fade(P.Z - Z0);
+
+	const float X00 = FMath::Lerp(HashToUnit(Hash(X0, Y0, Z0, Seed)), HashToUnit(Hash(X0 + 1, Y0, Z0, Seed)), U);
+	const float X10 = FMath::Lerp(HashToUnit(Hash(X0, Y0 + 1, Z0, Seed)), HashToUnit(Hash(X0 + 1, Y0 + 1, Z0, Seed)), U);
+	const float X01 = FMath::Lerp(HashToUnit(Hash(X0, Y0, Z0 + 1, Seed)), HashToUnit(Hash(X0 + 1, Y0, Z0 + 1, Seed)), U);
+	const float X11 = FMath::Lerp(HashToUnit(Hash(X0, Y0 + 1, Z0 + 1, Seed)), HashToUnit(Hash(X0 + 1, Y0 + 1, Z0 + 1, Seed)), U);
+
+	return FMath::Lerp(FMath::Lerp(X00, X10, V), FMath::Lerp(X01, X11, V), W);
+}
+
+float FArenaNoise::Perlin3D(const FVector& P, uint32 Seed)
+{
+	const int32 X0 = FMath::FloorToInt(P.X), Y0 = FMath::FloorToInt(P.Y), Z0 = FMath::FloorToInt(P.Z);
+	const float FX = P.X - X0, FY = P.Y - Y0, FZ = P.Z - Z0;
+	const float U = Fade(FX), V = Fade(FY), W = Fade(FZ);
+
+	const float X00 = FMath::Lerp(GradDot(Hash(X0, Y0, Z0, Seed), FX, FY, FZ), GradDot(Hash(X0 + 1, Y0, Z0, Seed), FX - 1.f, FY, FZ), U);
+	const float X10 = FMath::Lerp(GradDot(Hash(X0, Y0 + 1, Z0, Seed), FX, FY - 1.f, FZ), GradDot(Hash(X0 + 1, Y0 + 1, Z0, Seed), FX - 1.f, FY - 1.f, FZ), U);
+	const float X01 = FMath::Lerp(GradDot(Hash(X0, Y0, Z0 + 1, Seed), FX, FY, FZ - 1.f), GradDot(Hash(X0 + 1, Y0, Z0 + 1, Seed), FX - 1.f, FY, FZ - 1.f), U);
+	const float X11 = FMath::Lerp(GradDot(Hash(X0, Y0 + 1, Z0 + 1, Seed), FX, FY - 1.f, FZ - 1.f), GradDot(Hash(X0 + 1, Y0 + 1, Z0 + 1, Seed), FX - 1.f, FY - 1.f, FZ - 1.f), U);
+
+	return FMath::Lerp(FMath::Lerp(X00, X10, V), FMath::Lerp(X01, X11, V), W);
+}
+
+float FArenaNoise::Simplex3D(const FVector& P, uint32 Seed)
+{
+	constexpr float F3 = 1.f / 3.f;
+	constexpr float G3 = 1.f / 6.f;
+
+	//Skew into simplex space to find the containing cell
+	const float S = (P.X + P.Y + P.Z) * F3;
+	const int32 I = FMath::FloorToInt(P.X + S), J = FMath::FloorToInt(P.Y + S), K = FMath::FloorToInt(P.Z + S);
+	const float T = (I + J + K) * G3;
+	const float X0 = P.X - (I - T), Y0 = P.Y - (J - T), Z0 = P.Z - (K - T);
+
+	//Find which of the six simplices of the cell contains the point
+	int32 I1, J1, K1, I2, J2, K2;
+	if (X0 >= Y0) {
+		if (Y0 >= Z0) { I1 = 1; J1 = 0; K1 = 0; I2 = 1; J2 = 1; K2 = 0; }
+		else if (X0 >= Z0) { I1 = 1; J1 = 0; K1 = 0; I2 = 1; J2 = 0; K2 = 1; }
+		else { I1 = 0; J1 = 0; K1 = 1; I2 = 1; J2 = 0; K2 = 1; }
+	}
+	else {
+		if (Y0 < Z0) { I1 = 0; J1 = 0; K1 = 1; I2 = 0; J2 = 1; K2 = 1; }
+		else if (X0 < Z0) { I1 = 0; J1 = 1; K1 = 0; I2 = 0; J2 = 1; K2 = 1; }
+		else { I1 = 0; J1 = 1; K1 = 0; I2 = 1; J2 = 1; K2 = 0; }
+	}
+
+	const float Corners[4][3] = {
+		{ X0, Y0, Z0 },
+		{ X0 - I1 + G3, Y0 - J1 + G3, Z0 - K1 + G3 },
+		{ X0 - I2 + 2.f * G3, Y0 - J2 + 2.f * G3, Z0 - K2 + 2.f * G3 },
+		{ X0 - 1.f + 3.f * G3, Y0 - 1.f + 3.f * G3, Z0 - 1.f + 3.f * G3 } };
+	const int32 Offsets[4][3] = { { 0, 0, 0 }, { I1, J1, K1 }, { I2, J2, K2 }, { 1, 1, 1 } };
+
+	float Sum = 0.f;
+	for (int32 c = 0; c < 4; ++c)
+	{
+		const float CX = Corners[c][0], CY = Corners[c][1], CZ = Corners[c][2];
+		float Falloff = 0.6f - CX * CX - CY * CY - CZ * CZ;
+		if (Falloff <= 0.f) { continue; }
+
+		Falloff *= Falloff;
+		Sum += Falloff * Falloff * GradDot(Hash(I + Offsets[c][0], J + Offsets[c][1], K + Offsets[c][2], Seed), CX, CY, CZ);
+	}
+
+	//Scale to roughly [-1, 1]
+	return 32.f * Sum;
+}
+
+float FArenaNoise::Fractal3D(const FArenaWarpField& Field, const FVector& P, uint32 Seed)
+{
+	float Sum = 0.f;
+	float Amplitude = 1.f;
+	float AmplitudeSum = 0.f;
+	float Frequency = Field.Frequency;
+
+	const int32 Octaves = FMath::Clamp(Field.Octaves, 1, 8);
+	for (int32 Octave = 0; Octave < Octaves; ++Octave)
+	{
+		const FVector Sample = P * Frequency;
+		const uint32 OctaveSeed = Seed + Octave * 0x9e3779b9u;
+
+		float Noise = 0.f;
+		switch (Field.NoiseType) {
+			case EArenaWarpNoiseType::Value: { Noise = Value3D(Sample, OctaveSeed); }break;
+			case EArenaWarpNoiseType::Perlin: { Noise = Perlin3D(Sample, OctaveSeed); }break;
+			case EArenaWarpNoiseType::Simplex: { Noise = Simplex3D(Sample, OctaveSeed); }break;
+			default: { return 0.f; }
+		}
+
+		Sum += Noise * Amplitude;
+		AmplitudeSum += Amplitude;
+		Amplitude *= Field.Persistence;
+		Frequency *= Field.Lacunarity;
+	}
+
+	return AmplitudeSum > 0.f ? Sum / AmplitudeSum : 0.f;
+}
+
+void FArenaNoise::SampleWarpField(const FArenaWarpField& Field, int32 Seed, TArrayView<const FVector> Positions, TArrayView<FVector> OutOffsets)
+{
+	check(Positions.Num() == OutOffsets.Num());
+
+	if (!Field.IsEnabled())
+	{
+		for (FVector& Offset : OutOffsets) { Offset = FVector(0.f); }
+		return;
+	}
+
+	const uint32 FieldSeed = Hash(Seed, Field.SeedOffset, 0, 0x2545f491u);
+	const int32 NumBatches = FMath::DivideAndRoundUp(Positions.Num(), WarpBatchSize);
+
+	//Each batch walks a contiguous range of positions, the loop body has no shared state
+	ParallelFor(NumBatches, [&](int32 BatchIdx)
+	{
+		const int32 Start = BatchIdx * WarpBatchSize;
+		const int32 End = FMath::Min(Start + WarpBatchSize, Positions.Num());
+
+		for (int32 Idx = Start; Idx < End; ++Idx)
+		{
+			//Each axis reads its own seed so the offsets are not correlated with each other
+			const FVector& P = Positions[Idx];
+			OutOffsets[Idx] = FVector(
+				Fractal3D(Field, P, FieldSeed),
+				Fractal3D(Field, P, FieldSeed + 1),
+				Fractal3D(Field, P, FieldSeed + 2)) * Field.Amplitude;
+		}
+	}, NumBatches < 2 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
@@ -0,0 +1,194 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaOutputSink.h"
+#include "Misc/ScopeLock.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "BaseArenaGenerator.h"
+#include "ArenaMassSink.h"
+#include "ArenaGeneratorLog.h"
+
+const FName FArenaOutputSinkRegistry::ISMSinkName(TEXT("ISM"));
+const FName FArenaOutputSinkRegistry::HISMSinkName(TEXT("HISM"));
+const FName FArenaOutputSinkRegistry::ActorSinkName(TEXT("Actors"));
+const FName FArenaOutputSinkRegistry::CountingSinkName(TEXT("Counting"));
+
+#pragma region Built-in Sinks
+
+FArenaInstancedMeshSink::FArenaInstancedMeshSink(UClass* InComponentClass)
+	: ComponentClass(InComponentClass)
+{
+}
+
+void FArenaInstancedMeshSink::BeginCommit(FArenaSinkContext& Context, const FArenaLayoutPlan& Plan)
+{
+	//Components created for the set from now on use this sink's class
+	Context.Target.ComponentClass = ComponentClass;
+}
+
+void FArenaInstancedMeshSink::CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles)
+{
+	QueueInstances(Context, Pattern, Tiles);
+}
+
+void FArenaInstancedMeshSink::CommitSubTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> SubTiles)
+{
+	//Sub meshes have their own components in the group, past the group's meshes
+	QueueInstances(Context, Pattern, SubTiles);
+}
+
+bool FArenaInstancedMeshSink::CanUpdateInPlace(const FArenaInstanceSet& Set) const
+{
+	//Components of another sink's class would be kept, and new ones created with it
+	return Set.ComponentClass == ComponentClass;
+}
+
+void FArenaInstancedMeshSink::QueueInstances(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles)
+{
+	const int32 ReRouteIdx = Context.Generator.FindOrCreateGroupInstances(Context.Target, Pattern.GroupIdx);
+	if (!Context.Target.MeshInstances.IsValidIndex(ReRouteIdx)) { return; }
+
+	const TArray<UInstancedStaticMeshComponent*>& Components = Context.Target.MeshInstances[ReRouteIdx];
+	FArenaCommitQueue& Queue = Context.Queue;
+
+	for (const FArenaPlannedTile& Tile : Tiles)
+	{
+		UInstancedStaticMeshComponent* Component = Components.IsValidIndex(Tile.MeshIdx) ? Components[Tile.MeshIdx] : nullptr;
+		if (!Component) {
+			ArenaGenLog_ErrorSilent("Could not find Mesh Instance of group: %d at index: %d", Pattern.GroupIdx, Tile.MeshIdx);
+			continue;
+		}
+
+		//One batch per component for the whole plan
+		int32& BatchIdx = Queue.ComponentBatches.FindOrAdd(Component, INDEX_NONE);
+		if (BatchIdx == INDEX_NONE)
+		{
+			BatchIdx = Queue.InstanceBatches.Num();
+			Queue.InstanceBatches.AddDefaulted_GetRef().Component = Component;
+		}
+
+		Queue.InstanceBatches[BatchIdx].Transforms.Add(Tile.Transform);
+	}
+}
+
+void FArenaActorSink::CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles)
+{
+	const TArray<FArenaActorConfig>& ActorGroups = Context.Generator.ActorGroups;
+	if (!ActorGroups.IsValidIndex(Pattern.GroupIdx)) { return; }
+
+	const TArray<TSubclassOf<AActor>>& Classes = ActorGroups[Pattern.GroupIdx].ClassesToSpawn;
+	Context.Queue.ActorSpawns.Reserve(Context.Queue.ActorSpawns.Num() + Tiles.Num());
+
+	for (const FArenaPlannedTile& Tile : Tiles)
+	{
+		if (Classes.IsValidIndex(Tile.MeshIdx)) {
+			Context.Queue.ActorSpawns.Add({ Classes[Tile.MeshIdx], Tile.Transform });
+		}
+	}
+}
+
+void FArenaCountingSink::BeginCommit(FArenaSinkContext& Context, const FArenaLayoutPlan& Plan)
+{
+	NumPatterns = 0;
+	NumTiles = 0;
+	NumSubTiles = 0;
+	CommitStartTime = FPlatformTime::Seconds();
+}
+
+void FArenaCountingSink::CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles)
+{
+	NumPatterns++;
+	NumTiles += Tiles.Num();
+}
+
+void FArenaCountingSink::CommitSubTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> SubTiles)
+{
+	NumSubTiles += SubTiles.Num();
+}
+
+void FArenaCountingSink::EndCommit(FArenaSinkContext& Context)
+{
+	ArenaGenLog_InfoSilent("Counting sink received %lld patterns, %lld tiles, %lld sub tiles in %.3f ms", NumPatterns, NumTiles, NumSubTiles, (FPlatformTime::Seconds() - CommitStartTime) * 1000.0);
+}
+
+#pragma endregion
+
+#pragma region Registry
+
+FArenaOutputSinkRegistry& FArenaOutputSinkRegistry::Get()
+{
+	static FArenaOutputSinkRegistry Registry;
+	return Registry;
+}
+
+void FArenaOutputSinkRegistry::RegisterSink(FName Name, FSinkFactory Factory)
+{
+	FScopeLock Lock(&FactoriesLock);
+	Factories.Add(Name, MoveTemp(Factory));
+}
+
+void FArenaOutputSinkRegistry::UnregisterSink(FName Name)
+{
+	FScopeLock Lock(&FactoriesLock);
+	Factories.Remove(Name);
+}
+
+TSharedPtr<IArenaOutputSink> FArenaOutputSinkRegistry::CreateSink(FName Name) const
+{
+	FScopeLock Lock(&FactoriesLock);
+	const FSinkFactory* Factory = Factories.Find(Name);
+	return Factory ? TSharedPtr<IArenaOutputSink>((*Factory)()) : nullptr;
+}
+
+TArray<FName> FArenaOutputSinkRegistry::GetSinkNames() const
+{
+	FScopeLock Lock(&FactoriesLock);
+	TArray<FName> Names;
+	Factories.GetKeys(Names);
+	return Names;
+}
+
+void FArenaOutputSinkRegistry::RegisterBuiltInSinks()
+{
+	FArenaOutputSinkRegistry& Registry = Get();
+	Registry.RegisterSink(ISMSinkName, []() { return MakeShared<FArenaInstancedMeshSink>(UInstancedStaticMeshComponent::StaticClass()); });
+	Registry.RegisterSink(HISMSinkName, []() { return MakeShared<FArenaInstancedMeshSink>(UHierarchicalInstancedStaticMeshComponent::StaticClass()); });
+	Registry.RegisterSink(ActorSinkName, []() { return MakeShared<FArenaActorSink>(); });
+	Registry.RegisterSink(CountingSinkName, []() { return MakeShared<FArenaCountingSink>(); });
+	Registry.RegisterSink(FArenaMassSink::SinkName, []() { return MakeShared<FArenaMassSink>(); });
+}
+
+void FArenaOutputSinkRegistry::UnregisterBuiltInSinks()
+{
+	FArenaOutputSinkRegistry& Registry = Get();
+	Registry.UnregisterSink(ISMSinkName);
+	Registry.UnregisterSink(HISMSinkName);
+	Registry.UnregisterSink(ActorSinkName);
+	Registry.UnregisterSink(CountingSinkName);
+	Registry.UnregisterSink(FArenaMassSink::SinkName);
+}
+
+#pragma endregion
@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaParameterExplorer.h"
+#include "Async/ParallelFor.h"
+#include "Algo/StableSort.h"
+#include "ArenaLayoutPlanner.h"
+#include "ArenaGeneratorLog.h"
+
+namespace
+{
+	int32 NumRadiusSteps(const FArenaParameterSweep& Sweep)
+	{
+		if (Sweep.RadiusStep <= 0.f || Sweep.RadiusMax < Sweep.RadiusMin) { return 1; }
+		return FMath::FloorToInt((Sweep.RadiusMax - Sweep.RadiusMin) / Sweep.RadiusStep) + 1;
+	}
+
+	float GetSortKey(const FArenaVariant& Variant, EArenaVariantSort SortBy)
+	{
+		switch (SortBy) {
+			case EArenaVariantSort::Radius: { return Variant.Fit.InscribedRadius; }
+			case EArenaVariantSort::Sides: { return Variant.Fit.ArenaSides; }
+			case EArenaVariantSort::TilesPerSide: { return Variant.Fit.TilesPerArenaSide; }
+			default:
+			case EArenaVariantSort::Instances: { return Variant.PredictedInstances + Variant.PredictedActors; }
+		}
+	}
+}
+
+int64 FArenaParameterExplorer::CountCombinations(const FArenaParameterSweep& Sweep)
+{
+	const int64 NumSides = FMath::Max(Sweep.SidesMax - Sweep.SidesMin + 1, 0);
+	const int64 NumTiles = FMath::Max(Sweep.TilesPerSideMax - Sweep.TilesPerSideMin + 1, 0);
+
+	return NumSides * NumTiles * NumRadiusSteps(Sweep)
+		* FMath::Max(Sweep.PolygonGroups.Num(), 1)
+		* FMath::Max(Sweep.GridGroups.Num(), 1);
+}
+
+void FArenaParameterExplorer::Explore(const FArenaLayoutInputs& Inputs, const FArenaParameterSweep& Sweep, TArray<FArenaVariant>& OutVariants)
+{
+	OutVariants.Reset();
+
+	const int64 NumCombinations = CountCombinations(Sweep);
+	if (NumCombinations <= 0) { return; }
+
+	if (NumCombinations > MaxCombinations)
+	{
+		ArenaGenLog_WarningSilent("Parameter sweep has %lld combinations, more than the %lld allowed. Narrow the ranges.", NumCombinations, MaxCombinations);
+		return;
+	}
+
+	const int32 NumSides = Sweep.SidesMax - Sweep.SidesMin + 1;
+	const int32 NumTiles = Sweep.TilesPerSideMax - Sweep.TilesPerSideMin + 1;
+	const int32 NumRadii = NumRadiusSteps(Sweep);
+	const int32 NumPolygonGroups = FMath::Max(Sweep.PolygonGroups.Num(), 1);
+
+	const int32 NumJobs = static_cast<int32>(NumCombinations);
+
+	TArray<FArenaVariant> Variants;
+	TArray<bool> Accepted;
+	int32 NumAccepted = 0;
+
+	for (int32 BatchStart = 0; BatchStart < NumJobs; BatchStart += BatchSize)
+	{
+		const int32 NumBatchJobs = FMath::Min(BatchSize, NumJobs - BatchStart);
+
+		Variants.Reset();
+		Variants.SetNum(NumBatchJobs);
+		Accepted.Reset();
+		Accepted.SetNumZeroed(NumBatchJobs);
+
+		ParallelFor(NumBatchJobs, [&](int32 BatchIdx)
+		{
+			//Decode the combination, sides vary fastest
+			int32 Rest = BatchStart + BatchIdx;
+			const int32 SidesIdx = Rest % NumSides; Rest /= NumSides;
+			const int32 TilesIdx = Rest % NumTiles; Rest /= NumTiles;
+			const int32 RadiusIdx = Rest % NumRadii; Rest /= NumRadii;
+			const int32 PolygonGroupIdx = Rest % NumPolygonGroups; Rest /= NumPolygonGroups;
+			const int32 GridGroupIdx = Rest;
+
+			FArenaVariant& Variant = Variants[BatchIdx];
+			Variant.TargetSides = Sweep.SidesMin + SidesIdx;
+			Variant.TargetTilesPerSide = Sweep.TilesPerSideMin + TilesIdx;
+			Variant.TargetRadius = Sweep.RadiusStep > 0.f ? Sweep.RadiusMin + Sweep.RadiusStep * RadiusIdx : Sweep.BaseSection.Targets.TargetInscribedRadius;
+			Variant.PolygonGroup = Sweep.PolygonGroups.IsValidIndex(PolygonGroupIdx) ? Sweep.PolygonGroups[PolygonGroupIdx] : INDEX_NONE;
+			Variant.GridGroup = Sweep.GridGroups.IsValidIndex(GridGroupIdx) ? Sweep.GridGroups[GridGroupIdx] : INDEX_NONE;
+
+			FArenaSection Section = Sweep.BaseSection;
+			Section.Targets.TargetPolygonSides = Variant.TargetSides;
+			Section.Targets.TargetTilesPerSide = Variant.TargetTilesPerSide;
+			Section.Targets.TargetInscribedRadius = Variant.TargetRadius;
+
+			for (FArenaSectionBuildRules& Rules : Section.BuildRules)
+			{
+				if (Rules.AssetToPlace != ETypeToPlace::StaticMeshes) { continue; }
+
+				if (Rules.SectionType == EArenaSectionType::Polygon && Variant.PolygonGroup != INDEX_NONE) { Rules.ObjectGroupId = Variant.PolygonGroup; }
+				if (Rules.SectionType == EArenaSectionType::HorizontalGrid && Variant.GridGroup != INDEX_NONE) { Rules.ObjectGroupId = Variant.GridGroup; }
+			}
+
+			//Most combinations get adjusted, logging each of them from the workers would flood the log
+			FArenaLayoutPlanner Planner(Inputs, FRandomStream(0));
+			Planner.SetQuiet(true);
+			if (!Planner.PredictSectionTiles(Section, Variant.PredictedInstances, Variant.PredictedActors)) { return; }
+			Variant.Fit = Planner.GetSectionFit();
+
+			//Filters
+			if (Sweep.bOnlyUnadjusted && (Variant.Fit.bAdjusted || !Variant.Fit.bWithinBudget)) { return; }
+			if (Sweep.MaxInstances > 0 && Variant.PredictedInstances + Variant.PredictedActors > Sweep.MaxInstances) { return; }
+			if (Variant.Fit.InscribedRadius < Sweep.MinResultRadius) { return; }
+			if (Sweep.MaxResultRadius > 0.f && Variant.Fit.InscribedRadius > Sweep.MaxResultRadius) { return; }
+
+			Accepted[BatchIdx] = true;
+		});
+
+		for (int32 BatchIdx = 0; BatchIdx < NumBatchJobs; ++BatchIdx)
+		{
+			if (Accepted[BatchIdx]) {
+				OutVariants.Add(MoveTemp(Variants[BatchIdx]));
+				NumAccepted++;
+			}
+		}
+
+		//Keep only the best results so far. Sorting is stable and batches run in sweep order, so ties keep the order of a single sort.
+		if (Sweep.MaxResults > 0 && OutVariants.Num() > 2 * Sweep.MaxResults)
+		{
+			SortVariants(OutVariants, Sweep.SortBy, Sweep.bSortDescending);
+			OutVariants.SetNum(Sweep.MaxResults);
+		}
+	}
+
+	SortVariants(OutVariants, Sweep.SortBy, Sweep.bSortDescending);
+
+	if (Sweep.MaxResults > 0 && OutVariants.Num() > Sweep.MaxResults)
+	{
+		OutVariants.SetNum(Sweep.MaxResults);
+	}
+
+	ArenaGenLog_InfoSilent("Parameter sweep evaluated %lld combinations, %d accepted.", NumCombinations, NumAccepted);
+}
+
+void FArenaParameterExplorer::SortVariants(TArray<FArenaVariant>& Variants, EArenaVariantSort SortBy, bool bDescending)
+{
+	//Stable so combinations with equal keys keep the sweep order
+	Algo::StableSortBy(Variants, [SortBy, bDescending](const FArenaVariant& Variant)
+	{
+		const float Key = GetSortKey(Variant, SortBy);
+		return bDescending ? -Key : Key;
+	});
+}
@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "ArenaLayoutPlanner.h"
+#include "ArenaAdjacencySolver.h"
+#include "ArenaGeneratorLog.h"
+
+/* Arena Planner Benchmarks
+* Console commands timing hot parts of the planner, against their previous implementation where there is one.
+* Not compiled into shipping builds.
+*/
+
+#if !UE_BUILD_SHIPPING
+
+namespace ArenaPlannerBenchmarks
+{
+	//Usage: ArenaGen.BenchConcavity [Columns=16] [Rows=16] [Sides=120] [Iterations=50]
+	//Times concavity of a polygon pattern per tile against the per-pattern lookup table
+	static void BenchConcavity(const TArray<FString>& Args)
+	{
+		const int32 Columns = FMath::Max(Args.IsValidIndex(0) ? FCString::Atoi(*Args[0]) : 16, 1);
+		const int32 Rows = FMath::Max(Args.IsValidIndex(1) ? FCString::Atoi(*Args[1]) : 16, 1);
+		const int32 Sides = FMath::Max(Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : 120, 1);
+		const int32 Iterations = FMath::Max(Args.IsValidIndex(3) ? FCString::Atoi(*Args[3]) : 50, 1);
+
+		const float Strength = 150.f;
+		const int32 Midpoint = FMath::Max(Columns / 2, 1);
+		const FVector Direction(0.f, 1.f, 0.f);
+
+		//Accumulated so the loops cannot be optimized away
+		FVector SumPerTile(0.f);
+		FVector SumTable(0.f);
+
+		const double PerTileStart = FPlatformTime::Seconds();
+		for (int32 It = 0; It < Iterations; ++It)
+		{
+			for (int32 Side = 0; Side < Sides; ++Side)
+			{
+				for (int32 Col = 0; Col < Columns; ++Col)
+				{
+					for (int32 Row = 0; Row < Rows; ++Row)
+					{
+						SumPerTile += FArenaLayoutPlanner::PlacementWarpingConcavity(Midpoint, Midpoint, Col, Row, Strength, Direction);
+					}
+				}
+			}
+		}
+		const double PerTileSeconds = FPlatformTime::Seconds() - PerTileStart;
+
+		const double TableStart = FPlatformTime::Seconds();
+		for (int32 It = 0; It < Iterations; ++It)
+		{
+			FArenaConcavityTable Table;
+			Table.Build(Midpoint, Midpoint, Columns, Rows, Strength);
+
+			for (int32 Side = 0; Side < Sides; ++Side)
+			{
+				for (int32 Col = 0; Col < Columns; ++Col)
+				{
+					for (int32 Row = 0; Row < Rows; ++Row)
+					{
+						SumTable += Direction * Table.Get(Col, Row);
+					}
+				}
+			}
+		}
+		const double TableSeconds = FPlatformTime::Seconds() - TableStart;
+
+		const int64 NumTiles = int64(Iterations) * Sides * Columns * Rows;
+		ArenaGenLog_Info("Concavity over %lld tiles: per tile %.3f ms, table %.3f ms (x%.2f). Results match: %s",
+			NumTiles, PerTileSeconds * 1000.0, TableSeconds * 1000.0,
+			TableSeconds > 0.0 ? PerTileSeconds / TableSeconds : 0.0,
+			SumPerTile.Equals(SumTable, 0.01f) ? TEXT("true") : TEXT("false"));
+	}
+
+	static FAutoConsoleCommand BenchConcavityCommand(
+		TEXT("ArenaGen.BenchConcavity"),
+		TEXT("Times per-tile concavity against the per-pattern lookup table. Args: [Columns] [Rows] [Sides] [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchConcavity));
+
+	//Usage: ArenaGen.BenchAdjacency [Columns=100] [Rows=100] [Meshes=8] [Seed=0]
+	//Solves a plane where each mesh only accepts itself and the meshes one index away, wrapping around
+	static void BenchAdjacency(const TArray<FString>& Args)
+	{
+		const int32 Columns = FMath::Max(Args.IsValidIndex(0) ? FCString::Atoi(*Args[0]) : 100, 1);
+		const int32 Rows = FMath::Max(Args.IsValidIndex(1) ? FCString::Atoi(*Args[1]) : 100, 1);
+		const int32 NumMeshes = FMath::Clamp(Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : 8, 1, FArenaAdjacencyRules::MaxMeshes);
+		const int32 Seed = Args.IsValidIndex(3) ? FCString::Atoi(*Args[3]) : 0;
+
+		FArenaMeshGroupConfig Group;
+		Group.GroupMeshes.SetNum(NumMeshes);
+		for (int32 MeshIdx = 0; MeshIdx < NumMeshes; ++MeshIdx)
+		{
+			const TArray<int32> Accepted = { MeshIdx, (MeshIdx + 1) % NumMeshes, (MeshIdx + NumMeshes - 1) % NumMeshes };
+
+			FArenaMeshAdjacency& Adjacency = Group.GroupMeshes[MeshIdx].Adjacency;
+			Adjacency.North = Accepted;
+			Adjacency.East = Accepted;
+			Adjacency.South = Accepted;
+			Adjacency.West = Accepted;
+		}
+
+		FArenaAdjacencyRules Rules;
+		Rules.BuildFromGroup(Group);
+
+		FArenaAdjacencySolver Solver(Rules);
+		FArenaAdjacencyResult Result;
+		Solver.Solve(Columns, Rows, Seed, 32, Result);
+
+		ArenaGenLog_Info("Adjacency over %d x %d cells, %d meshes: %s in %.3f ms, %d attempts, %d contradictions",
+			Columns, Rows, NumMeshes, Result.IsSolved() ? TEXT("solved") : TEXT("unsolved"),
+			Result.Seconds * 1000.0, Result.Attempts, Result.Contradictions);
+	}
+
+	static FAutoConsoleCommand BenchAdjacencyCommand(
+		TEXT("ArenaGen.BenchAdjacency"),
+		TEXT("Times the adjacency solver on a plane of neighboring-index rules. Args: [Columns] [Rows] [Meshes] [Seed]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchAdjacency));
+}
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,522 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaTileGraph.h"
+#include "ArenaLayoutPlanner.h"
+#include "Algo/Reverse.h"
+
+namespace
+{
+	//Footprints shrink by this much so tiles that only touch do not block each other
+	constexpr float ContactTolerance = 1.f;
+
+	//Volume of a static mesh tile that can block nodes and edges, relative to the generator
+	struct FGraphBlocker
+	{
+		FVector2f Center;
+		FVector2f Forward;
+		FVector2f HalfSize;
+		float Bottom = 0.f;
+		float Top = 0.f;
+
+		//Blocks an agent standing at Height when it rises past a step and starts below the agent's head
+		bool BlocksHeight(float Height, float MaxStep, float AgentHeight) const
+		{
+			return Top > Height + MaxStep && Bottom < Height + AgentHeight;
+		}
+
+		FVector2f ToLocal(const FVector2f& Point) const
+		{
+			const FVector2f Offset = Point - Center;
+			return FVector2f(Offset.X * Forward.X + Offset.Y * Forward.Y, Offset.Y * Forward.X - Offset.X * Forward.Y);
+		}
+
+		bool Contains(const FVector2f& Point) const
+		{
+			const FVector2f Local = ToLocal(Point);
+			return FMath::Abs(Local.X) < HalfSize.X && FMath::Abs(Local.Y) < HalfSize.Y;
+		}
+
+		//Slab test of the segment against the footprint
+		bool Intersects(const FVector2f& A, const FVector2f& B) const
+		{
+			const FVector2f LocalA = ToLocal(A);
+			const FVector2f Delta = ToLocal(B) - LocalA;
+
+			float Enter = 0.f;
+			float Exit = 1.f;
+			for (int32 Axis = 0; Axis < 2; ++Axis)
+			{
+				if (FMath::Abs(Delta[Axis]) < KINDA_SMALL_NUMBER)
+				{
+					if (FMath::Abs(LocalA[Axis]) >= HalfSize[Axis]) { return false; }
+					continue;
+				}
+
+				float Near = (-HalfSize[Axis] - LocalA[Axis]) / Delta[Axis];
+				float Far = (HalfSize[Axis] - LocalA[Axis]) / Delta[Axis];
+				if (Near > Far) { Swap(Near, Far); }
+
+				Enter = FMath::Max(Enter, Near);
+				Exit = FMath::Min(Exit, Far);
+				if (Enter > Exit) { return false; }
+			}
+
+			return true;
+		}
+	};
+
+	struct FGraphEdge
+	{
+		int32 From = 0;
+		int32 To = 0;
+		float Cost = 0.f;
+	};
+
+	struct FOpenNode
+	{
+		float Priority = 0.f;
+		int32 Node = 0;
+
+		bool operator<(const FOpenNode& Other) const { return Priority < Other.Priority; }
+	};
+
+	FIntPoint GetCell(const FVector2f& Point, float CellSize)
+	{
+		return FIntPoint(FMath::FloorToInt(Point.X / CellSize), FMath::FloorToInt(Point.Y / CellSize));
+	}
+}
+
+void FArenaTileGraph::Build(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, FArenaTileGraph& Out)
+{
+	Out.Reset();
+
+	const float MaxStep = Inputs.GraphMaxStepHeight;
+	const float AgentHeight = Inputs.GraphAgentHeight;
+
+	//Every static mesh tile can block, floors are also node candidates
+	TArray<FGraphBlocker> Blockers;
+	Blockers.Reserve(Plan.Tiles.Num());
+
+	TArray<int32> CandidateTiles;
+	TArray<int32> CandidatePatterns;
+	TArray<float> CandidateSizes;
+
+	TArray<FVector> PivotOffsets;
+	float CellSize = 0.f;
+
+	for (int32 PatternIdx = 0; PatternIdx < Plan.Patterns.Num(); ++PatternIdx)
+	{
+		const FArenaPlannedPattern& Pattern = Plan.Patterns[PatternIdx];
+		if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes || Pattern.NumTiles <= 0) { continue; }
+
+		FArenaLayoutPlanner::GetPivotOffsets(Inputs, Pattern, PivotOffsets);
+
+		const FVector2f HalfSize = FVector2f(Pattern.MeshSize.X * Pattern.MeshScale.X, Pattern.MeshSize.Y * Pattern.MeshScale.Y) * 0.5f;
+		const float TileHeight = Pattern.MeshSize.Z * Pattern.MeshScale.Z;
+		const bool bFloor = Pattern.SectionType == EArenaSectionType::HorizontalGrid;
+
+		CellSize = FMath::Max(CellSize, 2.f * FMath::Max(HalfSize.X, HalfSize.Y));
+
+		for (int32 TileIdx = Pattern.FirstTile; TileIdx < Pattern.FirstTile + Pattern.NumTiles; ++TileIdx)
+		{
+			const FArenaPlannedTile& Tile = Plan.Tiles[TileIdx];
+			const FVector Location = Tile.Transform.GetLocation();
+			const FRotator Yaw(0, Tile.Transform.Rotator().Yaw, 0);
+			const FVector Pivot = PivotOffsets.IsValidIndex(Tile.MeshIdx) ? PivotOffsets[Tile.MeshIdx] : FVector(0);
+
+			FGraphBlocker& Blocker = Blockers.AddDefaulted_GetRef();
+			Blocker.Center = FVector2f(FVector2D(Location + Yaw.RotateVector(FVector(Pivot.X, Pivot.Y, 0))));
+			Blocker.Forward = FVector2f(FVector2D(Yaw.Vector()));
+			Blocker.HalfSize = FVector2f(FMath::Max(HalfSize.X - ContactTolerance, 0.f), FMath::Max(HalfSize.Y - ContactTolerance, 0.f));
+			Blocker.Bottom = float(Location.Z);
+			Blocker.Top = float(Location.Z) + TileHeight;
+
+			if (bFloor)
+			{
+				CandidateTiles.Add(TileIdx);
+				CandidatePatterns.Add(PatternIdx);
+				CandidateSizes.Add(2.f * FMath::Max(HalfSize.X, HalfSize.Y));
+			}
+		}
+	}
+
+	if (CandidateTiles.IsEmpty() || CellSize <= KINDA_SMALL_NUMBER) { return; }
+
+	//Blockers are hashed in every cell their bounds overlap. Blockers are indexed like the static mesh tiles they were built from.
+	TMultiMap<FIntPoint, int32> BlockerCells;
+	TArray<int32> TileBlockers;
+	TileBlockers.Init(INDEX_NONE, Plan.Tiles.Num());
+	{
+		int32 BlockerIdx = 0;
+		for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+		{
+			if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes || Pattern.NumTiles <= 0) { continue; }
+
+			for (int32 TileIdx = Pattern.FirstTile; TileIdx < Pattern.FirstTile + Pattern.NumTiles; ++TileIdx, ++BlockerIdx)
+			{
+				const FGraphBlocker& Blocker = Blockers[BlockerIdx];
+				const FVector2f Extent(
+					FMath::Abs(Blocker.Forward.X) * Blocker.HalfSize.X + FMath::Abs(Blocker.Forward.Y) * Blocker.HalfSize.Y,
+					FMath::Abs(Blocker.Forward.Y) * Blocker.HalfSize.X + FMath::Abs(Blocker.Forward.X) * Blocker.HalfSize.Y);
+
+				const FIntPoint MinCell = GetCell(Blocker.Center - Extent, CellSize);
+				const FIntPoint MaxCell = GetCell(Blocker.Center + Extent, CellSize);
+				for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+				{
+					for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+					{
+						BlockerCells.Add(FIntPoint(X, Y), BlockerIdx);
+					}
+				}
+
+				TileBlockers[TileIdx] = BlockerIdx;
+			}
+		}
+	}
+
+	auto IsSegmentBlocked = [&](const FVector3f& A, const FVector3f& B)
+	{
+		const FVector2f A2(A.X, A.Y);
+		const FVector2f B2(B.X, B.Y);
+		const float Height = FMath::Max(A.Z, B.Z);
+
+		const FIntPoint MinCell = GetCell(A2.ComponentMin(B2), CellSize);
+		const FIntPoint MaxCell = GetCell(A2.ComponentMax(B2), CellSize);
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				for (auto It = BlockerCells.CreateConstKeyIterator(FIntPoint(X, Y)); It; ++It)
+				{
+					const FGraphBlocker& Blocker = Blockers[It.Value()];
+					if (Blocker.BlocksHeight(Height, MaxStep, AgentHeight) && Blocker.Intersects(A2, B2)) { return true; }
+				}
+			}
+		}
+		return false;
+	};
+
+	//A floor is walkable when no other tile covers its center between a step and the agent's head, the next layer of its stack included
+	TArray<int32> CandidateNodes;
+	CandidateNodes.Init(INDEX_NONE, Plan.Tiles.Num());
+
+	TArray<int32> NodePatterns;
+	TArray<float> NodeSizes;
+
+	for (int32 Candidate = 0; Candidate < CandidateTiles.Num(); ++Candidate)
+	{
+		const int32 TileIdx = CandidateTiles[Candidate];
+		const FGraphBlocker& Floor = Blockers[TileBlockers[TileIdx]];
+		const FVector3f Position(Floor.Center.X, Floor.Center.Y, Floor.Top);
+
+		bool bCovered = false;
+		for (auto It = BlockerCells.CreateConstKeyIterator(GetCell(Floor.Center, CellSize)); It && !bCovered; ++It)
+		{
+			const FGraphBlocker& Blocker = Blockers[It.Value()];
+			bCovered = Blocker.BlocksHeight(Position.Z, MaxStep, AgentHeight) && Blocker.Contains(Floor.Center);
+		}
+		if (bCovered) { continue; }
+
+		CandidateNodes[TileIdx] = Out.Positions.Add(Position);
+		Out.Tiles.Add(TileIdx);
+		NodePatterns.Add(CandidatePatterns[Candidate]);
+		NodeSizes.Add(CandidateSizes[Candidate]);
+	}
+
+	auto CanLink = [&](int32 NodeA, int32 NodeB)
+	{
+		const FVector3f& A = Out.Positions[NodeA];
+		const FVector3f& B = Out.Positions[NodeB];
+		return FMath::Abs(A.Z - B.Z) <= MaxStep && !IsSegmentBlocked(A, B);
+	};
+
+	TArray<FGraphEdge> Edges;
+	auto AddLink = [&Edges, &Out](int32 NodeA, int32 NodeB)
+	{
+		const float Cost = FVector3f::Dist(Out.Positions[NodeA], Out.Positions[NodeB]);
+		Edges.Add(FGraphEdge{ NodeA, NodeB, Cost });
+		Edges.Add(FGraphEdge{ NodeB, NodeA, Cost });
+	};
+
+	//Lattice neighbors, every layer of the neighboring column is a candidate
+	TArray<int32> Lattice;
+	for (int32 PatternIdx = 0; PatternIdx < Plan.Patterns.Num(); ++PatternIdx)
+	{
+		const FArenaPlannedPattern& Pattern = Plan.Patterns[PatternIdx];
+		if (Pattern.AssetToPlace != ETypeToPlace::StaticMeshes || Pattern.SectionType != EArenaSectionType::HorizontalGrid || Pattern.NumTiles <= 0) { continue; }
+
+		const int32 Slices = Pattern.Slices;
+		const int32 Columns = Pattern.Columns;
+		const int32 Rows = Pattern.Rows;
+		Lattice.Init(INDEX_NONE, Slices * Columns * Rows);
+
+		auto GetCellIdx = [Columns, Rows](int32 Slice, int32 Col, int32 Row) { return (Slice * Rows + Row) * Columns + Col; };
+
+		for (int32 TileIdx = Pattern.FirstTile; TileIdx < Pattern.FirstTile + Pattern.NumTiles; ++TileIdx)
+		{
+			const FArenaTileCoord& Coord = Plan.Tiles[TileIdx].Coord;
+			if (CandidateNodes[TileIdx] != INDEX_NONE && Coord.Slice < Slices && Coord.Column < Columns && Coord.Row < Rows) {
+				Lattice[GetCellIdx(Coord.Slice, Coord.Column, Coord.Row)] = CandidateNodes[TileIdx];
+			}
+		}
+
+		//Node of a lattice column within a step of Height. Layers of a column are at least an agent apart, so there is at most one.
+		auto FindStepNode = [&](int32 Col, int32 Row, float Height)
+		{
+			if (Col < 0 || Row < 0 || Col >= Columns || Row >= Rows) { return int32(INDEX_NONE); }
+
+			for (int32 Slice = 0; Slice < Slices; ++Slice)
+			{
+				const int32 Node = Lattice[GetCellIdx(Slice, Col, Row)];
+				if (Node != INDEX_NONE && FMath::Abs(Out.Positions[Node].Z - Height) <= MaxStep) { return Node; }
+			}
+			return int32(INDEX_NONE);
+		};
+
+		for (int32 Slice = 0; Slice < Slices; ++Slice)
+		{
+			for (int32 Row = 0; Row < Rows; ++Row)
+			{
+				for (int32 Col = 0; Col < Columns; ++Col)
+				{
+					const int32 Node = Lattice[GetCellIdx(Slice, Col, Row)];
+					if (Node == INDEX_NONE) { continue; }
+
+					const float Height = Out.Positions[Node].Z;
+
+					//Half of the directions, the other half links back from the neighbor
+					const int32 East = FindStepNode(Col + 1, Row, Height);
+					const int32 North = FindStepNode(Col, Row + 1, Height);
+					const bool bEast = East != INDEX_NONE && CanLink(Node, East);
+					const bool bNorth = North != INDEX_NONE && CanLink(Node, North);
+
+					if (bEast) { AddLink(Node, East); }
+					if (bNorth) { AddLink(Node, North); }
+
+					if (!Inputs.bGraphDiagonals || !bNorth) { continue; }
+
+					//Diagonals only where both sides are open, so paths never cut corners
+					const int32 NorthEast = FindStepNode(Col + 1, Row + 1, Height);
+					if (bEast && NorthEast != INDEX_NONE && CanLink(Node, NorthEast)) {
+						AddLink(Node, NorthEast);
+					}
+
+					const int32 West = FindStepNode(Col - 1, Row, Height);
+					const int32 NorthWest = FindStepNode(Col - 1, Row + 1, Height);
+					if (West != INDEX_NONE && NorthWest != INDEX_NONE && CanLink(Node, West) && CanLink(Node, NorthWest)) {
+						AddLink(Node, NorthWest);
+					}
+				}
+			}
+		}
+	}
+
+	//Floors of different patterns meeting side by side, found through a hash of the nodes
+	TMultiMap<FIntPoint, int32> NodeCells;
+	for (int32 Node = 0; Node < Out.Positions.Num(); ++Node)
+	{
+		NodeCells.Add(GetCell(FVector2f(Out.Positions[Node].X, Out.Positions[Node].Y), CellSize), Node);
+	}
+
+	for (int32 Node = 0; Node < Out.Positions.Num(); ++Node)
+	{
+		const FVector3f& Position = Out.Positions[Node];
+		const FIntPoint Cell = GetCell(FVector2f(Position.X, Position.Y), CellSize);
+
+		for (int32 Y = Cell.Y - 1; Y <= Cell.Y + 1; ++Y)
+		{
+			for (int32 X = Cell.X - 1; X <= Cell.X + 1; ++X)
+			{
+				for (auto It = NodeCells.CreateConstKeyIterator(FIntPoint(X, Y)); It; ++It)
+				{
+					const int32 Other = It.Value();
+					if (Other <= Node || NodePatterns[Other] == NodePatterns[Node]) { continue; }
+
+					//Side by side only, diagonal seams are left to the lattice
+					const float LinkDistance = 0.55f * (NodeSizes[Node] + NodeSizes[Other]);
+					if (FVector2f::DistSquared(FVector2f(Position.X, Position.Y), FVector2f(Out.Positions[Other].X, Out.Positions[Other].Y)) > FMath::Square(LinkDistance)) { continue; }
+
+					if (CanLink(Node, Other)) {
+						AddLink(Node, Other);
+					}
+				}
+			}
+		}
+	}
+
+	//Counting sort of the edges by source node
+	Out.EdgeOffsets.Init(0, Out.Positions.Num() + 1);
+	for (const FGraphEdge& Edge : Edges)
+	{
+		Out.EdgeOffsets[Edge.From + 1]++;
+	}
+	for (int32 Node = 0; Node < Out.Positions.Num(); ++Node)
+	{
+		Out.EdgeOffsets[Node + 1] += Out.EdgeOffsets[Node];
+	}
+
+	TArray<int32> NextEdge(Out.EdgeOffsets.GetData(), Out.Positions.Num());
+	Out.EdgeTargets.SetNumUninitialized(Edges.Num());
+	Out.EdgeCosts.SetNumUninitialized(Edges.Num());
+	for (const FGraphEdge& Edge : Edges)
+	{
+		const int32 Slot = NextEdge[Edge.From]++;
+		Out.EdgeTargets[Slot] = Edge.To;
+		Out.EdgeCosts[Slot] = Edge.Cost;
+	}
+}
+
+int32 FArenaTileGraph::FindNearestNode(const FVector& Location) const
+{
+	const FVector3f Target(Location);
+
+	int32 Nearest = INDEX_NONE;
+	float NearestDistSq = MAX_flt;
+	for (int32 Node = 0; Node < Positions.Num(); ++Node)
+	{
+		const float DistSq = FVector3f::DistSquared(Positions[Node], Target);
+		if (DistSq < NearestDistSq)
+		{
+			NearestDistSq = DistSq;
+			Nearest = Node;
+		}
+	}
+
+	return Nearest;
+}
+
+bool FArenaTileGraph::FindPath(int32 Start, int32 Goal, TArray<int32>& OutPath) const
+{
+	OutPath.Reset();
+	if (!Positions.IsValidIndex(Start) || !Positions.IsValidIndex(Goal)) { return false; }
+
+	//Scratch is per query so queries can run concurrently
+	TArray<float> Costs;
+	TArray<int32> Parents;
+	Costs.Init(MAX_flt, Positions.Num());
+	Parents.Init(INDEX_NONE, Positions.Num());
+
+	TArray<FOpenNode> Open;
+	Costs[Start] = 0.f;
+	Open.HeapPush(FOpenNode{ FVector3f::Dist(Positions[Start], Positions[Goal]), Start });
+
+	while (!Open.IsEmpty())
+	{
+		FOpenNode Current;
+		Open.HeapPop(Current, false);
+
+		if (Current.Node == Goal) { break; }
+
+		//Stale entry of a node reached again at a lower cost. Edge costs are distances, so the heuristic is consistent.
+		const float CurrentCost = Costs[Current.Node];
+		if (Current.Priority > CurrentCost + FVector3f::Dist(Positions[Current.Node], Positions[Goal]) + KINDA_SMALL_NUMBER) { continue; }
+
+		for (int32 Edge = EdgeOffsets[Current.Node]; Edge < EdgeOffsets[Current.Node + 1]; ++Edge)
+		{
+			const int32 Next = EdgeTargets[Edge];
+			const float NextCost = CurrentCost + EdgeCosts[Edge];
+			if (NextCost >= Costs[Next]) { continue; }
+
+			Costs[Next] = NextCost;
+			Parents[Next] = Current.Node;
+			Open.HeapPush(FOpenNode{ NextCost + FVector3f::Dist(Positions[Next], Positions[Goal]), Next });
+		}
+	}
+
+	if (Costs[Goal] == MAX_flt) { return false; }
+
+	for (int32 Node = Goal; Node != INDEX_NONE; Node = Parents[Node])
+	{
+		OutPath.Add(Node);
+	}
+	Algo::Reverse(OutPath);
+
+	return true;
+}
+
+bool FArenaTileGraph::FindPathBetween(const FVector& From, const FVector& To, TArray<FVector>& OutPoints) const
+{
+	OutPoints.Reset();
+
+	TArray<int32> Path;
+	if (!FindPath(FindNearestNode(From), FindNearestNode(To), Path)) { return false; }
+
+	OutPoints.Reserve(Path.Num());
+	for (const int32 Node : Path)
+	{
+		OutPoints.Add(FVector(Positions[Node]));
+	}
+	return true;
+}
+
+void FArenaTileGraph::BuildFlowField(TConstArrayView<int32> Goals, FArenaFlowField& OutField) const
+{
+	OutField.Distances.Init(MAX_flt, Positions.Num());
+	OutField.NextNodes.Init(INDEX_NONE, Positions.Num());
+
+	TArray<FOpenNode> Open;
+	for (const int32 Goal : Goals)
+	{
+		if (!Positions.IsValidIndex(Goal)) { continue; }
+
+		OutField.Distances[Goal] = 0.f;
+		Open.HeapPush(FOpenNode{ 0.f, Goal });
+	}
+
+	//Edges are symmetric, so expanding from the goals gives every node its distance to the nearest one
+	while (!Open.IsEmpty())
+	{
+		FOpenNode Current;
+		Open.HeapPop(Current, false);
+
+		if (Current.Priority > OutField.Distances[Current.Node]) { continue; }
+
+		for (int32 Edge = EdgeOffsets[Current.Node]; Edge < EdgeOffsets[Current.Node + 1]; ++Edge)
+		{
+			const int32 Previous = EdgeTargets[Edge];
+			const float Distance = Current.Priority + EdgeCosts[Edge];
+			if (Distance >= OutField.Distances[Previous]) { continue; }
+
+			OutField.Distances[Previous] = Distance;
+			OutField.NextNodes[Previous] = Current.Node;
+			Open.HeapPush(FOpenNode{ Distance, Previous });
+		}
+	}
+}
+
+void FArenaTileGraph::Reset()
+{
+	Positions.Reset();
+	Tiles.Reset();
+	EdgeOffsets.Reset();
+	EdgeTargets.Reset();
+	EdgeCosts.Reset();
+}
+
+SIZE_T FArenaTileGraph::GetAllocatedSize() const
+{
+	return Positions.GetAllocatedSize() + Tiles.GetAllocatedSize() + EdgeOffsets.GetAllocatedSize() + EdgeTargets.GetAllocatedSize() + EdgeCosts.GetAllocatedSize();
+}
@@ -0,0 +1,478 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaTileStateTable.h"
+#include "ArenaGeneratorLog.h"
+
+#pragma region Tiles
+
+void FArenaTileStateTable::ResetTiles()
+{
+	PositionX.Reset();
+	PositionY.Reset();
+	PositionZ.Reset();
+	Lattices.Reset();
+
+	for (FColumn& Column : Columns)
+	{
+		Column.Data.Reset();
+		Column.DirtyChunks.Reset();
+	}
+}
+
+void FArenaTileStateTable::AddPlanTiles(const FArenaLayoutPlan& Plan)
+{
+	const int32 FirstTile = Num();
+	const int32 NewNum = FirstTile + Plan.Tiles.Num();
+
+	PositionX.Reserve(NewNum);
+	PositionY.Reserve(NewNum);
+	PositionZ.Reserve(NewNum);
+
+	for (const FArenaPlannedTile& Tile : Plan.Tiles)
+	{
+		const FVector Location = Tile.Transform.GetLocation();
+		PositionX.Add(Location.X);
+		PositionY.Add(Location.Y);
+		PositionZ.Add(Location.Z);
+	}
+
+	for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+	{
+		FPatternLattice& Lattice = Lattices.AddDefaulted_GetRef();
+		Lattice.SectionIdx = Pattern.SectionIdx;
+		Lattice.PatternIdx = Pattern.PatternIdx;
+		Lattice.Slices = FMath::Max(Pattern.Slices, 1);
+		Lattice.Columns = FMath::Max(Pattern.Columns, 1);
+		Lattice.Rows = FMath::Max(Pattern.Rows, 1);
+		Lattice.Tiles.Init(INDEX_NONE, Lattice.Slices * Lattice.Columns * Lattice.Rows);
+
+		for (int32 i = 0; i < Pattern.NumTiles; ++i)
+		{
+			const FArenaTileCoord& Coord = Plan.Tiles[Pattern.FirstTile + i].Coord;
+			const int32 LatticeIdx = (Coord.Slice * Lattice.Columns + Coord.Column) * Lattice.Rows + Coord.Row;
+			if (Lattice.Tiles.IsValidIndex(LatticeIdx)) {
+				Lattice.Tiles[LatticeIdx] = FirstTile + Pattern.FirstTile + i;
+			}
+		}
+	}
+
+	AddDefaultRows(FirstTile);
+}
+
+void FArenaTileStateTable::AddTileLocations(TConstArrayView<FVector> Locations)
+{
+	const int32 FirstTile = Num();
+	const int32 NewNum = FirstTile + Locations.Num();
+
+	PositionX.Reserve(NewNum);
+	PositionY.Reserve(NewNum);
+	PositionZ.Reserve(NewNum);
+
+	for (const FVector& Location : Locations)
+	{
+		PositionX.Add(Location.X);
+		PositionY.Add(Location.Y);
+		PositionZ.Add(Location.Z);
+	}
+
+	AddDefaultRows(FirstTile);
+}
+
+void FArenaTileStateTable::AddDefaultRows(int32 FirstTile)
+{
+	const int32 NewNum = Num();
+
+	for (int32 ColumnIdx = 0; ColumnIdx < Columns.Num(); ++ColumnIdx)
+	{
+		FColumn& Column = Columns[ColumnIdx];
+		Column.Data.Reserve(NewNum * Column.ElementSize);
+		for (int32 Tile = FirstTile; Tile < NewNum; ++Tile)
+		{
+			Column.Data.Append(Column.DefaultValue);
+		}
+
+		//New rows are dirty so clients receive their defaults along with any later change
+		Column.DirtyChunks.SetNum(FMath::DivideAndRoundUp(NewNum, DirtyChunkSize), false);
+		MarkDirty(ColumnIdx, FirstTile, NewNum - FirstTile);
+	}
+}
+
+void FArenaTileStateTable::RemoveTiles(const FArenaTileRange& Range)
+{
+	const int32 FirstTile = FMath::Clamp(Range.FirstTile, 0, Num());
+	const int32 NumTiles = FMath::Clamp(Range.NumTiles, 0, Num() - FirstTile);
+	if (NumTiles == 0) { return; }
+
+	const int32 EndTile = FirstTile + NumTiles;
+
+	PositionX.RemoveAt(FirstTile, NumTiles, false);
+	PositionY.RemoveAt(FirstTile, NumTiles, false);
+	PositionZ.RemoveAt(FirstTile, NumTiles, false);
+
+	//Lattices left without tiles belonged to the removed range
+	for (int32 LatticeIdx = Lattices.Num() - 1; LatticeIdx >= 0; --LatticeIdx)
+	{
+		bool bHasTiles = false;
+		for (int32& Tile : Lattices[LatticeIdx].Tiles)
+		{
+			if (Tile >= EndTile) { Tile -= NumTiles; }
+			else if (Tile >= FirstTile) { Tile = INDEX_NONE; }
+
+			bHasTiles |= Tile != INDEX_NONE;
+		}
+
+		if (!bHasTiles) {
+			Lattices.RemoveAt(LatticeIdx, 1, false);
+		}
+	}
+
+	for (int32 ColumnIdx = 0; ColumnIdx < Columns.Num(); ++ColumnIdx)
+	{
+		FColumn& Column = Columns[ColumnIdx];
+		Column.Data.RemoveAt(FirstTile * Column.ElementSize, NumTiles * Column.ElementSize, false);
+
+		//Rows after the range changed index, clients receive them again
+		Column.DirtyChunks.SetNum(FMath::DivideAndRoundUp(Num(), DirtyChunkSize), false);
+		MarkDirty(ColumnIdx, FirstTile, Num() - FirstTile);
+	}
+}
+
+int32 FArenaTileStateTable::FindTile(int32 SectionIdx, int32 PatternIdx, const FArenaTileCoord& Coord) const
+{
+	const FPatternLattice* Lattice = Lattices.FindByPredicate([SectionIdx, PatternIdx](const FPatternLattice& Candidate)
+	{
+		return Candidate.SectionIdx == SectionIdx && Candidate.PatternIdx == PatternIdx;
+	});
+
+	if (!Lattice
+		|| Coord.Slice < 0 || Coord.Slice >= Lattice->Slices
+		|| Coord.Column < 0 || Coord.Column >= Lattice->Columns
+		|| Coord.Row < 0 || Coord.Row >= Lattice->Rows)
+	{
+		return INDEX_NONE;
+	}
+
+	return Lattice->Tiles[(Coord.Slice * Lattice->Columns + Coord.Column) * Lattice->Rows + Coord.Row];
+}
+
+#pragma endregion
+
+#pragma region Columns
+
+int32 FArenaTileStateTable::RegisterColumnRaw(FName Name, int32 ElementSize, const void* DefaultValue)
+{
+	const int32 Existing = FindColumn(Name);
+	if (Existing != INDEX_NONE)
+	{
+		checkf(Columns[Existing].ElementSize == ElementSize, TEXT("Tile state column %s is already registered with another type"), *Name.ToString());
+		return Existing;
+	}
+
+	FColumn& Column = Columns.AddDefaulted_GetRef();
+	Column.Name = Name;
+	Column.ElementSize = ElementSize;
+	Column.DefaultValue.Append(static_cast<const uint8*>(DefaultValue), ElementSize);
+
+	//Columns registered after the arena was built still get a row per tile
+	Column.Data.Reserve(Num() * ElementSize);
+	for (int32 Tile = 0; Tile < Num(); ++Tile)
+	{
+		Column.Data.Append(Column.DefaultValue);
+	}
+	Column.DirtyChunks.Init(true, FMath::DivideAndRoundUp(Num(), DirtyChunkSize));
+
+	return Columns.Num() - 1;
+}
+
+int32 FArenaTileStateTable::FindColumn(FName Name) const
+{
+	return Columns.IndexOfByPredicate([Name](const FColumn& Column) { return Column.Name == Name; });
+}
+
+FArenaTileStateTable::FColumn& FArenaTileStateTable::GetCheckedColumn(int32 ColumnIdx, int32 ElementSize)
+{
+	checkf(Columns.IsValidIndex(ColumnIdx) && Columns[ColumnIdx].ElementSize == ElementSize, TEXT("Invalid tile state column %d"), ColumnIdx);
+	return Columns[ColumnIdx];
+}
+
+const FArenaTileStateTable::FColumn& FArenaTileStateTable::GetCheckedColumn(int32 ColumnIdx, int32 ElementSize) const
+{
+	checkf(Columns.IsValidIndex(ColumnIdx) && Columns[ColumnIdx].ElementSize == ElementSize, TEXT("Invalid tile state column %d"), ColumnIdx);
+	return Columns[ColumnIdx];
+}
+
+void FArenaTileStateTable::MarkDirty(int32 ColumnIdx, int32 FirstTile, int32 NumTiles)
+{
+	if (NumTiles <= 0) { return; }
+
+	TBitArray<>& DirtyChunks = Columns[ColumnIdx].DirtyChunks;
+	const int32 FirstChunk = FirstTile / DirtyChunkSize;
+	const int32 LastChunk = (FirstTile + NumTiles - 1) / DirtyChunkSize;
+
+	DirtyChunks.SetRange(FirstChunk, LastChunk - FirstChunk + 1, true);
+}
+
+#pragma endregion
+
+#pragma region Queries
+
+template<typename VisitorType>
+void FArenaTileStateTable::ScanRadius(const FVector& Center, float Radius, VisitorType&& Visit) const
+{
+	const int32 NumTiles = Num();
+	const int32 NumBlocks = NumTiles / 4;
+
+	const VectorRegister4Float CenterX = VectorSetFloat1(Center.X);
+	const VectorRegister4Float CenterY = VectorSetFloat1(Center.Y);
+	const VectorRegister4Float CenterZ = VectorSetFloat1(Center.Z);
+	const VectorRegister4Float RadiusSq = VectorSetFloat1(Radius * Radius);
+
+	//Four tiles per iteration, positions are aligned so each axis is a single load
+	for (int32 Block = 0; Block < NumBlocks; ++Block)
+	{
+		const int32 Tile = Block * 4;
+		const VectorRegister4Float DX = VectorSubtract(VectorLoadAligned(&PositionX[Tile]), CenterX);
+		const VectorRegister4Float DY = VectorSubtract(VectorLoadAligned(&PositionY[Tile]), CenterY);
+		const VectorRegister4Float DZ = VectorSubtract(VectorLoadAligned(&PositionZ[Tile]), CenterZ);
+
+		const VectorRegister4Float DistSq = VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX)));
+		const uint32 InsideMask = VectorMaskBits(VectorCompareLE(DistSq, RadiusSq));
+
+		if (InsideMask) {
+			Visit(Tile, InsideMask);
+		}
+	}
+
+	for (int32 Tile = NumBlocks * 4; Tile < NumTiles; ++Tile)
+	{
+		const float DistSq = FMath::Square(PositionX[Tile] - Center.X) + FMath::Square(PositionY[Tile] - Center.Y) + FMath::Square(PositionZ[Tile] - Center.Z);
+		if (DistSq <= Radius * Radius) {
+			Visit(Tile, 1u);
+		}
+	}
+}
+
+void FArenaTileStateTable::QueryRadius(const FVector& Center, float Radius, TArray<int32>& OutTiles) const
+{
+	OutTiles.Reset();
+
+	ScanRadius(Center, Radius, [&OutTiles](int32 Tile, uint32 InsideMask)
+	{
+		for (int32 Lane = 0; InsideMask; ++Lane, InsideMask >>= 1)
+		{
+			if (InsideMask & 1u) {
+				OutTiles.Add(Tile + Lane);
+			}
+		}
+	});
+}
+
+void FArenaTileStateTable::QueryFlags(int32 FlagColumn, uint32 Mask, TArray<int32>& OutTiles) const
+{
+	OutTiles.Reset();
+
+	const TConstArrayView<uint32> Flags = GetColumn<uint32>(FlagColumn);
+	for (int32 Tile = 0; Tile < Flags.Num(); ++Tile)
+	{
+		if ((Flags[Tile] & Mask) == Mask) {
+			OutTiles.Add(Tile);
+		}
+	}
+}
+
+void FArenaTileStateTable::QueryFlagsInRadius(int32 FlagColumn, uint32 Mask, const FVector& Center, float Radius, TArray<int32>& OutTiles) const
+{
+	OutTiles.Reset();
+
+	const TConstArrayView<uint32> Flags = GetColumn<uint32>(FlagColumn);
+	ScanRadius(Center, Radius, [&OutTiles, &Flags, Mask](int32 Tile, uint32 InsideMask)
+	{
+		for (int32 Lane = 0; InsideMask; ++Lane, InsideMask >>= 1)
+		{
+			if ((InsideMask & 1u) && (Flags[Tile + Lane] & Mask) == Mask) {
+				OutTiles.Add(Tile + Lane);
+			}
+		}
+	});
+}
+
+int32 FArenaTileStateTable::SetFlags(int32 FlagColumn, TConstArrayView<int32> Tiles, uint32 Mask, bool bSet)
+{
+	TArrayView<uint32> Flags = GetMutableColumn<uint32>(FlagColumn);
+
+	int32 NumChanged = 0;
+	for (const int32 Tile : Tiles)
+	{
+		const uint32 NewFlags = bSet ? (Flags[Tile] | Mask) : (Flags[Tile] & ~Mask);
+		if (NewFlags != Flags[Tile])
+		{
+			Flags[Tile] = NewFlags;
+			MarkDirty(FlagColumn, Tile, 1);
+			NumChanged++;
+		}
+	}
+
+	return NumChanged;
+}
+
+#pragma endregion
+
+#pragma region Replication
+
+void FArenaTileStateTable::GetDirtyRanges(int32 ColumnIdx, TArray<FArenaTileRange>& OutRanges) const
+{
+	OutRanges.Reset();
+
+	//Consecutive dirty chunks are merged into one range
+	const TBitArray<>& DirtyChunks = Columns[ColumnIdx].DirtyChunks;
+	for (TConstSetBitIterator<> It(DirtyChunks); It; ++It)
+	{
+		const int32 FirstTile = It.GetIndex() * DirtyChunkSize;
+		const int32 NumTiles = FMath::Min(DirtyChunkSize, Num() - FirstTile);
+
+		if (!OutRanges.IsEmpty() && OutRanges.Last().FirstTile + OutRanges.Last().NumTiles == FirstTile) {
+			OutRanges.Last().NumTiles += NumTiles;
+		}
+		else {
+			OutRanges.Add({ FirstTile, NumTiles });
+		}
+	}
+}
+
+void FArenaTileStateTable::MarkAllDirty()
+{
+	for (int32 ColumnIdx = 0; ColumnIdx < Columns.Num(); ++ColumnIdx)
+	{
+		MarkDirty(ColumnIdx, 0, Num());
+	}
+}
+
+void FArenaTileStateTable::ClearDirty()
+{
+	for (FColumn& Column : Columns)
+	{
+		Column.DirtyChunks.SetRange(0, Column.DirtyChunks.Num(), false);
+	}
+}
+
+void FArenaTileStateTable::SerializeDirtyRanges(FArchive& Ar, bool bClearDirty)
+{
+	check(Ar.IsSaving());
+
+	int32 NumTiles = Num();
+	int32 NumColumns = Columns.Num();
+	Ar << NumTiles;
+	Ar << NumColumns;
+
+	TArray<FArenaTileRange> Ranges;
+	for (int32 ColumnIdx = 0; ColumnIdx < Columns.Num(); ++ColumnIdx)
+	{
+		FColumn& Column = Columns[ColumnIdx];
+		GetDirtyRanges(ColumnIdx, Ranges);
+
+		int32 NumRanges = Ranges.Num();
+		Ar << Column.Name;
+		Ar << Column.ElementSize;
+		Ar << NumRanges;
+
+		for (FArenaTileRange& Range : Ranges)
+		{
+			Ar << Range.FirstTile;
+			Ar << Range.NumTiles;
+			Ar.Serialize(Column.Data.GetData() + Range.FirstTile * Column.ElementSize, Range.NumTiles * Column.ElementSize);
+		}
+	}
+
+	if (bClearDirty) {
+		ClearDirty();
+	}
+}
+
+bool FArenaTileStateTable::ApplyDirtyRanges(FArchive& Ar)
+{
+	check(Ar.IsLoading());
+
+	int32 NumTiles = 0;
+	int32 NumColumns = 0;
+	Ar << NumTiles;
+	Ar << NumColumns;
+
+	if (NumTiles != Num() || NumColumns != Columns.Num())
+	{
+		ArenaGenLog_WarningSilent("Tile state ranges are for %d tiles and %d columns, table has %d and %d", NumTiles, NumColumns, Num(), Columns.Num());
+		return false;
+	}
+
+	//Read everything before writing so a mismatch leaves the table untouched
+	struct FPendingRange
+	{
+		int32 ColumnIdx;
+		FArenaTileRange Range;
+		TArray<uint8> Bytes;
+	};
+	TArray<FPendingRange> Pending;
+
+	for (int32 ColumnIdx = 0; ColumnIdx < NumColumns; ++ColumnIdx)
+	{
+		FName Name;
+		int32 ElementSize = 0;
+		int32 NumRanges = 0;
+		Ar << Name;
+		Ar << ElementSize;
+		Ar << NumRanges;
+
+		if (Ar.IsError() || Columns[ColumnIdx].Name != Name || Columns[ColumnIdx].ElementSize != ElementSize)
+		{
+			ArenaGenLog_WarningSilent("Tile state column %s does not match the local table", *Name.ToString());
+			return false;
+		}
+
+		for (int32 RangeIdx = 0; RangeIdx < NumRanges; ++RangeIdx)
+		{
+			FPendingRange& Entry = Pending.AddDefaulted_GetRef();
+			Entry.ColumnIdx = ColumnIdx;
+			Ar << Entry.Range.FirstTile;
+			Ar << Entry.Range.NumTiles;
+
+			if (Ar.IsError() || Entry.Range.FirstTile < 0 || Entry.Range.NumTiles < 0 || Entry.Range.FirstTile + Entry.Range.NumTiles > NumTiles) { return false; }
+
+			Entry.Bytes.SetNumUninitialized(Entry.Range.NumTiles * ElementSize);
+			Ar.Serialize(Entry.Bytes.GetData(), Entry.Bytes.Num());
+		}
+	}
+
+	if (Ar.IsError()) { return false; }
+
+	for (const FPendingRange& Entry : Pending)
+	{
+		FColumn& Column = Columns[Entry.ColumnIdx];
+		FMemory::Memcpy(Column.Data.GetData() + Entry.Range.FirstTile * Column.ElementSize, Entry.Bytes.GetData(), Entry.Bytes.Num());
+	}
+
+	return true;
+}
+
+#pragma endregion
@@ -25,9 +25,21 @@
 
 #include "BaseArenaGenerator.h"
 #include "Math/RandomStream.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include "Algo/Count.h"
+#include "TimerManager.h"
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/StaticMeshActor.h"
+#include "AI/NavigationSystemBase.h"
+#include "NavigationSystem.h"
+#include "ArenaBakedLayoutAsset.h"
+#include "ArenaParameterExplorer.h"
+#include "ArenaOutputSink.h"
+#include "ArenaMassSink.h"
+#include "ArenaMeshMetrics.h"
+#include "ArenaLayoutRaster.h"
 #include "ArenaGeneratorLog.h"
 
 // Sets default values
@@ -40,10 +52,6 @@ ABaseArenaGenerator::ABaseArenaGenerator()
 	
 	ArenaSeed = 1010101;
 	ArenaStream = FRandomStream(ArenaSeed);
-	TotalInstances = 0;
-
-	FocusGridIndex = 0;
-	FocusPolygonIndex = 0;
 	
 }
 
@@ -62,19 +70,48 @@ void ABaseArenaGenerator::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	WipeArena(); //Need to handle components
 }
 
+void ABaseArenaGenerator::PostLoad()
+{
+	Super::PostLoad();
+
+	if (bUseHierarchicalInstances_DEPRECATED)
+	{
+		MeshSinkName = FArenaOutputSinkRegistry::HISMSinkName;
+		bUseHierarchicalInstances_DEPRECATED = false;
+	}
+}
+
 void ABaseArenaGenerator::GenerateArena()
 {
 	//Clear previous arena
 	WipeArena();
 
+	//Game worlds restore baked arenas instead of building them
+	if (bBakeAtCook && GetWorld() && GetWorld()->IsGameWorld())
+	{
+		if (const FArenaBakedLayout* Baked = FindBakedLayout())
+		{
+			ApplyBakedLayout(*Baked);
+			ArenaGenLog_Info("============ Restored baked Arena, # of Instances: %d ============", ActiveArena.TotalInstances);
+			return;
+		}
+
+		ArenaGenLog_Warning("Arena is flagged to bake at cook but has no baked layout. Building sections instead.");
+	}
 
 	ArenaGenLog_Info("============ Generating Arena ============");
 
 	//Build sections from section list
 	BuildSections();
 
+	//Snapped arenas are committed and counted once their ground traces returned
+	if (IsSnappingToGround()) {
+		ArenaGenLog_Info("============ Waiting for ground traces ============");
+		return;
+	}
+
 	//Log number of mesh Instances in arena
-	ArenaGenLog_Info("============ Finished, # of Instances: %d ============", TotalInstances);
+	ArenaGenLog_Info("============ Finished, # of Instances: %d ============", ActiveArena.TotalInstances);
 
 }
 
@@ -82,146 +119,75 @@ void ABaseArenaGenerator::WipeArena()
 {
 	ArenaGenLog_Info("Wiping Arena...");
 	
-	//Clear list of used indices
-	if (!UsedGroupIndices.IsEmpty()) {
-		UsedGroupIndices.Empty();
-	}
-	
-	//Iterate through mesh instances and destroy before dereferencing
-	if (!MeshInstances.IsEmpty())
-	{	
-		for (auto& Inst : MeshInstances)
-		{
-			for (auto& Component : Inst) {
-				if (Component) {
-					Component->DestroyComponent();
-				}
-			}		
-		}
+	//Stop preparing the next arena, it would be built from stale parameters
+	CancelNextArena();
+	ResetStreaming();
+	CancelGroundSnaps();
 
-		MeshInstances.Empty();
-	}
+	//Sinks may own output the generator does not track
+	if (MeshSink.IsValid()) { MeshSink->Clear(*this); }
+	if (ActorSink.IsValid() && ActorSink != MeshSink) { ActorSink->Clear(*this); }
 
-	//Iterate through spawned actors and destroy spawned actors
-	if (!SpawnedActors.IsEmpty()) 
+	DestroyInstanceSet(ActiveArena);
+
+	for (FArenaInstanceSet& Retired : RetiredArenas)
 	{
-		for (AActor* Actor : SpawnedActors)
-		{
-			if (IsValid(Actor)) {
-				Actor->Destroy();
-			}
-		}
+		DestroyInstanceSet(Retired);
+	}
+	RetiredArenas.Empty();
 
-		SpawnedActors.Empty();
+	if (UWorld* World = GetWorld()) {
+		World->GetTimerManager().ClearTimer(ReleaseTimerHandle);
+		World->GetTimerManager().ClearTimer(PhysicsTimerHandle);
 	}
-	
-	TotalInstances = 0;
+
+	//Components waiting for bodies were destroyed with their sets
+	DeferredPhysics.Empty();
+	PhysicsQueue.Empty();
+	PhysicsQueueIdx = 0;
+	PendingNavigationBounds = FBox(ForceInit);
 	
 	//Reset parameters for calculations
-	CurrentBOR = EArenaBuildOrderRules::PolygonLeadByRadius;
-	OriginOffset = FVector(0);
-	PreviousMeshSize = FVector(0);
-	PreviousTilesPerSide = 0;
-	PreviousLastPosition = FVector(0);
-	FocusGridIndex = 0;
-	FocusPolygonIndex = 0;
+	PlannerState = FArenaPlannerState();
+	TileState.ResetTiles();
+	Annotations.Reset();
+	TileGraph.Reset();
+	ActivePlan.Reset();
+	ActiveArenaStream.Reset();
+
+#if WITH_EDITOR
+	//Meshes may have been edited or reimported since they were measured
+	FArenaMeshMetricsCache::Reset();
+#endif
 	
 
 }
 
-void ABaseArenaGenerator::CalculateSectionParameters(FArenaSection& Section)
+FArenaLayoutInputs ABaseArenaGenerator::GatherLayoutInputs() const
 {
-	if (MeshGroups.IsEmpty()) { 
-		ArenaGenLog_Error("Cannot calculate section parameters with empty Mesh Groups!");
-		return;
-	}
-
-	//For all cases, we need these.
-	OriginOffset = FVector(0);
-	ArenaSides = FMath::Clamp(Section.Targets.TargetPolygonSides, 3, MaxSides);
-	InteriorAngle = ((ArenaSides - 2) * 180) / ArenaSides;
-	ExteriorAngle = 360.f / ArenaSides;
-
-	//Determine best starting indices for patterns
-	bool bGrided = false;
-	bool bPolygoned = false;
-
-	for (int32 i = 0; i < Section.BuildRules.Num(); i++) {
-		if (bGrided && bPolygoned) { break; }
-		if (Section.BuildRules[i].SectionType == EArenaSectionType::HorizontalGrid && !bGrided) { FocusGridIndex = Section.BuildRules[i].ObjectGroupId; bGrided = true; }
-		if (Section.BuildRules[i].SectionType == EArenaSectionType::Polygon && !bPolygoned) { FocusPolygonIndex = Section.BuildRules[i].ObjectGroupId; bPolygoned = true; }
-	}
-	CurrentBOR = Section.SectionBuildOrderRules;
-	FVector GridTileSize;
-	FVector PolygonTileSize;
-
-	//CALCULATE SECTION PARAMETERS
-	switch (Section.SectionBuildOrderRules) {
-	case EArenaBuildOrderRules::GridLeadsByDimensions:
-	{
-		//ArenaDimensions determines Inscribed Radius
-		//Floors
-		ArenaDimensions = Section.Targets.TargetGridDimensions;
-		InscribedRadius = (MeshGroups[FocusGridIndex].MeshDimensions.X * (Section.Targets.TargetGridDimensions - 1) * 0.5);
-
-		//Walls
-		SideLength = 2.f * CalculateOpposite(InscribedRadius, InteriorAngle / 2.f);
-		TilesPerArenaSide = FMath::Clamp(FMath::Floor(SideLength / MeshGroups[FocusPolygonIndex].MeshDimensions.X),
-			1, //Min
-			MaxTilesPerSideRow //Max
-		);
-		Apothem = abs(CalculateAdjacent(InscribedRadius, InteriorAngle / 2));
-
-	}break;
-	case EArenaBuildOrderRules::GridLeadsByRadius:
-	{
-		//InscribedRadius determines arenadims w mesh size
-		
-		//Floors
-		ArenaDimensions = (Section.Targets.TargetInscribedRadius / MeshGroups[FocusGridIndex].MeshDimensions.X) > 2 ? FMath::Floor(Section.Targets.TargetInscribedRadius / MeshGroups[FocusGridIndex].MeshDimensions.X) : 2;
-		// was Section.BuildRules[FocusGridIndex].MeshGroupId
-		InscribedRadius = (MeshGroups[FocusGridIndex].MeshDimensions.X * (ArenaDimensions) * 0.5);
-		//was Section.BuildRules[FocusGridIndex].MeshGroupId
-		
-		//Walls
-		SideLength = 2.f * CalculateOpposite(InscribedRadius, InteriorAngle / 2.f);	
-		TilesPerArenaSide = FMath::Clamp(FMath::Floor(SideLength / MeshGroups[FocusPolygonIndex].MeshDimensions.X),
-			1, //Min
-			MaxTilesPerSideRow //Max
-		);
-	
-		Apothem = abs(CalculateAdjacent(InscribedRadius, InteriorAngle / 2));
-
-	}break;
-	case EArenaBuildOrderRules::PolygonLeadByDimensions:
-	{
-		//find inscribed radius from mesh size, desired tps, arena sides.
-
-		TilesPerArenaSide = Section.Targets.TargetTilesPerSide;
-		SideLength = MeshGroups[FocusPolygonIndex].MeshDimensions.X * TilesPerArenaSide;
-
-		InscribedRadius = (SideLength / 2.f) / FMath::Sin(FMath::DegreesToRadians(90.f - InteriorAngle/2)); //Hypotenuse = opposite divided by sine of adjacent angle 
-		Apothem = abs(CalculateAdjacent(InscribedRadius, InteriorAngle / 2));
-
-		ArenaDimensions = FMath::CeilToInt((InscribedRadius * 2.f) / MeshGroups[FocusGridIndex].MeshDimensions.X); //was Section.BuildRules[FocusGridIndex].MeshGroupId
-	}break;
-	case EArenaBuildOrderRules::PolygonLeadByRadius:
-	{
-		//Inscribedradius determines final amount of tiles per side 
-
-		TilesPerArenaSide = FMath::Floor((2.f * CalculateOpposite(Section.Targets.TargetInscribedRadius, InteriorAngle / 2.f)) / MeshGroups[FocusPolygonIndex].MeshDimensions.X); //was Section.BuildRules[FocusPolygonIndex].MeshGroupId
-		SideLength = MeshGroups[FocusPolygonIndex].MeshDimensions.X * TilesPerArenaSide;
-
-		InscribedRadius = (SideLength / 2.f) / FMath::Sin(FMath::DegreesToRadians(90.f - InteriorAngle/2)); //Hypotenuse = opposite/2 divided by sine of adjacent angle
-		Apothem = abs(CalculateAdjacent(InscribedRadius, InteriorAngle / 2));
-
-		ArenaDimensions = FMath::CeilToInt((InscribedRadius * 2.f) / MeshGroups[FocusGridIndex].MeshDimensions.X);
-	}break;
-	}
-
-	//TODO - Final Checks. Determine if Arena dimensions are sufficient for the amount of arena sides. Use rule to determine if we should reduce arena sides, or increase arena dimensions if so.
-	// Polygon is incribed within Grid if 1 >= (meshsize.x / (sin(pi/polygonsides) * grid diagonal))
-	//Likely need recursive function to determine how many sides there can be at most.
+	FArenaLayoutInputs Inputs;
+	Inputs.MeshGroups = MeshGroups;
+	Inputs.ActorGroups = ActorGroups;
+	Inputs.SectionList = SectionList;
+	Inputs.ArenaPlacementOnActor = ArenaPlacementOnActor;
+	Inputs.MaxSides = MaxSides;
+	Inputs.MaxTilesPerSideRow = MaxTilesPerSideRow;
+	Inputs.bRemoveDuplicateTiles = bRemoveDuplicateTiles;
+	Inputs.DuplicateTolerance = DuplicateTolerance;
+	Inputs.bDuplicatesIgnoreYaw = bDuplicatesIgnoreYaw;
+	Inputs.bBuildAnnotations = bBuildAnnotations;
+	Inputs.CoverOffset = CoverOffset;
+	Inputs.PatrolInset = PatrolInset;
+	Inputs.bBuildTileGraph = bBuildTileGraph;
+	Inputs.GraphMaxStepHeight = GraphMaxStepHeight;
+	Inputs.GraphAgentHeight = GraphAgentHeight;
+	Inputs.bGraphDiagonals = bGraphDiagonals;
+	Inputs.GroundSnapMaxAdjust = GroundSnapMaxAdjust;
+
+	//Measured once per mesh, planners only see the resolved values
+	FArenaMeshMetricsCache::ResolveInputs(Inputs);
+
+	return Inputs;
 }
 
 void ABaseArenaGenerator::BuildSections()
@@ -241,694 +207,707 @@ void ABaseArenaGenerator::BuildSections()
 	{
 		ArenaGenLog_Info("Building out %d Sections", SectionList.Num());
 
-		//for every Section...
-		for (int32 i = 0; i < SectionList.Num(); i++)
-		{
-			//Calculate section parameters
-			ArenaGenLog_Info("Building out %d patterns", SectionList[i].BuildRules.Num());
-			CalculateSectionParameters(SectionList[i]);
-			
-			for (int32 j = 0; j < SectionList[i].BuildRules.Num(); j++)
-			{
-				ArenaGenLog_Info("Building SECTION %d : PATTERN %d ", i, j);
-				BuildSection(SectionList[i].BuildRules[j]);
-			}
+		const FArenaLayoutInputs Inputs = GatherLayoutInputs();
+		FArenaLayoutPlanner Planner(Inputs, ArenaStream);
+		ActiveArenaStream = ArenaStream;
 
+		FArenaLayoutPlan Plan;
+		Planner.PlanLayout(Plan);
+		ArenaGenLog_Info("Planned %d patterns, %d tiles, %d duplicates removed", Plan.Patterns.Num(), Plan.Tiles.Num(), Plan.NumDuplicatesRemoved);
+		if (bBuildTileGraph) {
+			ArenaGenLog_Info("Tile graph: %d nodes, %d edges", Plan.TileGraph.NumNodes(), Plan.TileGraph.NumEdges());
 		}
+
+		//Keep drawing from the same stream on the next generation
+		ArenaStream = Planner.GetStream();
+		ApplyPlannerState(Planner.GetState());
+
+		//Committed once the ground traces returned
+		if (StartGroundSnap(Plan, Inputs, EArenaGroundSnapTarget::ActiveArena)) { return; }
+
+		CommitPlan(Plan, ActiveArena);
 	}
 }
 
 void ABaseArenaGenerator::BuildSection(FArenaSectionBuildRules& Section)
 {
-	if(Section.AssetToPlace == ETypeToPlace::StaticMeshes && MeshGroups.IsEmpty())
-	{
-		ArenaGenLog_Error("Cannot build section pattern because associated mesh group is invalid OR mesh groups are empty.");
-		return; 
-	}
-	else if (Section.AssetToPlace == ETypeToPlace::Actors && (ActorGroups.IsEmpty() || ActorGroups[0].ClassesToSpawn.IsEmpty()))
-	{
-		ArenaGenLog_Error("Cannot build section pattern because associated actor group is invalid OR actor groups are empty.");
-		return;
-	}
-
 	if (Section.SectionAmount < 1) { Section.SectionAmount = 1; } //Make sure section amount is not negative or zero
 
-	
-	int GroupIdx = 0;
-	int ReRouteIdx = 0;
-	FVector MeshSize = FVector{ 100 };
-	FVector MeshScale = FVector{ 1 };
-
-	switch (Section.AssetToPlace)
-	{
-		default:
-			ArenaGenLog_Warning("Hit default for Asset To Place. Using Static Mesh as default.");
-		case ETypeToPlace::StaticMeshes:
-		{
-			//Clamp MeshGroup index so that we do not search outside of its bounds
-			GroupIdx = (Section.ObjectGroupId < MeshGroups.Num() && Section.ObjectGroupId > 0) ? Section.ObjectGroupId : 0;
-
-			//Determine arena parameters based off of current origin offsets etc.
-			MeshSize = MeshGroups[GroupIdx].MeshDimensions;
-			MeshScale = MeshGroups[GroupIdx].MeshScale;
-		}break;
-		case ETypeToPlace::Actors:
-		{
-			GroupIdx = (Section.ObjectGroupId < ActorGroups.Num() && Section.ObjectGroupId > 0) ? Section.ObjectGroupId : 0;
-
-			MeshSize = ActorGroups[GroupIdx].ActorDimensions;
-			MeshScale = ActorGroups[GroupIdx].ActorScale;
-		}break;
-	}
-	
-	
-	
-	if (PreviousMeshSize == FVector(0)) { PreviousMeshSize = MeshSize; } 
-	float MeshScalar = PreviousMeshSize.X != 0.f ? MeshSize.X / PreviousMeshSize.X: 1.f;
-	float HeightAdjustment = MeshSize.Z * Section.InitOffsetByHeightScalar;
-	bool bConcavity = Section.bWarpPlacement && Section.WarpConcavityStrength != 0.f;
-
-	//TODO - adjust curr tiles per side to init and per-iteration width offsets
-	int CurrTilesPerSide = MeshScalar == 1.f ? TilesPerArenaSide : //Tiles per Side of the pattern
-		FMath::Clamp(FMath::Floor((2.f * CalculateOpposite(InscribedRadius, InteriorAngle / 2.f)) / MeshSize.X), 1, MaxTilesPerSideRow);
+	//Continue from the parameters and offsets left by the previous pattern
+	const FArenaLayoutInputs Inputs = GatherLayoutInputs();
+	FArenaLayoutPlanner Planner(Inputs, ArenaStream);
+	Planner.SetState(PlannerState);
 
-	if (PreviousTilesPerSide == 0) { PreviousTilesPerSide = TilesPerArenaSide; } // Prev Tiles cannot be zero
+	FArenaLayoutPlan Plan;
+	Planner.PlanPattern(Section, INDEX_NONE, 0, Plan);
 
-	//Update Origin Offset based on Arena placement on actor option and previous parameters
-	
-	switch (ArenaPlacementOnActor) {
-		default:
-		ArenaGenLog_Info("Hit default case on ArenaPlacement! Placing in center.");
-		case EOriginPlacementType::Center:
-		{
-			if (Section.SectionType == EArenaSectionType::HorizontalGrid) {
-				OriginOffset = FVector(
-					(MeshSize.X * (-0.5f * ArenaDimensions) * MeshScale.X),//X
-					(MeshSize.Y * (-0.5f * ArenaDimensions) * MeshScale.Y),//Y
-					OriginOffset.Z);
-			}
-			else if (Section.SectionType == EArenaSectionType::Polygon) {
-				FVector PolygonOffset = (
-					(ForwardVectorFromYaw(InteriorAngle / 2) * InscribedRadius) * FVector(static_cast<float>(CurrTilesPerSide) / (SideLength / MeshSize.X))
-					);
+	//The active arena no longer matches a plan of the section list
+	ActiveArenaStream.Reset();
 
-				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
-				{
-					OriginOffset = FVector(-PolygonOffset.X, -PolygonOffset.Y, OriginOffset.Z); //for Grid BOR
-				}
-				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
-				{
-					OriginOffset = FVector(-(SideLength / 2), -Apothem, OriginOffset.Z);
-				}
-			}
-		}break;
-		case EOriginPlacementType::XY_Positive:
-		{
-			if (Section.SectionType == EArenaSectionType::HorizontalGrid) {
-				OriginOffset = FVector(0, 0, OriginOffset.Z);
-					
-			}
-			else if (Section.SectionType == EArenaSectionType::Polygon) {
+	ArenaStream = Planner.GetStream();
+	ApplyPlannerState(Planner.GetState());
 
-				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
-				{
-					OriginOffset = FVector(((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2))/2
-						, ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2))/2
-						, OriginOffset.Z);
-				}
-				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
-				{
-					OriginOffset = FVector((MeshSize.X * (0.5f * ArenaDimensions) * MeshScale.X) - (SideLength / 2)
-						, ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2
-						, OriginOffset.Z);
-				}
-			}
-		}
-		break;
-		case EOriginPlacementType::X_Positive_Y_Negative:
-		{
-			if (Section.SectionType == EArenaSectionType::HorizontalGrid) {
-				OriginOffset = FVector(
-					0,//X
-					(MeshSize.Y * -ArenaDimensions * MeshScale.Y),//Y
-					OriginOffset.Z);
-			}
-			else if (Section.SectionType == EArenaSectionType::Polygon) {
+	CommitPlan(Plan, ActiveArena);
+}
 
-				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
-				{
-					OriginOffset = FVector(((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2
-						, (-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
-						, OriginOffset.Z);
-				}
-				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
-				{
-					OriginOffset = FVector((MeshSize.X * (0.5f * ArenaDimensions) * MeshScale.X) - (SideLength / 2)
-						, (-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
-						, OriginOffset.Z);
-				}
-			}
-		}break;
-		case EOriginPlacementType::XY_Negative:
-		{
-			if (Section.SectionType == EArenaSectionType::HorizontalGrid) {
-				OriginOffset = FVector(
-					(MeshSize.X * -ArenaDimensions * MeshScale.X),//X
-					(MeshSize.Y * -ArenaDimensions * MeshScale.Y),//Y
-					OriginOffset.Z);
-			}
-			else if (Section.SectionType == EArenaSectionType::Polygon) {
-			
-				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
-				{
-					OriginOffset = FVector((-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
-						, (-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
-						, OriginOffset.Z); //for Grid BOR
-				}
-				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
-				{
-					
-					OriginOffset = FVector(-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * (0.5f * ArenaDimensions) * MeshScale.X) - (SideLength / 2))
-						, (-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2)
-						, OriginOffset.Z);
-				}
-			}
-		}break;
-		case EOriginPlacementType::X_Negative_Y_Positive:
-		{
-			if (Section.SectionType == EArenaSectionType::HorizontalGrid) {
-				OriginOffset = FVector(
-					(MeshSize.X * -ArenaDimensions * MeshScale.X),//X
-					0,//Y
-					OriginOffset.Z);
-			}
-			else if (Section.SectionType == EArenaSectionType::Polygon) {
+void ABaseArenaGenerator::RegenerateArena(int32 NewSeed)
+{
+	ArenaSeed = NewSeed;
+	ArenaStream = FRandomStream(ArenaSeed);
 
-				if (CurrentBOR == EArenaBuildOrderRules::GridLeadsByDimensions || CurrentBOR == EArenaBuildOrderRules::GridLeadsByRadius)
-				{
-					OriginOffset = FVector(-Apothem - (SideLength / 2) - (MeshSize.X * 3) / 4
-						, ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2
-						, OriginOffset.Z);
-				}
-				else if (CurrentBOR == EArenaBuildOrderRules::PolygonLeadByDimensions || CurrentBOR == EArenaBuildOrderRules::PolygonLeadByRadius)
-				{
-					OriginOffset = FVector(-(MeshSize.X * ArenaDimensions * MeshScale.X) + ((MeshSize.X * (0.5f * ArenaDimensions) * MeshScale.X) - (SideLength / 2))
-						, ((MeshSize.X * ArenaDimensions * MeshScale.X) - (Apothem * 2)) / 2
-						, OriginOffset.Z);
-				}
-			}
-		}break;
-		
-	}
-	
-	//Update rotation parameters
-	float RotationIncr = 360.f / Section.YawPossibilities;
-	int YawPosMax = FMath::Clamp(Section.YawPossibilities-1, 2, 720);
-	
-	//Mesh Instancing, get mesh group
-	if (Section.AssetToPlace == ETypeToPlace::StaticMeshes)
+	//Nothing to reuse, build it normally. Output of other sinks than ISM, HISM and actors is not tracked by the set, so it cannot be updated in place either.
+	if (ActiveArena.IsEmpty() || !CanUpdateActiveArenaInPlace())
 	{
-		if (!UsedGroupIndices.Contains(GroupIdx))
-		{
-			UsedGroupIndices.Add(GroupIdx);
-
-			TArray<UInstancedStaticMeshComponent*> ToInstance;
-
-			for (FArenaMesh& ArenaMesh : MeshGroups[GroupIdx].GroupMeshes)
-			{
-				if (ArenaMesh.Mesh)
-				{
-					UInstancedStaticMeshComponent* InstancedMesh =
-						NewObject<UInstancedStaticMeshComponent>(this, UInstancedStaticMeshComponent::StaticClass());
-
-					InstancedMesh->SetStaticMesh(ArenaMesh.Mesh);
-					InstancedMesh->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
-					InstancedMesh->RegisterComponent();
-			
-					ToInstance.Add(InstancedMesh);
-				}
-			
-			}
-
-			//add tarray of instances to mesh instances
-			MeshInstances.Add(ToInstance);
-			ReRouteIdx = UsedGroupIndices.Find(GroupIdx);		//Using reroute index allows us to add mesh groups out of order to the mesh instances
-			ArenaGenLog_Info("Adding the Mesh Group %d to Mesh Instances at index: %d ", GroupIdx, ReRouteIdx);
-		}
-		else 
-		{
-			ReRouteIdx = UsedGroupIndices.Find(GroupIdx);
-			ArenaGenLog_Info("Index: %d is already instanced, ignoring request", GroupIdx);
-		}
+		GenerateArena();
+		return;
 	}
-	
-	//Build Section
-	switch (Section.SectionType) {
-		case EArenaSectionType::Polygon:
-		{
-			FVector LastCachedPosition{ 0 };
-			FVector SideAngleFV{ 0 };
 
-			for (int SideIdx = 0; SideIdx < ArenaSides; ++SideIdx) //ArenaSides
-			{
-				//Cache last used position to update through next loop
-				LastCachedPosition = LastCachedPosition + ((SideAngleFV * MeshSize.X));
-
-				//Determine forward vector for placement
-				SideAngleFV = ForwardVectorFromYaw(ExteriorAngle * SideIdx);
-
-				//Cache Yaw rotation for the side
-				float YawRotation = (360.f / ArenaSides) * SideIdx;
+	if (MeshGroups.IsEmpty() && ActorGroups.IsEmpty()) {
+		ArenaGenLog_Error("Cannot regenerate arena with empty Mesh & Actor Groups!");
+		return;
+	}
 
-				//Determine right vector for placement offsets
-				FVector SideAngleRV = FRotationMatrix(FRotator(0, YawRotation, 0)).GetScaledAxis(EAxis::Y);
+	//A prepared arena was planned from the previous parameters
+	CancelNextArena();
 
-				for (int LenIdx = 0; LenIdx < CurrTilesPerSide; ++LenIdx) //CurrTilesPerSide
-				{
-					LastCachedPosition = (SideAngleFV * MeshSize.X * (LenIdx > 0 ? 1 : 0)) + LastCachedPosition;
+	const FArenaLayoutInputs Inputs = GatherLayoutInputs();
+	FArenaLayoutPlanner Planner(Inputs, ArenaStream);
+	ActiveArenaStream = ArenaStream;
 
-					for (int HeightIdx = 0; HeightIdx < Section.SectionAmount; ++HeightIdx)
-					{
-						//TODO - determine meshIdx
-						int MeshIdx = 0;
-
-						//Cache value for rotational mesh offsets
-						int RandomVal{ 0 };
-
-						switch (Section.RotationRule) {
-						case EPlacementOrientationRule::RotateByYP:
-							RandomVal = ArenaStream.RandRange(0, YawPosMax);
-							//YawRotation = YawRotation + (RotationIncr * RandomVal);
-							break;
-						case EPlacementOrientationRule::RotateYawRandomly:
-							YawRotation = ArenaStream.FRandRange(0, 360.f);
-							break;
-						}
+	FArenaLayoutPlan Plan;
+	Planner.PlanLayout(Plan);
 
-						FVector RotationOffsetAdjustment = FVector(0);
+	ArenaStream = Planner.GetStream();
+	ApplyPlannerState(Planner.GetState());
 
-						//We rotate the mesh around its assumed center and reposition it by its half size after the calculation.
-						if (Section.AssetToPlace == ETypeToPlace::StaticMeshes)
-						{
-							RotationOffsetAdjustment = OffsetMeshToCenter(MeshGroups[GroupIdx].GroupMeshes[MeshIdx].OriginType, MeshSize, Section.DefaultRotation.Yaw + YawRotation + (RotationIncr * RandomVal))
-							- (OriginOffsetScalar(MeshGroups[GroupIdx].GroupMeshes[MeshIdx].OriginType) * MeshSize) //Offset back to lead position
-							+ SideAngleFV * (FVector(0.5, 0.5, 0) * MeshSize.X);
-						}
-						
-
-						FTransform TileTransform = FTransform(
-						//ROTATION
-							FRotator(
-							Section.DefaultRotation.Pitch  //Pitch
-							, Section.DefaultRotation.Yaw + YawRotation + (RotationIncr * RandomVal) //Yaw
-							, Section.DefaultRotation.Roll), //Roll
-						
-						//LOCATION
-							LastCachedPosition // Iterate on position...
-							+ OriginOffset // Offset by the origin of our section 
-							+ FVector(0, 0, (MeshSize.Z * (HeightIdx * Section.OffsetByHeightIncrement)) + HeightAdjustment) // Height Adjustment
-							+ (SideAngleRV * MeshSize.Y * Section.InitOffsetByWidthScalar) // Initial width offset
-							+ (SideAngleRV * MeshSize.Y * Section.OffsetByWidthIncrement * HeightIdx) // Offset by width each height increment
-							+ RotationOffsetAdjustment // Adjust by offset caused by rotation and mesh origin type
-							+ (bConcavity ? PlacementWarpingConcavity(CurrTilesPerSide / 2, CurrTilesPerSide / 2, LenIdx, HeightIdx, Section.WarpConcavityStrength, SideAngleRV) : FVector(0.f)) // Concavity
-							+ (Section.bWarpPlacement ? PlacementWarpingDirectional(Section.WarpRange, SideAngleFV, SideAngleRV) : FVector(0)) //Warping along placement
-							
-						//SCALE
-						, FVector( MeshScale.X, MeshScale.Y, MeshScale.Z));
-
-
-						switch (Section.AssetToPlace) {
-							default:
-							case ETypeToPlace::StaticMeshes:
-							{
-								//Instancing mesh
-								if (MeshInstances[ReRouteIdx][MeshIdx]) {
-									MeshInstances[ReRouteIdx][MeshIdx]->AddInstance(TileTransform);
-									TotalInstances++;
-								}
-								else {
-									ArenaGenLog_Error("Could not find Mesh Instance of group: %d at index: %d", GroupIdx, MeshIdx);
-								}
-							}break;
-
-							case ETypeToPlace::Actors:
-							{
-								FActorSpawnParameters SpawnParams = FActorSpawnParameters();
-								SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-								SpawnParams.Owner = this;
-
-								FTransform ActorTransform;
-
-								AActor* ActorToSpawn = Cast<AActor>(GetWorld()->SpawnActor(ActorGroups[0].ClassesToSpawn[0], &ActorTransform, SpawnParams));
-								ActorToSpawn->AttachToActor(this, FAttachmentTransformRules::KeepRelativeTransform);
-
-								ActorToSpawn->SetActorRelativeTransform(TileTransform, false);
-
-								SpawnedActors.Add(ActorToSpawn);
-								
-							}break;
-						}
+	if (StartGroundSnap(Plan, Inputs, EArenaGroundSnapTarget::ActiveArena, true)) { return; }
 
-						
+	UpdateActiveArena(Plan);
 
-					}
-				}
-			}
+	ArenaGenLog_Info("============ Regenerated Arena with seed %d, # of Instances: %d ============", ArenaSeed, ActiveArena.TotalInstances);
+}
 
-			//Cache values before scope ends
-			PreviousTilesPerSide = CurrTilesPerSide;
-			PreviousLastPosition = LastCachedPosition;
+bool ABaseArenaGenerator::CarveArena(int32 SectionIdx, const FArenaCarveVolume& Volume)
+{
+	if (!SectionList.IsValidIndex(SectionIdx)) {
+		ArenaGenLog_Error("Cannot carve section %d, the section list has %d sections.", SectionIdx, SectionList.Num());
+		return false;
+	}
 
-			if (Section.bUpdatesOriginOffsetHeight) {
-				OriginOffset = FVector(OriginOffset.X, OriginOffset.Y, OriginOffset.Z + (MeshSize.Z * Section.SectionAmount * Section.OffsetByHeightIncrement)); // Update OriginOffset by height of mesh and scalar of height increment
-			}
-		}
-		break;
+	//Kept on the section so the opening is planned by every following generation
+	SectionList[SectionIdx].CarveVolumes.Add(Volume);
 
-		case EArenaSectionType::HorizontalGrid:
-		{
-			//Cache midpoint index
-			int Midpoint = FMath::Floor(ArenaDimensions / 2);
+	if (!ActiveArenaStream.IsSet() || ActiveArena.IsEmpty())
+	{
+		ArenaGenLog_Info("Carve volume added to section %d, it applies from the next generation.", SectionIdx);
+		return false;
+	}
 
-			int SectionDimensions = (MeshSize.X == PreviousMeshSize.X) ? ArenaDimensions :
-				FMath::Floor((2.f * SideLength) / MeshSize.X);
+	//A prepared arena was planned without the volume
+	CancelNextArena();
 
-			FVector PlacementFV = FVector(1.f, 0.f, 0.f); //ForwardVectorFromYaw(Section.DefaultRotation.Yaw);
-			FVector PlacementRV = FVector(0.f, 1.f, 0.f);//FRotationMatrix(FRotator(0, Section.DefaultRotation.Yaw, 0)).GetScaledAxis(EAxis::Y);
+	//Output the set does not track cannot be moved, rebuild from the stream the active arena was planned with
+	if (!CanUpdateActiveArenaInPlace())
+	{
+		ArenaStream = ActiveArenaStream.GetValue();
+		GenerateArena();
+		return true;
+	}
 
-			for (int TimesIdx = 0; TimesIdx < Section.SectionAmount; TimesIdx++) {
-				for (int Row = 0; Row < SectionDimensions; Row++) {
-					for (int Col = 0; Col < SectionDimensions; Col++) {
+	//Carved tiles draw from the stream like planned ones, so replanning only loses the carved tiles
+	const FArenaLayoutInputs Inputs = GatherLayoutInputs();
+	FArenaLayoutPlanner Planner(Inputs, ActiveArenaStream.GetValue());
 
-						//TODO - determine meshIdx
-						int MeshIdx = 0;
+	FArenaLayoutPlan Plan;
+	Planner.PlanLayout(Plan);
+	ApplyPlannerState(Planner.GetState());
 
-						//Rotation values
-						int RandomVal=0;
-						FVector RotationOffsetAdjustment{ 0 };
-						float YawRotation{ 0.f };
+	int32 NumCarved = 0;
+	for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+	{
+		NumCarved += Pattern.NumCarvedTiles;
+	}
 
-						switch (Section.RotationRule) {
-							
-							case EPlacementOrientationRule::RotateByYP:
-							{
-								RandomVal = ArenaStream.RandRange(0, YawPosMax);
-							}break;
-							case EPlacementOrientationRule::RotateYawRandomly:
-							{
-								YawRotation = ArenaStream.FRandRange(0, 360.f);
-							}break;
+	if (StartGroundSnap(Plan, Inputs, EArenaGroundSnapTarget::ActiveArena, true))
+	{
+		ArenaGenLog_Info("Carved section %d, %d tiles carved in total", SectionIdx, NumCarved);
+		return true;
+	}
 
-							
-						}
-						
-						RotationOffsetAdjustment = //OffsetMeshAlongDirections(PlacementFV, PlacementRV, MeshGroups[GroupIdx].GroupMeshes[MeshIdx].OriginType, MeshSize, RandomVal);
-									//RotatedMeshOffset(MeshGroups[GroupIdx].GroupMeshes[MeshIdx].OriginType, MeshSize, RandomVal);
-							OffsetMeshToCenter(MeshGroups[GroupIdx].GroupMeshes[MeshIdx].OriginType, MeshSize, Section.DefaultRotation.Yaw + YawRotation + (RotationIncr * RandomVal))
-							- (OriginOffsetScalar(MeshGroups[GroupIdx].GroupMeshes[MeshIdx].OriginType) * MeshSize) //Offset back to lead position
-							+ (FVector(0.5, 0.5, 0) * MeshSize.X);
-
-						//Transform
-						FTransform TileTransform = FTransform(
-							//ROTATION
-							FRotator(
-								Section.DefaultRotation.Pitch  //Pitch
-								, YawRotation + (RotationIncr * RandomVal) //+ Section.DefaultRotation.Yaw //Yaw
-								, Section.DefaultRotation.Roll //Roll
-							),
-							//LOCATION
-							OriginOffset //Cached Origin offset
-							+ FVector(0, 0, (MeshSize.Z * TimesIdx) + HeightAdjustment) //Height Offset for section amount and initial height adjustment
-							+ (PlacementFV * MeshSize.X * MeshScale.X * Row) // Relative X placement
-							+ (PlacementRV * MeshSize.Y * MeshScale.Y * Col) // Relative Y Placement
-							+ RotationOffsetAdjustment //Offset from rotation by OriginType
-							+ (Section.bWarpPlacement ? PlacementWarpingDirectional(Section.WarpRange, FVector(1, 0, 0), FVector(0, 1, 0)) : FVector(0)) //Warping along placement
-							+ (bConcavity ? PlacementWarpingConcavity(CurrTilesPerSide / 2, CurrTilesPerSide / 2, Row, Col, Section.WarpConcavityStrength, FVector(0.f, 0.f, 1.f)) : FVector(0.f))
-
-							//SCALE
-							, MeshScale
-						);
-
-						switch (Section.AssetToPlace) {
-						default:
-						case ETypeToPlace::StaticMeshes:
-						{
-							//Instancing mesh
-							if (MeshInstances[ReRouteIdx][MeshIdx]) {
-								MeshInstances[ReRouteIdx][MeshIdx]->AddInstance(TileTransform);
-								TotalInstances++;
-							}
-							else {
-								ArenaGenLog_Error("Could not find Mesh Instance of group: %d at index: %d", GroupIdx, MeshIdx);
-							}
-						}break;
-
-						case ETypeToPlace::Actors:
-						{
-							FActorSpawnParameters SpawnParams = FActorSpawnParameters();
-							SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-							SpawnParams.Owner = this;
+	UpdateActiveArena(Plan);
 
-							AActor* ActorToSpawn = Cast<AActor>(GetWorld()->SpawnActor(ActorGroups[0].ClassesToSpawn[0], &TileTransform, SpawnParams));
+	ArenaGenLog_Info("Carved section %d, %d tiles carved in total, # of Instances: %d", SectionIdx, NumCarved, ActiveArena.TotalInstances);
+	return true;
+}
 
-							SpawnedActors.Add(ActorToSpawn);
+void ABaseArenaGenerator::UpdateActiveArena(const FArenaLayoutPlan& Plan)
+{
+	//Instances are moved one by one, so navigation ignores the arena until they all moved
+	FBox NavigationBounds(ForceInit);
+	if (bBatchNavigationUpdates)
+	{
+		NavigationBounds = GetInstanceSetBounds(ActiveArena);
+		SetInstanceSetAffectsNavigation(ActiveArena, false);
+	}
 
-						}break;
-						}
-					}
-				}
-			}
+	UpdateInstanceSet(Plan, ActiveArena);
+	QueueInstanceSetPhysics(ActiveArena);
 
-			if (Section.bUpdatesOriginOffsetHeight) {
-				OriginOffset = FVector(OriginOffset.X, OriginOffset.Y, OriginOffset.Z + (MeshSize.Z * Section.SectionAmount * Section.OffsetByHeightIncrement)); // Update OriginOffset by height of mesh times scalar of height increment
-			}
-		}
-		break;
+	if (bBatchNavigationUpdates)
+	{
+		SetInstanceSetAffectsNavigation(ActiveArena, true);
+		SubmitNavigationUpdate(NavigationBounds + GetInstanceSetBounds(ActiveArena));
 	}
 
-	//Cache values for next section
-	PreviousMeshSize = MeshSize;
+	//Rows follow the new plan, state of the previous layout does not carry over
+	TileState.ResetTiles();
+	TileState.AddPlanTiles(Plan);
+	Annotations = Plan.Annotations;
+	SetTileGraph(Plan.TileGraph);
+	SetActivePlan(Plan, false);
 }
 
+void ABaseArenaGenerator::PlanLayoutsForSeeds(const TArray<int32>& Seeds, TArray<FArenaBakedLayout>& OutLayouts) const
+{
+	const FArenaLayoutInputs Inputs = GatherLayoutInputs();
 
-#pragma region Utility
+	TArray<FArenaLayoutPlan> Plans;
+	FArenaLayoutPlanner::PlanLayoutsForSeeds(Inputs, Seeds, Plans);
 
-float ABaseArenaGenerator::CalculateOpposite(float length, float angle)
-{
-	return (length * FMath::Cos(FMath::DegreesToRadians(angle)));
+	OutLayouts.SetNum(Plans.Num());
+	ParallelFor(Plans.Num(), [&Plans, &Inputs, &OutLayouts](int32 Idx)
+	{
+		OutLayouts[Idx] = FArenaLayoutPlanner::BakePlan(Plans[Idx], Inputs);
+	});
 }
 
-float ABaseArenaGenerator::CalculateAdjacent(float length, float angle)
+void ABaseArenaGenerator::ExploreArenaVariants(const FArenaParameterSweep& Sweep, TArray<FArenaVariant>& OutVariants) const
 {
-	return (length * FMath::Sin(FMath::DegreesToRadians(angle)));
+	FArenaParameterExplorer::Explore(GatherLayoutInputs(), Sweep, OutVariants);
 }
 
-FVector ABaseArenaGenerator::ForwardVectorFromYaw(float yaw)
+void ABaseArenaGenerator::SortArenaVariants(TArray<FArenaVariant>& Variants, EArenaVariantSort SortBy, bool bDescending)
 {
-	float YawRad = FMath::DegreesToRadians(yaw);
-	
-	return FVector(FMath::Cos(YawRad),
-		FMath::Sin(YawRad),
-	0.f);
+	FArenaParameterExplorer::SortVariants(Variants, SortBy, bDescending);
 }
 
-FVector ABaseArenaGenerator::RotatedMeshOffset(EOriginPlacementType OriginType, FVector& MeshSize, int RotationIndex)
+void ABaseArenaGenerator::CommitPlan(const FArenaLayoutPlan& Plan, FArenaInstanceSet& Target)
 {
-	float X1 = 0;
-	float Y1 = 0;
+	FArenaCommitQueue Queue;
+	QueueCommit(Plan, Target, Queue);
+	ProcessCommitQueue(Queue, Target, MAX_int32, MAX_int32);
 
-	switch (OriginType) {
-	case(EOriginPlacementType::XY_Positive):
-		if (RotationIndex == 1) {
-			X1 = MeshSize.X;
-		}
-		else if (RotationIndex == 2) {
-			X1 = MeshSize.X; Y1 = MeshSize.Y;
-		}
-		else if (RotationIndex == 3) {
-			Y1 = MeshSize.Y;
-		}
-		break;
-
-	case(EOriginPlacementType::XY_Negative):
-		if (RotationIndex == 0) {
-			X1 = MeshSize.X; Y1 = MeshSize.Y;
-		}
-		else if (RotationIndex == 1) {
-			Y1 = MeshSize.Y;
-		}
-		else if (RotationIndex == 3) {
-			X1 = MeshSize.X;
-		}
-		break;
+	QueueInstanceSetPhysics(Target);
 
-	case(EOriginPlacementType::X_Positive_Y_Negative):
-		if (RotationIndex == 0) {
-			Y1 = MeshSize.Y;
-		}
-		else if (RotationIndex == 2) {
-			X1 = MeshSize.X; 
-		}
-		else if (RotationIndex == 3) {
-			X1 = MeshSize.X; Y1 = MeshSize.Y;
-		}
-		break;
+	if (&Target == &ActiveArena)
+	{
+		TileState.AddPlanTiles(Plan);
+		Annotations = Plan.Annotations;
+		SetTileGraph(Plan.TileGraph);
+		SetActivePlan(Plan, true);
 
-	case(EOriginPlacementType::X_Negative_Y_Positive):
-		if (RotationIndex == 0) {
-			X1 = MeshSize.X;
-		}
-		else if (RotationIndex == 1) {
-			X1 = MeshSize.X; Y1 = MeshSize.Y;
-		}
-		else if (RotationIndex == 2) {
-			Y1 = MeshSize.Y;
+		if (bBatchNavigationUpdates)
+		{
+			SetInstanceSetAffectsNavigation(ActiveArena, true);
+			SubmitNavigationUpdate(GetInstanceSetBounds(ActiveArena));
 		}
-		break;
-
-	case(EOriginPlacementType::Center):
-		return FVector(0);
-		break;
 	}
-
-	return FVector(X1, Y1, 0);
 }
 
-FVector ABaseArenaGenerator::OffsetMeshAlongDirections(const FVector& FV, const FVector& RV, EOriginPlacementType OriginType, const FVector& MeshSize, int RotationIndex)
+void ABaseArenaGenerator::QueueCommit(const FArenaLayoutPlan& Plan, FArenaInstanceSet& Target, FArenaCommitQueue& OutQueue)
 {
-	FVector Span;
+	FArenaSinkContext Context{ *this, Target, OutQueue };
 
-	switch (OriginType) {
-	case(EOriginPlacementType::XY_Positive):
-		if (RotationIndex == 1) {
-			Span = FV * MeshSize.X;
-		}
-		else if (RotationIndex == 2) {
-			Span = FV * MeshSize.X + RV * MeshSize.Y;
-		}
-		else if (RotationIndex == 3) {
-			Span = RV * MeshSize.Y;
-		}
-		break;
+	IArenaOutputSink* Sinks[] = { GetOutputSink(ETypeToPlace::StaticMeshes), GetOutputSink(ETypeToPlace::Actors) };
+	const int32 NumSinks = Sinks[0] == Sinks[1] ? 1 : 2;
 
-	case(EOriginPlacementType::XY_Negative):
-		if (RotationIndex == 0) {
-			Span = FV * MeshSize.X + RV * MeshSize.Y;
-		}
-		else if (RotationIndex == 1) {
-			Span = RV * MeshSize.Y;
-		}
-		else if (RotationIndex == 3) {
-			Span = FV * MeshSize.X;
-		}
-		break;
+	for (int32 i = 0; i < NumSinks; ++i)
+	{
+		if (Sinks[i]) { Sinks[i]->BeginCommit(Context, Plan); }
+	}
 
-	case(EOriginPlacementType::X_Positive_Y_Negative):
-		if (RotationIndex == 0) {
-			Span = RV * MeshSize.Y;
-		}
-		else if (RotationIndex == 2) {
-			Span = FV * MeshSize.X;
-		}
-		else if (RotationIndex == 3) {
-			Span = FV * MeshSize.X + RV * MeshSize.Y;
-		}
-		break;
+	for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+	{
+		if (IArenaOutputSink* Sink = GetOutputSink(Pattern.AssetToPlace))
+		{
+			Sink->CommitTiles(Context, Pattern, Plan.GetPatternTiles(Pattern));
 
-	case(EOriginPlacementType::X_Negative_Y_Positive):
-		if (RotationIndex == 0) {
-			Span = FV * MeshSize.X;
-		}
-		else if (RotationIndex == 1) {
-			Span = FV * MeshSize.X + RV * MeshSize.Y;
-		}
-		else if (RotationIndex == 2) {
-			Span = RV * MeshSize.Y;
+			if (Pattern.NumSubTiles > 0) {
+				Sink->CommitSubTiles(Context, Pattern, Plan.GetPatternSubTiles(Pattern));
+			}
 		}
-		break;
+	}
 
-	case(EOriginPlacementType::Center):
-		return FVector(0);
-		break;
+	for (int32 i = 0; i < NumSinks; ++i)
+	{
+		if (Sinks[i]) { Sinks[i]->EndCommit(Context); }
 	}
-	return Span;
 }
 
-FVector ABaseArenaGenerator::OriginOffsetScalar(EOriginPlacementType OriginType)
+void ABaseArenaGenerator::UpdateInstanceSet(const FArenaLayoutPlan& Plan, FArenaInstanceSet& Target)
 {
-	switch (OriginType) {
-	case(EOriginPlacementType::XY_Positive):
-		return FVector(0.5, 0.5, 0);
-		break;
-	case(EOriginPlacementType::XY_Negative):
-		return FVector(-0.5, -0.5, 0);
-		break;
-	case(EOriginPlacementType::X_Positive_Y_Negative):
-		return FVector(0.5, -0.5, 0);
-		break;
-	case(EOriginPlacementType::X_Negative_Y_Positive):
-		return FVector(-0.5, 0.5, 0); 
-		break;
-	case(EOriginPlacementType::Center):
-		return FVector(0);
-		break;
+	//Every existing component is listed so the ones the plan no longer uses get emptied
+	TMap<UInstancedStaticMeshComponent*, TArray<FTransform>> ComponentTransforms;
+	for (const auto& Inst : Target.MeshInstances)
+	{
+		for (UInstancedStaticMeshComponent* Component : Inst) {
+			if (Component) {
+				ComponentTransforms.Add(Component);
+			}
+		}
 	}
 
-	return FVector(0);
-}
-
-FVector ABaseArenaGenerator::PlacementWarpingConcavity(int ColMidpoint, int RowMidpoint, int Col, int Row, float ConcavityStrength, FVector WarpDirection)
-{
-	float ConcaveWarp = ConcavityStrength *
-		(FMath::Clamp((FMath::Lerp(0.f, 1.f, FMath::Clamp((static_cast<float>(abs(Col - ColMidpoint)) / RowMidpoint), 0.f, 1.f)) *
-		FMath::Lerp(0.f, 1.f, FMath::Clamp((static_cast<float>(abs(Row - RowMidpoint)) / RowMidpoint), 0.f, 1.f))), 0.f, 1.f));
+	TMap<UClass*, TArray<FTransform>> ActorTransforms;
 
-	return  (WarpDirection * ConcaveWarp); 
+	for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+	{
+		TArrayView<const FArenaPlannedTile> Tiles = Plan.GetPatternTiles(Pattern);
 
-}
+		switch (Pattern.AssetToPlace) {
+			default:
+			case ETypeToPlace::StaticMeshes:
+			{
+				const int32 ReRouteIdx = FindOrCreateGroupInstances(Target, Pattern.GroupIdx);
+				TArray<UInstancedStaticMeshComponent*>& Components = Target.MeshInstances[ReRouteIdx];
 
-FVector ABaseArenaGenerator::PlacementWarpingDirectional(FVector OffsetRanges, const FVector& DirFV, const FVector& DirRV)
-{
+				//Baked layouts only restore components of meshes that had instances
+				TArray<UStaticMesh*> ComponentMeshes;
+				MeshGroups[Pattern.GroupIdx].GetComponentMeshes(ComponentMeshes);
 
-	return (ArenaStream.FRandRange(OffsetRanges.X * -1, OffsetRanges.X) * DirFV)
-		+ (ArenaStream.FRandRange(OffsetRanges.Y * -1, OffsetRanges.Y) * DirRV)
-		+ FVector(0,0, ArenaStream.FRandRange(OffsetRanges.Z * -1, OffsetRanges.Z));// FVector();
-}
+				for (TArrayView<const FArenaPlannedTile> Instances : { Tiles, Plan.GetPatternSubTiles(Pattern) })
+				{
+					for (const FArenaPlannedTile& Tile : Instances)
+					{
+						if (!ComponentMeshes.IsValidIndex(Tile.MeshIdx) || !ComponentMeshes[Tile.MeshIdx]) { continue; }
+						if (!Components.IsValidIndex(Tile.MeshIdx)) {
+							Components.SetNum(ComponentMeshes.Num());
+						}
 
-FVector ABaseArenaGenerator::OffsetMeshToCenter(EOriginPlacementType OriginType, const FVector& MeshSize, float angle)
-{
-	if (OriginType == EOriginPlacementType::Center) { return FVector(0); } //early return if origin type is zero
+						UInstancedStaticMeshComponent*& Component = Components[Tile.MeshIdx];
+						if (!Component) {
+							Component = CreateInstancedMeshComponent(ComponentMeshes[Tile.MeshIdx], Target.bHidden, Target.ComponentClass);
+						}
 
-	float AngleRad = FMath::DegreesToRadians(angle);
-	float cosTheta = FMath::Cos(AngleRad);
-	float sinTheta = FMath::Sin(AngleRad);
-	FVector InitialCenter = OriginOffsetScalar(OriginType) * MeshSize; //determines the offset direction for calculation based on origin type
+						ComponentTransforms.FindOrAdd(Component).Add(Tile.Transform);
+					}
+				}
+			}break;
 
-	FVector RotatedCenter = FVector(((InitialCenter.X * cosTheta) - (InitialCenter.Y * sinTheta)), ((InitialCenter.X * sinTheta) + (InitialCenter.Y * cosTheta)), 0);
+			case ETypeToPlace::Actors:
+			{
+				if (!ActorGroups.IsValidIndex(Pattern.GroupIdx)) { break; }
+				const TArray<TSubclassOf<AActor>>& Classes = ActorGroups[Pattern.GroupIdx].ClassesToSpawn;
 
-	return InitialCenter - RotatedCenter;
-}
+				for (const FArenaPlannedTile& Tile : Tiles)
+				{
+					if (Classes.IsValidIndex(Tile.MeshIdx) && Classes[Tile.MeshIdx]) {
+						ActorTransforms.FindOrAdd(Classes[Tile.MeshIdx]).Add(Tile.Transform);
+					}
+				}
+			}break;
+		}
+	}
 
+	int32 Reused = 0;
+	int32 Added = 0;
+	int32 Removed = 0;
+	Target.TotalInstances = 0;
 
-void ABaseArenaGenerator::ConvertToStaticMeshActors()
-{
+	TArray<FTransform> Slice;
+	TArray<int32> ToRemove;
 
-	if (!MeshInstances.IsEmpty())
+	for (TPair<UInstancedStaticMeshComponent*, TArray<FTransform>>& Pair : ComponentTransforms)
 	{
-		for (auto& Inst : MeshInstances)
-		{
-			for (auto& Component : Inst) {
-				if (!Component || Component->GetStaticMesh() == nullptr) { continue; }
+		UInstancedStaticMeshComponent* Component = Pair.Key;
+		const TArray<FTransform>& Transforms = Pair.Value;
 
-				int32 NumInsts = Component->GetInstanceCount();
-				ArenaGenLog_Info("Converting %d instances into static mesh actors", NumInsts);
+		const int32 Existing = Component->GetInstanceCount();
+		const int32 Overwrite = FMath::Min(Existing, Transforms.Num());
 
-				for (int32 i = 0; i < NumInsts; ++i)
-				{
-					FTransform InstTransform;
-					if (Component->GetInstanceTransform(i, InstTransform, true))
-					{
-						AStaticMeshActor* NewMeshActor = GetWorld()->SpawnActor<AStaticMeshActor>(AStaticMeshActor::StaticClass(), InstTransform);
+		//Remove from the end so the remaining instances keep their indices
+		if (Existing > Transforms.Num())
+		{
+			ToRemove.Reset();
+			for (int32 Idx = Existing - 1; Idx >= Transforms.Num(); --Idx)
+			{
+				ToRemove.Add(Idx);
+			}
+			Component->RemoveInstances(ToRemove);
+			Removed += ToRemove.Num();
+		}
+
+		if (Overwrite > 0)
+		{
+			if (Overwrite == Transforms.Num())
+			{
+				Component->BatchUpdateInstancesTransforms(0, Transforms, false, true, true);
+			}
+			else
+			{
+				Slice.Reset();
+				Slice.Append(Transforms.GetData(), Overwrite);
+				Component->BatchUpdateInstancesTransforms(0, Slice, false, true, true);
+			}
+			Reused += Overwrite;
+		}
+
+		if (Transforms.Num() > Existing)
+		{
+			Slice.Reset();
+			Slice.Append(Transforms.GetData() + Existing, Transforms.Num() - Existing);
+			Component->AddInstances(Slice, false);
+			Added += Slice.Num();
+		}
+
+		Target.TotalInstances += Transforms.Num();
+	}
+
+	//Actors of the same class are moved instead of respawned
+	TMap<UClass*, TArray<AActor*>> ExistingActors;
+	for (AActor* Actor : Target.SpawnedActors)
+	{
+		if (IsValid(Actor)) {
+			ExistingActors.FindOrAdd(Actor->GetClass()).Add(Actor);
+		}
+	}
+	Target.SpawnedActors.Reset();
+
+	for (TPair<UClass*, TArray<FTransform>>& Pair : ActorTransforms)
+	{
+		TArray<AActor*>* Available = ExistingActors.Find(Pair.Key);
+
+		for (const FTransform& Transform : Pair.Value)
+		{
+			if (Available && !Available->IsEmpty())
+			{
+				AActor* Actor = Available->Pop(false);
+				Actor->SetActorRelativeTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+				Target.SpawnedActors.Add(Actor);
+			}
+			else
+			{
+				SpawnArenaActor(Target, Pair.Key, Transform);
+			}
+		}
+	}
+
+	for (TPair<UClass*, TArray<AActor*>>& Pair : ExistingActors)
+	{
+		for (AActor* Actor : Pair.Value) {
+			Actor->Destroy();
+		}
+	}
+
+	ArenaGenLog_InfoSilent("Updated arena in place: %d instances reused, %d added, %d removed", Reused, Added, Removed);
+}
+
+FArenaMassSink* ABaseArenaGenerator::GetMassSink()
+{
+	if (ActorSinkName != FArenaMassSink::SinkName) { return nullptr; }
+
+	//Only the Mass sink factory is registered under its name
+	return static_cast<FArenaMassSink*>(GetOutputSink(ETypeToPlace::Actors));
+}
+
+bool ABaseArenaGenerator::CanUpdateActiveArenaInPlace()
+{
+	const IArenaOutputSink* MeshOutput = GetOutputSink(ETypeToPlace::StaticMeshes);
+	const IArenaOutputSink* ActorOutput = GetOutputSink(ETypeToPlace::Actors);
+
+	return MeshOutput && MeshOutput->CanUpdateInPlace(ActiveArena) && ActorOutput && ActorOutput->CanUpdateInPlace(ActiveArena);
+}
+
+IArenaOutputSink* ABaseArenaGenerator::GetOutputSink(ETypeToPlace AssetToPlace)
+{
+	const bool bActors = AssetToPlace == ETypeToPlace::Actors;
+	TSharedPtr<IArenaOutputSink>& Sink = bActors ? ActorSink : MeshSink;
+	FName& CreatedName = bActors ? CreatedActorSinkName : CreatedMeshSinkName;
+	const FName WantedName = bActors ? ActorSinkName : MeshSinkName;
+
+	if (!Sink.IsValid() || CreatedName != WantedName)
+	{
+		Sink = FArenaOutputSinkRegistry::Get().CreateSink(WantedName);
+		CreatedName = WantedName;
+
+		if (!Sink.IsValid()) {
+			ArenaGenLog_Error("No output sink registered under the name %s.", *WantedName.ToString());
+		}
+	}
+
+	return Sink.Get();
+}
+
+TArray<FName> ABaseArenaGenerator::GetOutputSinkNames()
+{
+	return FArenaOutputSinkRegistry::Get().GetSinkNames();
+}
+
+bool ABaseArenaGenerator::ProcessCommitQueue(FArenaCommitQueue& Queue, FArenaInstanceSet& Target, int32 InstanceBudget, int32 ActorBudget)
+{
+	TArray<FTransform> Slice;
+
+	while (InstanceBudget > 0 && Queue.BatchIdx < Queue.InstanceBatches.Num())
+	{
+		FArenaCommitQueue::FInstanceBatch& Batch = Queue.InstanceBatches[Queue.BatchIdx];
+		const int32 Remaining = Batch.Transforms.Num() - Batch.Cursor;
+		const int32 Count = FMath::Min(Remaining, InstanceBudget);
+
+		if (IsValid(Batch.Component))
+		{
+			if (Batch.Cursor == 0 && Count == Remaining)
+			{
+				Batch.Component->AddInstances(Batch.Transforms, false);
+			}
+			else
+			{
+				Slice.Reset();
+				Slice.Append(Batch.Transforms.GetData() + Batch.Cursor, Count);
+				Batch.Component->AddInstances(Slice, false);
+			}
+			Target.TotalInstances += Count;
+		}
+
+		Batch.Cursor += Count;
+		InstanceBudget -= Count;
+
+		if (Batch.Cursor >= Batch.Transforms.Num())
+		{
+			//Transforms are no longer needed once the component holds them
+			Batch.Transforms.Empty();
+			Queue.BatchIdx++;
+		}
+	}
+
+	//Actors register with navigation as they spawn, their octree updates are applied together
+	FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown, Queue.ActorIdx < Queue.ActorSpawns.Num());
+
+	while (ActorBudget > 0 && Queue.ActorIdx < Queue.ActorSpawns.Num())
+	{
+		const FArenaCommitQueue::FActorSpawn& Spawn = Queue.ActorSpawns[Queue.ActorIdx++];
+		SpawnArenaActor(Target, Spawn.ActorClass, Spawn.Transform);
+		ActorBudget--;
+	}
+
+	return Queue.IsDone();
+}
+
+void ABaseArenaGenerator::ApplyPlannerState(const FArenaPlannerState& State)
+{
+	PlannerState = State;
+
+	InscribedRadius = State.Geometry.InscribedRadius;
+	Apothem = State.Geometry.Apothem;
+	InteriorAngle = State.Geometry.InteriorAngle;
+	ExteriorAngle = State.Geometry.ExteriorAngle;
+	SideLength = State.Geometry.SideLength;
+	ArenaSides = State.Geometry.ArenaSides;
+	ArenaDimensions = State.Geometry.ArenaDimensions;
+	TilesPerArenaSide = State.Geometry.TilesPerArenaSide;
+}
+
+int32 ABaseArenaGenerator::FindOrCreateGroupInstances(FArenaInstanceSet& Target, int32 GroupIdx)
+{
+	int32 ReRouteIdx = Target.UsedGroupIndices.Find(GroupIdx);
+	if (ReRouteIdx != INDEX_NONE)
+	{
+		ArenaGenLog_InfoSilent("Index: %d is already instanced, ignoring request", GroupIdx);
+		return ReRouteIdx;
+	}
+
+	//Using reroute index allows us to add mesh groups out of order to the mesh instances
+	ReRouteIdx = Target.UsedGroupIndices.Add(GroupIdx);
+	TArray<UInstancedStaticMeshComponent*>& ToInstance = Target.MeshInstances.AddDefaulted_GetRef();
+
+	//Group meshes first, then the sub meshes of composite tiles
+	TArray<UStaticMesh*> ComponentMeshes;
+	MeshGroups[GroupIdx].GetComponentMeshes(ComponentMeshes);
+
+	for (UStaticMesh* Mesh : ComponentMeshes)
+	{
+		//Keep empty entries so components stay aligned with mesh indices
+		ToInstance.Add(Mesh ? CreateInstancedMeshComponent(Mesh, Target.bHidden, Target.ComponentClass) : nullptr);
+	}
+
+	ArenaGenLog_Info("Adding the Mesh Group %d to Mesh Instances at index: %d ", GroupIdx, ReRouteIdx);
+	return ReRouteIdx;
+}
+
+
+#pragma region Utility
+
+UInstancedStaticMeshComponent* ABaseArenaGenerator::CreateInstancedMeshComponent(UStaticMesh* Mesh, bool bHidden, UClass* ComponentClass)
+{
+	UInstancedStaticMeshComponent* InstancedMesh =
+		NewObject<UInstancedStaticMeshComponent>(this, ComponentClass ? ComponentClass : UInstancedStaticMeshComponent::StaticClass());
+
+	InstancedMesh->SetStaticMesh(Mesh);
+	InstancedMesh->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+
+	//Enabled with the rest of its set once every instance is added
+	if (bBatchNavigationUpdates) {
+		InstancedMesh->SetCanEverAffectNavigation(false);
+	}
+
+	//Without collision no body is created on registration or for each added instance
+	if (bDeferPhysicsCreation && InstancedMesh->GetCollisionEnabled() != ECollisionEnabled::NoCollision)
+	{
+		DeferredPhysics.Add(InstancedMesh, InstancedMesh->GetCollisionEnabled());
+		InstancedMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+
+	if (bHidden)
+	{
+		//Bodies are still created so revealing only has to update collision filters
+		InstancedMesh->SetVisibility(false);
+		InstancedMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
+	}
+
+	InstancedMesh->RegisterComponent();
+
+	return InstancedMesh;
+}
+
+AActor* ABaseArenaGenerator::SpawnArenaActor(FArenaInstanceSet& Target, TSubclassOf<AActor> ActorClass, const FTransform& RelativeTransform)
+{
+	FActorSpawnParameters SpawnParams = FActorSpawnParameters();
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	SpawnParams.Owner = this;
+
+	FTransform ActorTransform;
+
+	AActor* ActorToSpawn = Cast<AActor>(GetWorld()->SpawnActor(ActorClass, &ActorTransform, SpawnParams));
+	if (!ActorToSpawn) { return nullptr; }
+
+	ActorToSpawn->AttachToActor(this, FAttachmentTransformRules::KeepRelativeTransform);
+	ActorToSpawn->SetActorRelativeTransform(RelativeTransform, false);
+
+	if (Target.bHidden)
+	{
+		ActorToSpawn->SetActorHiddenInGame(true);
+		ActorToSpawn->SetActorEnableCollision(false);
+	}
+
+	Target.SpawnedActors.Add(ActorToSpawn);
+	return ActorToSpawn;
+}
+
+void ABaseArenaGenerator::DestroyInstanceSet(FArenaInstanceSet& Set)
+{
+	//Iterate through mesh instances and destroy before dereferencing
+	for (auto& Inst : Set.MeshInstances)
+	{
+		for (auto& Component : Inst) {
+			if (Component) {
+				Component->DestroyComponent();
+			}
+		}
+	}
+
+	for (UInstancedStaticMeshComponent* Component : Set.SinkComponents)
+	{
+		if (IsValid(Component)) {
+			Component->DestroyComponent();
+		}
+	}
+
+	//Iterate through spawned actors and destroy spawned actors
+	for (AActor* Actor : Set.SpawnedActors)
+	{
+		if (IsValid(Actor)) {
+			Actor->Destroy();
+		}
+	}
+
+	const bool bHidden = Set.bHidden;
+	UClass* ComponentClass = Set.ComponentClass;
+	Set = FArenaInstanceSet();
+	Set.bHidden = bHidden;
+	Set.ComponentClass = ComponentClass;
+}
+
+void ABaseArenaGenerator::SetInstanceSetRevealed(FArenaInstanceSet& Set, bool bRevealed)
+{
+	const UInstancedStaticMeshComponent* DefaultComponent = GetDefault<UInstancedStaticMeshComponent>();
+	const FCollisionResponseContainer& DefaultResponses = DefaultComponent->GetCollisionResponseToChannels();
+	const EHasCustomNavigableGeometry::Type DefaultNavigableGeometry = DefaultComponent->HasCustomNavigableGeometry();
+
+	auto RevealComponent = [bRevealed, &DefaultResponses, DefaultNavigableGeometry](UInstancedStaticMeshComponent* Component)
+	{
+		if (!Component) { return; }
+
+		Component->SetVisibility(bRevealed);
+		if (bRevealed) {
+			//Navigable without collision while its navigation was built hidden, see SwapToNextArena
+			Component->SetCustomNavigableGeometry(DefaultNavigableGeometry);
+			Component->SetCollisionResponseToChannels(DefaultResponses);
+		}
+		else {
+			Component->SetCollisionResponseToAllChannels(ECR_Ignore);
+		}
+	};
+
+	for (auto& Inst : Set.MeshInstances)
+	{
+		for (auto& Component : Inst) {
+			RevealComponent(Component);
+		}
+	}
+
+	for (UInstancedStaticMeshComponent* Component : Set.SinkComponents)
+	{
+		RevealComponent(Component);
+	}
+
+	for (AActor* Actor : Set.SpawnedActors)
+	{
+		if (IsValid(Actor)) {
+			Actor->SetActorHiddenInGame(!bRevealed);
+			Actor->SetActorEnableCollision(bRevealed);
+		}
+	}
+
+	Set.bHidden = !bRevealed;
+}
+
+void ABaseArenaGenerator::PrestreamInstanceSet(FArenaInstanceSet& Set, float Seconds)
+{
+	for (auto& Inst : Set.MeshInstances)
+	{
+		for (auto& Component : Inst) {
+			if (Component) { Component->PrestreamTextures(Seconds, false); }
+		}
+	}
+
+	for (UInstancedStaticMeshComponent* Component : Set.SinkComponents)
+	{
+		if (IsValid(Component)) { Component->PrestreamTextures(Seconds, false); }
+	}
+
+	for (AActor* Actor : Set.SpawnedActors)
+	{
+		if (IsValid(Actor)) { Actor->PrestreamTextures(Seconds, false); }
+	}
+}
+
+void ABaseArenaGenerator::ConvertToStaticMeshActors()
+{
+
+	if (!ActiveArena.MeshInstances.IsEmpty())
+	{
+		for (auto& Inst : ActiveArena.MeshInstances)
+		{
+			for (auto& Component : Inst) {
+				if (!Component || Component->GetStaticMesh() == nullptr) { continue; }
+
+				int32 NumInsts = Component->GetInstanceCount();
+				ArenaGenLog_Info("Converting %d instances into static mesh actors", NumInsts);
+
+				for (int32 i = 0; i < NumInsts; ++i)
+				{
+					FTransform InstTransform;
+					if (Component->GetInstanceTransform(i, InstTransform, true))
+					{
+						AStaticMeshActor* NewMeshActor = GetWorld()->SpawnActor<AStaticMeshActor>(AStaticMeshActor::StaticClass(), InstTransform);
 
 						if (NewMeshActor)
 						{
@@ -946,7 +925,1538 @@ void ABaseArenaGenerator::ConvertToStaticMeshActors()
 
 }
 
+#pragma endregion
+
+#pragma region Baking
 
+void ABaseArenaGenerator::BakeArena()
+{
+	BakeArenaLayout();
+}
 
-#pragma endregion
+void ABaseArenaGenerator::ClearBakedLayout()
+{
+	Modify();
+	BakedLayout = FArenaBakedLayout();
+
+	if (BakedLayoutAsset)
+	{
+		BakedLayoutAsset->Modify();
+		BakedLayoutAsset->Layout = FArenaBakedLayout();
+	}
+}
+
+bool ABaseArenaGenerator::BakeArenaLayout()
+{
+	//Always build from the section list, never from previous bakes
+	WipeArena();
+	{
+		TGuardValue<bool> BlockingSnapGuard(bBlockingGroundSnap, true);
+		BuildSections();
+	}
+
+	//Capturing now would bake the arena without the sections still waiting for the ground
+	if (IsSnappingToGround())
+	{
+		ArenaGenLog_Error("Arena %s is still snapping to the ground, it was not baked.", *GetName());
+		CancelGroundSnaps();
+		return false;
+	}
+
+	FArenaBakedLayout Layout = CaptureBakedLayout();
+	if (!Layout.IsValid())
+	{
+		ArenaGenLog_Warning("Nothing was generated, arena %s was not baked.", *GetName());
+		return false;
+	}
+
+	ArenaGenLog_Info("Baking arena %s: %d meshes, %d actors", *GetName(), Layout.MeshInstances.Num(), Layout.Actors.Num());
+
+	switch (BakeTarget)
+	{
+		case EArenaBakeTarget::SidecarAsset:
+		{
+			if (!BakedLayoutAsset)
+			{
+				ArenaGenLog_Error("Arena %s bakes to a sidecar asset but none is assigned.", *GetName());
+				return false;
+			}
+
+			BakedLayoutAsset->Modify();
+			BakedLayoutAsset->Layout = MoveTemp(Layout);
+
+			//Don't keep a stale copy in the level
+			Modify();
+			BakedLayout = FArenaBakedLayout();
+		}break;
+
+		default:
+		case EArenaBakeTarget::Level:
+		{
+			Modify();
+			BakedLayout = MoveTemp(Layout);
+		}break;
+	}
+
+	return true;
+}
 
+FArenaBakedLayout ABaseArenaGenerator::CaptureBakedLayout() const
+{
+	FArenaBakedLayout Layout;
+	Layout.Seed = ArenaSeed;
+
+	for (int32 ReRouteIdx = 0; ReRouteIdx < ActiveArena.MeshInstances.Num(); ++ReRouteIdx)
+	{
+		for (int32 MeshIdx = 0; MeshIdx < ActiveArena.MeshInstances[ReRouteIdx].Num(); ++MeshIdx)
+		{
+			const UInstancedStaticMeshComponent* Component = ActiveArena.MeshInstances[ReRouteIdx][MeshIdx];
+			if (!Component || Component->GetStaticMesh() == nullptr) { continue; }
+
+			FArenaBakedMeshInstances& Baked = Layout.MeshInstances.AddDefaulted_GetRef();
+			Baked.Mesh = Component->GetStaticMesh();
+			Baked.GroupIndex = ActiveArena.UsedGroupIndices.IsValidIndex(ReRouteIdx) ? ActiveArena.UsedGroupIndices[ReRouteIdx] : 0;
+			Baked.MeshIndex = MeshIdx;
+
+			const int32 NumInsts = Component->GetInstanceCount();
+			Baked.Transforms.Reserve(NumInsts);
+
+			for (int32 i = 0; i < NumInsts; ++i)
+			{
+				FTransform InstTransform;
+				if (Component->GetInstanceTransform(i, InstTransform, false))
+				{
+					Baked.Transforms.Add(InstTransform);
+				}
+			}
+		}
+	}
+
+	for (const AActor* Actor : ActiveArena.SpawnedActors)
+	{
+		if (!IsValid(Actor)) { continue; }
+
+		FArenaBakedActor& Baked = Layout.Actors.AddDefaulted_GetRef();
+		Baked.ActorClass = Actor->GetClass();
+		Baked.Transform = Actor->GetActorTransform().GetRelativeTransform(GetActorTransform());
+	}
+
+	Layout.Annotations = Annotations;
+
+	Layout.UpdateStats();
+	return Layout;
+}
+
+void ABaseArenaGenerator::ApplyBakedLayout(const FArenaBakedLayout& Layout)
+{
+	//Baked tiles have no lattice, the tile state table only knows where they are
+	TArray<FVector> TileLocations;
+
+	for (const FArenaBakedMeshInstances& Baked : Layout.MeshInstances)
+	{
+		if (!Baked.Mesh || Baked.Transforms.IsEmpty() || Baked.MeshIndex < 0) { continue; }
+
+		//Sub meshes of composite tiles come after the group's meshes and are not tiles of their own
+		if (!MeshGroups.IsValidIndex(Baked.GroupIndex) || Baked.MeshIndex < MeshGroups[Baked.GroupIndex].GroupMeshes.Num())
+		{
+			for (const FTransform& Transform : Baked.Transforms)
+			{
+				TileLocations.Add(Transform.GetLocation());
+			}
+		}
+
+		//Keep instances grouped the same way BuildSection does so wiping and converting behave identically
+		int32 ReRouteIdx = ActiveArena.UsedGroupIndices.Find(Baked.GroupIndex);
+		if (ReRouteIdx == INDEX_NONE)
+		{
+			ReRouteIdx = ActiveArena.UsedGroupIndices.Add(Baked.GroupIndex);
+			ActiveArena.MeshInstances.AddDefaulted();
+		}
+
+		//Components stay aligned with mesh indices, so later in place updates move instances of the right mesh
+		TArray<UInstancedStaticMeshComponent*>& Components = ActiveArena.MeshInstances[ReRouteIdx];
+		if (!Components.IsValidIndex(Baked.MeshIndex)) {
+			Components.SetNum(Baked.MeshIndex + 1);
+		}
+
+		UInstancedStaticMeshComponent*& InstancedMesh = Components[Baked.MeshIndex];
+		if (!InstancedMesh) {
+			InstancedMesh = CreateInstancedMeshComponent(Baked.Mesh, false, ActiveArena.ComponentClass);
+		}
+		InstancedMesh->AddInstances(Baked.Transforms, false);
+
+		ActiveArena.TotalInstances += Baked.Transforms.Num();
+	}
+
+	for (const FArenaBakedActor& Baked : Layout.Actors)
+	{
+		if (Baked.ActorClass)
+		{
+			SpawnArenaActor(ActiveArena, Baked.ActorClass, Baked.Transform);
+			TileLocations.Add(Baked.Transform.GetLocation());
+		}
+	}
+
+	TileState.AddTileLocations(TileLocations);
+	Annotations = Layout.Annotations;
+
+	//Baked layouts keep no lattice coordinates to rebuild the graph from
+	TileGraph.Reset();
+	ActivePlan.Reset();
+
+	QueueInstanceSetPhysics(ActiveArena);
+
+	if (bBatchNavigationUpdates)
+	{
+		SetInstanceSetAffectsNavigation(ActiveArena, true);
+		SubmitNavigationUpdate(GetInstanceSetBounds(ActiveArena));
+	}
+}
+
+const FArenaBakedLayout* ABaseArenaGenerator::FindBakedLayout() const
+{
+	if (BakeTarget == EArenaBakeTarget::SidecarAsset)
+	{
+		return (BakedLayoutAsset && BakedLayoutAsset->Layout.IsValid()) ? &BakedLayoutAsset->Layout : nullptr;
+	}
+
+	return BakedLayout.IsValid() ? &BakedLayout : nullptr;
+}
+
+#pragma endregion
+
+
+#pragma region Double Buffering
+
+void ABaseArenaGenerator::PrepareNextArena(int32 Seed)
+{
+	if (!GetWorld()) { return; }
+
+	CancelNextArena();
+
+	if (MeshGroups.IsEmpty() && ActorGroups.IsEmpty()) {
+		ArenaGenLog_Error("Cannot prepare next arena with empty Mesh & Actor Groups!");
+		return;
+	}
+
+	const int32 RequestId = ++NextArenaRequestId;
+	NextArenaSeed = Seed;
+	bPreparingNextArena = true;
+
+	//The worker plans from its own copy, the generator may change while it runs
+	TSharedPtr<FArenaLayoutInputs> Inputs = MakeShared<FArenaLayoutInputs>(GatherLayoutInputs());
+	TWeakObjectPtr<ABaseArenaGenerator> WeakThis(this);
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Inputs, Seed, RequestId]()
+	{
+		TSharedPtr<FArenaLayoutPlan> Plan = MakeShared<FArenaLayoutPlan>();
+
+		FArenaLayoutPlanner Planner(*Inputs, FRandomStream(Seed));
+		Planner.PlanLayout(*Plan);
+		const FArenaPlannerState State = Planner.GetState();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Plan, State, Inputs, RequestId]()
+		{
+			if (ABaseArenaGenerator* Generator = WeakThis.Get())
+			{
+				Generator->OnNextArenaPlanned(RequestId, Plan, State, Inputs);
+			}
+		});
+	});
+
+	ArenaGenLog_Info("Preparing next arena with seed: %d", Seed);
+}
+
+bool ABaseArenaGenerator::SwapToNextArena()
+{
+	if (!bNextArenaReady)
+	{
+		ArenaGenLog_Warning("No next arena is ready to be swapped in.");
+		return false;
+	}
+
+	if (bSwapAwaitingNavigation)
+	{
+		ArenaGenLog_Warning("Already swapping, waiting for the navigation of the next arena.");
+		return false;
+	}
+
+	if (bBatchNavigationUpdates && bBuildNavigationBeforeSwap && FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		//Navigation only uses geometry blocking pawns. The hidden arena keeps ignoring collision so it does not block anyone over the
+		//active arena, and is exported as navigable geometry regardless. The active arena stays in the navmesh until the swap.
+		auto SetNavigableWithoutCollision = [](UInstancedStaticMeshComponent* Component)
+		{
+			if (IsValid(Component)) { Component->SetCustomNavigableGeometry(EHasCustomNavigableGeometry::EvenIfNotCollision); }
+		};
+
+		for (auto& Inst : NextArena.MeshInstances)
+		{
+			for (auto& Component : Inst) {
+				SetNavigableWithoutCollision(Component);
+			}
+		}
+
+		for (UInstancedStaticMeshComponent* Component : NextArena.SinkComponents)
+		{
+			SetNavigableWithoutCollision(Component);
+		}
+
+		SetInstanceSetAffectsNavigation(NextArena, true);
+
+		ArenaGenLog_Info("Building navigation of the next arena before swapping");
+
+		bSwapAwaitingNavigation = true;
+		SubmitNavigationUpdate(GetInstanceSetBounds(NextArena));
+		return true;
+	}
+
+	CompleteSwapToNextArena();
+	return true;
+}
+
+void ABaseArenaGenerator::CompleteSwapToNextArena()
+{
+	const bool bNavigationBuilt = bSwapAwaitingNavigation;
+	bSwapAwaitingNavigation = false;
+
+	//A built arena is already in the navmesh, only the old one still has to leave it
+	FBox NavigationBounds(ForceInit);
+	if (bBatchNavigationUpdates) {
+		NavigationBounds = bNavigationBuilt ? GetInstanceSetBounds(ActiveArena) : GetInstanceSetBounds(ActiveArena) + GetInstanceSetBounds(NextArena);
+	}
+
+	SetInstanceSetRevealed(ActiveArena, false);
+	Swap(ActiveArena, NextArena);
+	SetInstanceSetRevealed(ActiveArena, true);
+
+	if (bBatchNavigationUpdates)
+	{
+		SetInstanceSetAffectsNavigation(NextArena, false);
+		SetInstanceSetAffectsNavigation(ActiveArena, true);
+		SubmitNavigationUpdate(NavigationBounds);
+	}
+
+	//Old arena is released over the next frames instead of in one hitch
+	if (!NextArena.IsEmpty())
+	{
+		RetiredArenas.Add(MoveTemp(NextArena));
+		ReleaseTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickArenaRelease);
+	}
+	NextArena = FArenaInstanceSet();
+	NextArenaQueue = FArenaCommitQueue();
+	bNextArenaReady = false;
+
+	ArenaSeed = NextArenaSeed;
+	ArenaStream = FRandomStream(ArenaSeed);
+	ActiveArenaStream = ArenaStream;
+	ApplyPlannerState(NextArenaState);
+
+	TileState.ResetTiles();
+	Annotations.Reset();
+	TileGraph.Reset();
+	ActivePlan.Reset();
+	if (NextArenaPlan.IsValid()) {
+		TileState.AddPlanTiles(*NextArenaPlan);
+		Annotations = NextArenaPlan->Annotations;
+		SetTileGraph(NextArenaPlan->TileGraph);
+		SetActivePlan(*NextArenaPlan, false);
+	}
+	NextArenaPlan.Reset();
+
+	ArenaGenLog_Info("============ Swapped to next Arena, # of Instances: %d ============", ActiveArena.TotalInstances);
+	OnArenaSwapped.Broadcast();
+}
+
+void ABaseArenaGenerator::CancelNextArena()
+{
+	//Invalidates any plan still running in the background
+	++NextArenaRequestId;
+
+	bPreparingNextArena = false;
+	bNextArenaReady = false;
+
+	if (UWorld* World = GetWorld()) {
+		World->GetTimerManager().ClearTimer(NextArenaTimerHandle);
+	}
+
+	//The prepared arena was added to the navmesh for the build, take it out again
+	if (bSwapAwaitingNavigation)
+	{
+		bSwapAwaitingNavigation = false;
+		SetInstanceSetAffectsNavigation(NextArena, false);
+		SubmitNavigationUpdate(GetInstanceSetBounds(NextArena));
+	}
+
+	NextArenaQueue = FArenaCommitQueue();
+	NextArenaPlan.Reset();
+	CancelGroundSnap(EArenaGroundSnapTarget::NextArena);
+	DestroyInstanceSet(NextArena);
+}
+
+void ABaseArenaGenerator::OnNextArenaPlanned(int32 RequestId, TSharedPtr<FArenaLayoutPlan> Plan, const FArenaPlannerState& State, TSharedPtr<const FArenaLayoutInputs> Inputs)
+{
+	if (RequestId != NextArenaRequestId || !bPreparingNextArena || !Plan.IsValid()) { return; }
+
+	ArenaGenLog_InfoSilent("Next arena planned %d patterns, %d tiles, %d duplicates removed", Plan->Patterns.Num(), Plan->Tiles.Num(), Plan->NumDuplicatesRemoved);
+
+	NextArenaState = State;
+	NextArenaPlan = Plan;
+	NextArena.bHidden = true;
+
+	//Queued once the ground traces returned
+	if (StartGroundSnap(*Plan, *Inputs, EArenaGroundSnapTarget::NextArena)) { return; }
+
+	QueueCommit(*Plan, NextArena, NextArenaQueue);
+
+	TickNextArenaPreparation();
+}
+
+void ABaseArenaGenerator::TickNextArenaPreparation()
+{
+	if (!bPreparingNextArena) { return; }
+
+	if (!ProcessCommitQueue(NextArenaQueue, NextArena, PrepareInstancesPerFrame, PrepareActorsPerFrame))
+	{
+		NextArenaTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickNextArenaPreparation);
+		return;
+	}
+
+	if (!NextArenaQueue.bPhysicsQueued)
+	{
+		NextArenaQueue.bPhysicsQueued = true;
+		QueueInstanceSetPhysics(NextArena);
+
+		//Only now does the hidden arena have instances whose textures can be streamed
+		if (PrestreamSeconds > 0.f) {
+			PrestreamInstanceSet(NextArena, PrestreamSeconds);
+		}
+	}
+
+	//Swapping in an arena whose bodies are still being created would let players fall through it
+	if (!IsArenaCollidable())
+	{
+		NextArenaTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickNextArenaPreparation);
+		return;
+	}
+
+	bPreparingNextArena = false;
+	bNextArenaReady = true;
+	NextArenaQueue = FArenaCommitQueue();
+
+	ArenaGenLog_Info("Next arena is ready, # of Instances: %d", NextArena.TotalInstances);
+	OnNextArenaReady.Broadcast();
+}
+
+void ABaseArenaGenerator::TickArenaRelease()
+{
+	int32 Budget = ReleaseObjectsPerFrame;
+
+	while (Budget > 0 && !RetiredArenas.IsEmpty())
+	{
+		FArenaInstanceSet& Retired = RetiredArenas[0];
+
+		//Components are destroyed back to front so the arrays shrink without shifting
+		while (Budget > 0 && !Retired.MeshInstances.IsEmpty())
+		{
+			TArray<UInstancedStaticMeshComponent*>& Inst = Retired.MeshInstances.Last();
+			if (Inst.IsEmpty()) {
+				Retired.MeshInstances.Pop(false);
+				continue;
+			}
+
+			if (UInstancedStaticMeshComponent* Component = Inst.Pop(false)) {
+				Component->DestroyComponent();
+				Budget--;
+			}
+		}
+
+		while (Budget > 0 && !Retired.SinkComponents.IsEmpty())
+		{
+			UInstancedStaticMeshComponent* Component = Retired.SinkComponents.Pop(false);
+			if (IsValid(Component)) {
+				Component->DestroyComponent();
+				Budget--;
+			}
+		}
+
+		while (Budget > 0 && !Retired.SpawnedActors.IsEmpty())
+		{
+			AActor* Actor = Retired.SpawnedActors.Pop(false);
+			if (IsValid(Actor)) {
+				Actor->Destroy();
+				Budget--;
+			}
+		}
+
+		if (Retired.IsEmpty()) {
+			RetiredArenas.RemoveAt(0);
+		}
+	}
+
+	if (!RetiredArenas.IsEmpty())
+	{
+		ReleaseTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickArenaRelease);
+	}
+}
+
+#pragma endregion
+
+#pragma region Streaming
+
+void ABaseArenaGenerator::StartArenaStreaming()
+{
+	//Bands of a previous stream stay where they are, the new stream continues above them
+	ResetStreaming();
+	CancelNextArena();
+
+	if (MeshGroups.IsEmpty() && ActorGroups.IsEmpty()) {
+		ArenaGenLog_Error("Cannot stream arena with empty Mesh & Actor Groups!");
+		return;
+	}
+
+	if (SectionList.IsEmpty())
+	{
+		ArenaGenLog_Warning("SectionList is empty! Arena streaming is null.");
+		return;
+	}
+
+	//Continues from the origin offset, mesh size and tiles per side left by the arena already generated
+	StreamInputs = MakeShared<FArenaLayoutInputs>(GatherLayoutInputs());
+	StreamState = PlannerState;
+	StreamRandom = ArenaStream;
+	StreamSectionIdx = 0;
+	bStreaming = true;
+
+	//Bands are added to the active arena, it no longer matches a plan of the section list
+	ActiveArenaStream.Reset();
+
+	ArenaGenLog_Info("============ Streaming Arena ============");
+}
+
+void ABaseArenaGenerator::StopArenaStreaming()
+{
+	bStreaming = false;
+	bStreamBandInFlight = false;
+
+	//Drops any band still being planned or snapped
+	++StreamRequestId;
+	CancelGroundSnap(EArenaGroundSnapTarget::StreamBand);
+	SnappingStreamBand = FArenaStreamBand();
+}
+
+void ABaseArenaGenerator::UpdateArenaStreaming(const FVector& ViewerLocation)
+{
+	const float ViewerZ = GetActorTransform().InverseTransformPosition(ViewerLocation).Z;
+
+	//Bands are ordered by height so only the lowest ones can be retired
+	int32 NumRetired = 0;
+	while (NumRetired < StreamBands.Num() && StreamBands[NumRetired].MaxZ < ViewerZ - StreamRetireDistance)
+	{
+		RetireStreamBand(StreamBands[NumRetired]);
+		NumRetired++;
+	}
+
+	if (NumRetired > 0) {
+		StreamBands.RemoveAt(0, NumRetired, false);
+	}
+
+	const float TopZ = StreamBands.IsEmpty() ? StreamState.OriginOffset.Z : StreamBands.Last().MaxZ;
+	if (bStreaming && !bStreamBandInFlight && TopZ < ViewerZ + StreamAheadDistance)
+	{
+		RequestStreamBand();
+	}
+}
+
+void ABaseArenaGenerator::RequestStreamBand()
+{
+	if (!StreamInputs.IsValid()) { return; }
+
+	const int32 RequestId = ++StreamRequestId;
+	bStreamBandInFlight = true;
+
+	TSharedPtr<FArenaLayoutInputs> Inputs = StreamInputs;
+	const FArenaPlannerState State = StreamState;
+	const FRandomStream Stream = StreamRandom;
+	const int32 SectionIdx = StreamSectionIdx;
+	TWeakObjectPtr<ABaseArenaGenerator> WeakThis(this);
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Inputs, State, Stream, SectionIdx, RequestId]()
+	{
+		TSharedPtr<FArenaLayoutPlan> Plan = MakeShared<FArenaLayoutPlan>();
+
+		FArenaLayoutPlanner Planner(*Inputs, Stream);
+		Planner.SetState(State);
+		Planner.PlanSectionBand(SectionIdx, *Plan);
+
+		const FArenaPlannerState NewState = Planner.GetState();
+		const FRandomStream NewStream = Planner.GetStream();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Plan, NewState, NewStream, RequestId]()
+		{
+			if (ABaseArenaGenerator* Generator = WeakThis.Get())
+			{
+				Generator->OnStreamBandPlanned(RequestId, Plan, NewState, NewStream);
+			}
+		});
+	});
+}
+
+void ABaseArenaGenerator::OnStreamBandPlanned(int32 RequestId, TSharedPtr<FArenaLayoutPlan> Plan, const FArenaPlannerState& State, const FRandomStream& Stream)
+{
+	if (RequestId != StreamRequestId || !bStreaming || !Plan.IsValid()) { return; }
+
+	FArenaStreamBand Band;
+	Band.MinZ = StreamState.OriginOffset.Z;
+	Band.MaxZ = State.OriginOffset.Z;
+
+	//A band that does not climb would be planned again at the same height forever
+	if (Band.MaxZ <= Band.MinZ)
+	{
+		ArenaGenLog_Error("Section %d does not update the origin offset height, cannot stream it. Stopping arena streaming.", StreamSectionIdx);
+		StopArenaStreaming();
+		return;
+	}
+
+	StreamState = State;
+	StreamRandom = Stream;
+	StreamSectionIdx = (StreamSectionIdx + 1) % StreamInputs->SectionList.Num();
+
+	//The next band is requested once this one was snapped and committed
+	if (StartGroundSnap(*Plan, *StreamInputs, EArenaGroundSnapTarget::StreamBand))
+	{
+		SnappingStreamBand = MoveTemp(Band);
+		return;
+	}
+
+	AddStreamBand(*Plan, MoveTemp(Band));
+}
+
+void ABaseArenaGenerator::AddStreamBand(const FArenaLayoutPlan& Plan, FArenaStreamBand&& Band)
+{
+	bStreamBandInFlight = false;
+
+	//Components are shared with the lower bands, so they stop affecting navigation while the band's instances are added
+	if (bBatchNavigationUpdates) {
+		SetInstanceSetAffectsNavigation(ActiveArena, false);
+	}
+
+	CommitStreamBand(Plan, Band);
+	QueueInstanceSetPhysics(ActiveArena);
+
+	if (bBatchNavigationUpdates)
+	{
+		//Only the height of the new band is dirtied, lower bands keep their navmesh
+		FBox BandBounds = GetInstanceSetBounds(ActiveArena).InverseTransformBy(GetActorTransform());
+		BandBounds.Min.Z = Band.MinZ;
+		BandBounds.Max.Z = Band.MaxZ;
+
+		SetInstanceSetAffectsNavigation(ActiveArena, true);
+		SubmitNavigationUpdate(BandBounds.TransformBy(GetActorTransform()));
+	}
+
+	//Tile state follows the bands, so it stays bounded like the instances
+	Band.Tiles.FirstTile = TileState.Num();
+	Band.Tiles.NumTiles = Plan.Tiles.Num();
+	TileState.AddPlanTiles(Plan);
+
+	StreamBands.Add(MoveTemp(Band));
+
+	//Generation after the stream continues above its last band
+	ApplyPlannerState(StreamState);
+	ArenaStream = StreamRandom;
+}
+
+void ABaseArenaGenerator::CommitStreamBand(const FArenaLayoutPlan& Plan, FArenaStreamBand& Band)
+{
+	//New instances per component, added in one batch once free slots are used up
+	TMap<UInstancedStaticMeshComponent*, TArray<FTransform>> ToAdd;
+	TSet<UInstancedStaticMeshComponent*> Updated;
+
+	//Only the built-in actor sink is pooled here, other actor sinks such as Mass entities receive the band's actor patterns like any commit
+	IArenaOutputSink* ActorOutput = ActorSinkName != FArenaOutputSinkRegistry::ActorSinkName ? GetOutputSink(ETypeToPlace::Actors) : nullptr;
+	TArray<const FArenaPlannedPattern*> SinkPatterns;
+
+	for (const FArenaPlannedPattern& Pattern : Plan.Patterns)
+	{
+		TArrayView<const FArenaPlannedTile> Tiles = Plan.GetPatternTiles(Pattern);
+
+		switch (Pattern.AssetToPlace) {
+			default:
+			case ETypeToPlace::StaticMeshes:
+			{
+				const int32 ReRouteIdx = FindOrCreateGroupInstances(ActiveArena, Pattern.GroupIdx);
+				const TArray<UInstancedStaticMeshComponent*>& Components = ActiveArena.MeshInstances[ReRouteIdx];
+
+				//Sub meshes of composite tiles recycle slots of their own components like any tile
+				for (TArrayView<const FArenaPlannedTile> Instances : { Tiles, Plan.GetPatternSubTiles(Pattern) })
+				{
+					for (const FArenaPlannedTile& Tile : Instances)
+					{
+						UInstancedStaticMeshComponent* Component = Components.IsValidIndex(Tile.MeshIdx) ? Components[Tile.MeshIdx] : nullptr;
+						if (!Component) { continue; }
+
+						TArray<int32>* FreeSlots = FreeStreamSlots.Find(Component);
+						if (FreeSlots && !FreeSlots->IsEmpty())
+						{
+							const int32 Slot = FreeSlots->Pop(false);
+							Component->UpdateInstanceTransform(Slot, Tile.Transform, false, false, true);
+							Band.Slots.Emplace(Component, Slot);
+							Updated.Add(Component);
+						}
+						else
+						{
+							ToAdd.FindOrAdd(Component).Add(Tile.Transform);
+						}
+					}
+				}
+			}break;
+
+			case ETypeToPlace::Actors:
+			{
+				if (ActorOutput)
+				{
+					SinkPatterns.Add(&Pattern);
+					break;
+				}
+
+				if (!ActorGroups.IsValidIndex(Pattern.GroupIdx)) { break; }
+				const TArray<TSubclassOf<AActor>>& Classes = ActorGroups[Pattern.GroupIdx].ClassesToSpawn;
+
+				for (const FArenaPlannedTile& Tile : Tiles)
+				{
+					if (!Classes.IsValidIndex(Tile.MeshIdx) || !Classes[Tile.MeshIdx]) { continue; }
+
+					AActor* Actor = nullptr;
+					TArray<AActor*>* FreeActors = FreeStreamActors.Find(Classes[Tile.MeshIdx]);
+					while (!Actor && FreeActors && !FreeActors->IsEmpty())
+					{
+						Actor = FreeActors->Pop(false);
+						if (!IsValid(Actor)) { Actor = nullptr; }
+					}
+
+					if (Actor)
+					{
+						Actor->SetActorRelativeTransform(Tile.Transform, false, nullptr, ETeleportType::TeleportPhysics);
+						Actor->SetActorHiddenInGame(false);
+						Actor->SetActorEnableCollision(true);
+					}
+					else
+					{
+						Actor = SpawnArenaActor(ActiveArena, Classes[Tile.MeshIdx], Tile.Transform);
+					}
+
+					if (Actor) {
+						Band.Actors.Add(Actor);
+					}
+				}
+			}break;
+		}
+	}
+
+	for (UInstancedStaticMeshComponent* Component : Updated)
+	{
+		Component->MarkRenderStateDirty();
+	}
+
+	for (TPair<UInstancedStaticMeshComponent*, TArray<FTransform>>& Pair : ToAdd)
+	{
+		const TArray<int32> Indices = Pair.Key->AddInstances(Pair.Value, true);
+		for (const int32 Slot : Indices)
+		{
+			Band.Slots.Emplace(Pair.Key, Slot);
+		}
+	}
+
+	if (!SinkPatterns.IsEmpty())
+	{
+		const int32 FirstSinkComponent = ActiveArena.SinkComponents.Num();
+		const int32 FirstActor = ActiveArena.SpawnedActors.Num();
+
+		FArenaCommitQueue Queue;
+		FArenaSinkContext Context{ *this, ActiveArena, Queue };
+
+		ActorOutput->BeginCommit(Context, Plan);
+		for (const FArenaPlannedPattern* Pattern : SinkPatterns)
+		{
+			ActorOutput->CommitTiles(Context, *Pattern, Plan.GetPatternTiles(*Pattern));
+		}
+		ActorOutput->EndCommit(Context);
+		ProcessCommitQueue(Queue, ActiveArena, MAX_int32, MAX_int32);
+
+		for (int32 Idx = FirstSinkComponent; Idx < ActiveArena.SinkComponents.Num(); ++Idx)
+		{
+			Band.SinkComponents.Add(ActiveArena.SinkComponents[Idx]);
+		}
+		for (int32 Idx = FirstActor; Idx < ActiveArena.SpawnedActors.Num(); ++Idx)
+		{
+			Band.Actors.Add(ActiveArena.SpawnedActors[Idx]);
+		}
+	}
+
+	ActiveArena.TotalInstances += Band.Slots.Num();
+}
+
+void ABaseArenaGenerator::RetireStreamBand(FArenaStreamBand& Band)
+{
+	//Zero scale hides the instance and removes it from collision without shifting other slots
+	const FTransform HiddenTransform(FQuat::Identity, FVector(0.f, 0.f, Band.MinZ), FVector::ZeroVector);
+	TSet<UInstancedStaticMeshComponent*> Updated;
+
+	for (const TPair<UInstancedStaticMeshComponent*, int32>& Slot : Band.Slots)
+	{
+		if (!IsValid(Slot.Key)) { continue; }
+
+		Slot.Key->UpdateInstanceTransform(Slot.Value, HiddenTransform, false, false, true);
+		FreeStreamSlots.FindOrAdd(Slot.Key).Add(Slot.Value);
+		Updated.Add(Slot.Key);
+	}
+
+	for (UInstancedStaticMeshComponent* Component : Updated)
+	{
+		Component->MarkRenderStateDirty();
+	}
+
+	for (AActor* Actor : Band.Actors)
+	{
+		if (!IsValid(Actor)) { continue; }
+
+		Actor->SetActorHiddenInGame(true);
+		Actor->SetActorEnableCollision(false);
+		FreeStreamActors.FindOrAdd(Actor->GetClass()).Add(Actor);
+	}
+
+	if (!Band.SinkComponents.IsEmpty())
+	{
+		if (FArenaMassSink* MassSink = GetMassSink()) {
+			MassSink->ReleaseBatches(*this, Band.SinkComponents);
+		}
+
+		for (UInstancedStaticMeshComponent* Component : Band.SinkComponents)
+		{
+			ActiveArena.SinkComponents.RemoveSingleSwap(Component, false);
+			if (IsValid(Component)) { Component->DestroyComponent(); }
+		}
+	}
+
+	//Rows of the bands above move down in the tile state table
+	TileState.RemoveTiles(Band.Tiles);
+	for (FArenaStreamBand& Other : StreamBands)
+	{
+		if (Other.Tiles.FirstTile > Band.Tiles.FirstTile) {
+			Other.Tiles.FirstTile -= Band.Tiles.NumTiles;
+		}
+	}
+
+	ActiveArena.TotalInstances -= Band.Slots.Num();
+	Band = FArenaStreamBand();
+}
+
+void ABaseArenaGenerator::ResetStreaming()
+{
+	StopArenaStreaming();
+
+	StreamBands.Empty();
+	FreeStreamSlots.Empty();
+	FreeStreamActors.Empty();
+	StreamInputs.Reset();
+	StreamState = FArenaPlannerState();
+	StreamSectionIdx = 0;
+}
+
+#pragma endregion
+
+#pragma region Navigation
+
+void ABaseArenaGenerator::SetInstanceSetAffectsNavigation(FArenaInstanceSet& Set, bool bAffectsNavigation)
+{
+	//Spawned actors keep the navigation settings of their class
+	FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+
+	auto SetComponent = [bAffectsNavigation](UInstancedStaticMeshComponent* Component)
+	{
+		if (IsValid(Component) && Component->CanEverAffectNavigation() != bAffectsNavigation) {
+			Component->SetCanEverAffectNavigation(bAffectsNavigation);
+		}
+	};
+
+	for (auto& Inst : Set.MeshInstances)
+	{
+		for (auto& Component : Inst) {
+			SetComponent(Component);
+		}
+	}
+
+	for (UInstancedStaticMeshComponent* Component : Set.SinkComponents)
+	{
+		SetComponent(Component);
+	}
+}
+
+FBox ABaseArenaGenerator::GetInstanceSetBounds(const FArenaInstanceSet& Set) const
+{
+	FBox Bounds(ForceInit);
+
+	for (const auto& Inst : Set.MeshInstances)
+	{
+		for (const auto& Component : Inst) {
+			if (IsValid(Component) && Component->GetInstanceCount() > 0) {
+				Bounds += Component->Bounds.GetBox();
+			}
+		}
+	}
+
+	for (const UInstancedStaticMeshComponent* Component : Set.SinkComponents)
+	{
+		if (IsValid(Component) && Component->GetInstanceCount() > 0) {
+			Bounds += Component->Bounds.GetBox();
+		}
+	}
+
+	for (const AActor* Actor : Set.SpawnedActors)
+	{
+		if (IsValid(Actor)) {
+			Bounds += Actor->GetComponentsBoundingBox();
+		}
+	}
+
+	return Bounds;
+}
+
+void ABaseArenaGenerator::SubmitNavigationUpdate(const FBox& Bounds)
+{
+	//Submitted once the queued components can collide, they would be missing from the navmesh otherwise
+	if (!IsArenaCollidable())
+	{
+		PendingNavigationBounds += Bounds;
+		return;
+	}
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!NavSys || !Bounds.IsValid)
+	{
+		//Nothing to wait for, a pending swap goes through right away
+		if (bSwapAwaitingNavigation) {
+			CompleteSwapToNextArena();
+		}
+		return;
+	}
+
+	if (NavigationDirtyChunkSize <= 0.f)
+	{
+		NavSys->AddDirtyArea(Bounds, ENavigationDirtyFlag::All);
+	}
+	else
+	{
+		//Chunks span the full height, the chunk size grows so huge arenas stay under a thousand regions
+		const FVector Size = Bounds.GetSize();
+		float ChunkSize = NavigationDirtyChunkSize;
+		while (FMath::CeilToInt(Size.X / ChunkSize) * FMath::CeilToInt(Size.Y / ChunkSize) > 1024) {
+			ChunkSize *= 2.f;
+		}
+
+		const int32 ChunksX = FMath::Max(FMath::CeilToInt(Size.X / ChunkSize), 1);
+		const int32 ChunksY = FMath::Max(FMath::CeilToInt(Size.Y / ChunkSize), 1);
+
+		for (int32 Y = 0; Y < ChunksY; ++Y)
+		{
+			for (int32 X = 0; X < ChunksX; ++X)
+			{
+				const FVector ChunkMin(Bounds.Min.X + X * ChunkSize, Bounds.Min.Y + Y * ChunkSize, Bounds.Min.Z);
+				const FVector ChunkMax(FMath::Min(ChunkMin.X + ChunkSize, Bounds.Max.X), FMath::Min(ChunkMin.Y + ChunkSize, Bounds.Max.Y), Bounds.Max.Z);
+				NavSys->AddDirtyArea(FBox(ChunkMin, ChunkMax), ENavigationDirtyFlag::All);
+			}
+		}
+	}
+
+	//A rebuild still running is timed from its first submission
+	if (!bNavigationBuildPending)
+	{
+		bNavigationBuildPending = true;
+		bNavigationBuildStarted = false;
+		NavigationBuildStartTime = FPlatformTime::Seconds();
+	}
+
+	NavigationBuildTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickNavigationBuild);
+}
+
+void ABaseArenaGenerator::TickNavigationBuild()
+{
+	if (!bNavigationBuildPending) { return; }
+
+	const double Elapsed = FPlatformTime::Seconds() - NavigationBuildStartTime;
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	const bool bInProgress = NavSys && NavSys->IsNavigationBuildInProgress();
+	bNavigationBuildStarted |= bInProgress;
+
+	//Dirty areas are picked up on the navigation tick, so the build is first waited for to start, then to end
+	if (NavSys && !bNavigationBuildStarted)
+	{
+		if (Elapsed < NavigationBuildTimeout)
+		{
+			NavigationBuildTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickNavigationBuild);
+			return;
+		}
+
+		ArenaGenLog_Warning("Navigation rebuild of the arena did not start within %.1f s, the navmesh may not support runtime generation", Elapsed);
+	}
+	else if (bInProgress)
+	{
+		if (!bSwapAwaitingNavigation || Elapsed < NavigationBuildTimeout)
+		{
+			NavigationBuildTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickNavigationBuild);
+			return;
+		}
+
+		ArenaGenLog_Warning("Navigation of the next arena is still building after %.1f s, swapping anyway", Elapsed);
+	}
+
+	bNavigationBuildPending = false;
+	if (bNavigationBuildStarted && !bInProgress)
+	{
+		LastNavigationBuildSeconds = Elapsed;
+		ArenaGenLog_Info("Navigation rebuilt for the arena in %.1f ms", Elapsed * 1000.0);
+	}
+
+	if (bSwapAwaitingNavigation) {
+		CompleteSwapToNextArena();
+	}
+}
+
+#pragma endregion
+
+#pragma region Physics
+
+void ABaseArenaGenerator::QueueInstanceSetPhysics(FArenaInstanceSet& Set)
+{
+	if (DeferredPhysics.IsEmpty()) { return; }
+
+	const bool bWasEmpty = PhysicsQueue.IsEmpty();
+
+	auto QueueComponent = [this](UInstancedStaticMeshComponent* Component)
+	{
+		if (IsValid(Component) && DeferredPhysics.Contains(Component)) {
+			PhysicsQueue.AddUnique(Component);
+		}
+	};
+
+	for (auto& Inst : Set.MeshInstances)
+	{
+		for (auto& Component : Inst) {
+			QueueComponent(Component);
+		}
+	}
+
+	for (UInstancedStaticMeshComponent* Component : Set.SinkComponents)
+	{
+		QueueComponent(Component);
+	}
+
+	if (bWasEmpty && !PhysicsQueue.IsEmpty())
+	{
+		PhysicsStartTime = FPlatformTime::Seconds();
+		PhysicsTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickPhysicsCreation);
+	}
+}
+
+void ABaseArenaGenerator::TickPhysicsCreation()
+{
+	int32 Budget = PhysicsBodiesPerFrame;
+
+	//Components joining the navmesh as they get collision are applied together
+	{
+		FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+
+		while (Budget > 0 && PhysicsQueueIdx < PhysicsQueue.Num())
+		{
+			const TWeakObjectPtr<UInstancedStaticMeshComponent> Weak = PhysicsQueue[PhysicsQueueIdx++];
+
+			TEnumAsByte<ECollisionEnabled::Type> Collision;
+			if (!DeferredPhysics.RemoveAndCopyValue(Weak, Collision)) { continue; }
+
+			if (UInstancedStaticMeshComponent* Component = Weak.Get())
+			{
+				Component->SetCollisionEnabled(Collision);
+				Budget -= FMath::Max(Component->GetInstanceCount(), 1);
+			}
+		}
+	}
+
+	if (PhysicsQueueIdx < PhysicsQueue.Num())
+	{
+		PhysicsTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ABaseArenaGenerator::TickPhysicsCreation);
+		return;
+	}
+
+	PhysicsQueue.Reset();
+	PhysicsQueueIdx = 0;
+
+	//Components destroyed before they were queued, with a set wiped or released in the meantime
+	for (auto It = DeferredPhysics.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid()) { It.RemoveCurrent(); }
+	}
+
+	ArenaGenLog_Info("Arena is collidable, bodies created over %.1f ms", (FPlatformTime::Seconds() - PhysicsStartTime) * 1000.0);
+	OnArenaCollidable.Broadcast();
+
+	if (PendingNavigationBounds.IsValid)
+	{
+		const FBox Bounds = PendingNavigationBounds;
+		PendingNavigationBounds = FBox(ForceInit);
+		SubmitNavigationUpdate(Bounds);
+	}
+}
+
+#pragma endregion
+
+#pragma region Tile State
+
+void ABaseArenaGenerator::QueryTilesInRadius(const FVector& WorldCenter, float Radius, FName FlagColumn, int32 Mask, TArray<int32>& OutTiles) const
+{
+	//Tiles are stored relative to the generator
+	const FTransform& GeneratorTransform = GetActorTransform();
+	const FVector LocalCenter = GeneratorTransform.InverseTransformPosition(WorldCenter);
+	const float LocalRadius = Radius / FMath::Max(GeneratorTransform.GetScale3D().GetAbsMax(), UE_KINDA_SMALL_NUMBER);
+
+	if (FlagColumn.IsNone())
+	{
+		TileState.QueryRadius(LocalCenter, LocalRadius, OutTiles);
+		return;
+	}
+
+	const int32 ColumnIdx = TileState.FindColumn(FlagColumn);
+	if (ColumnIdx == INDEX_NONE || TileState.GetColumnElementSize(ColumnIdx) != sizeof(uint32))
+	{
+		ArenaGenLog_Warning("No uint32 tile state column named %s", *FlagColumn.ToString());
+		OutTiles.Reset();
+		return;
+	}
+
+	TileState.QueryFlagsInRadius(ColumnIdx, static_cast<uint32>(Mask), LocalCenter, LocalRadius, OutTiles);
+}
+
+FVector ABaseArenaGenerator::GetTileWorldLocation(int32 Tile) const
+{
+	if (Tile < 0 || Tile >= TileState.Num()) { return FVector::ZeroVector; }
+
+	return GetActorTransform().TransformPosition(TileState.GetTileLocation(Tile));
+}
+
+#pragma endregion
+
+#pragma region Annotations
+
+bool ABaseArenaGenerator::SampleSpawnPoint(const FRandomStream& Stream, int32 MinClearance, FVector& OutLocation) const
+{
+	const int32 Point = Annotations.SpawnPoints.Sample(Stream, MinClearance);
+	if (Point == INDEX_NONE) { return false; }
+
+	OutLocation = GetActorTransform().TransformPosition(FVector(Annotations.SpawnPoints.Locations[Point]));
+	return true;
+}
+
+bool ABaseArenaGenerator::SampleCoverPoint(const FRandomStream& Stream, FVector& OutLocation, FVector& OutFacing) const
+{
+	const int32 Point = Annotations.CoverPoints.Sample(Stream);
+	if (Point == INDEX_NONE) { return false; }
+
+	const FTransform& GeneratorTransform = GetActorTransform();
+	OutLocation = GeneratorTransform.TransformPosition(FVector(Annotations.CoverPoints.Locations[Point]));
+	OutFacing = GeneratorTransform.TransformVectorNoScale(FVector(Annotations.CoverPoints.Facing[Point]));
+	return true;
+}
+
+void ABaseArenaGenerator::GetPatrolLoop(int32 LoopIdx, TArray<FVector>& OutPoints) const
+{
+	OutPoints.Reset();
+	if (!Annotations.PatrolLoops.IsValidIndex(LoopIdx)) { return; }
+
+	const FTransform& GeneratorTransform = GetActorTransform();
+	for (const FVector3f& Point : Annotations.PatrolLoops[LoopIdx].Points)
+	{
+		OutPoints.Add(GeneratorTransform.TransformPosition(FVector(Point)));
+	}
+}
+
+#pragma endregion
+
+#pragma region Promotion
+
+void ABaseArenaGenerator::AddPromotionSource(AActor* Source)
+{
+	if (!Source) { return; }
+
+	PromotionSources.AddUnique(Source);
+
+	if (!GetWorldTimerManager().IsTimerActive(PromotionTimerHandle))
+	{
+		GetWorldTimerManager().SetTimer(PromotionTimerHandle, this, &ABaseArenaGenerator::TickProximityPromotion, PromotionInterval, true);
+	}
+}
+
+void ABaseArenaGenerator::RemovePromotionSource(AActor* Source)
+{
+	PromotionSources.Remove(Source);
+}
+
+void ABaseArenaGenerator::TickProximityPromotion()
+{
+	//Stops instead of warning on every update, adding a source restarts it
+	if (!GetMassSink())
+	{
+		ArenaGenLog_Warning("Proximity promotion needs the actor sink to be %s, stopping updates", *FArenaMassSink::SinkName.ToString());
+		GetWorldTimerManager().ClearTimer(PromotionTimerHandle);
+		return;
+	}
+
+	TArray<FVector> SourceLocations;
+	for (int32 i = PromotionSources.Num() - 1; i >= 0; --i)
+	{
+		if (const AActor* Source = PromotionSources[i].Get()) {
+			SourceLocations.Add(Source->GetActorLocation());
+		}
+		else {
+			PromotionSources.RemoveAtSwap(i);
+		}
+	}
+
+	UpdateProximityPromotion(SourceLocations);
+
+	//Updates without sources demote everything, a few tiles per update, then the timer is no longer needed
+	if (PromotionSources.IsEmpty() && !GetMassSink()->HasPromotedTiles()) {
+		GetWorldTimerManager().ClearTimer(PromotionTimerHandle);
+	}
+}
+
+void ABaseArenaGenerator::UpdateProximityPromotion(const TArray<FVector>& SourceLocations)
+{
+	FArenaMassSink* MassSink = GetMassSink();
+	if (!MassSink) {
+		ArenaGenLog_WarningSilent("Proximity promotion needs the actor sink to be %s", *FArenaMassSink::SinkName.ToString());
+		return;
+	}
+
+	//Tiles are stored relative to the generator, so sources are brought into its space instead
+	const FTransform& GeneratorTransform = GetActorTransform();
+	const float Scale = FMath::Max(GeneratorTransform.GetScale3D().GetAbsMax(), UE_KINDA_SMALL_NUMBER);
+
+	TArray<FVector> LocalSources;
+	LocalSources.Reserve(SourceLocations.Num());
+	for (const FVector& Location : SourceLocations)
+	{
+		LocalSources.Add(GeneratorTransform.InverseTransformPosition(Location));
+	}
+
+	MassSink->UpdatePromotion(*this, LocalSources, PromotionRadius / Scale, (PromotionRadius + PromotionHysteresis) / Scale, MaxPromotionsPerUpdate);
+}
+
+#pragma endregion
+
+#pragma region Tile Graph
+
+void ABaseArenaGenerator::SetTileGraph(const FArenaTileGraph& Graph)
+{
+	TileGraph.Reset();
+	if (!Graph.IsEmpty()) {
+		TileGraph = MakeShared<FArenaTileGraph>(Graph);
+	}
+}
+
+void ABaseArenaGenerator::SetActivePlan(const FArenaLayoutPlan& Plan, bool bAppend)
+{
+	//Only tiles are copied, annotations and the graph are already kept on their own
+	TSharedPtr<FArenaLayoutPlan> NewPlan = MakeShared<FArenaLayoutPlan>();
+	if (bAppend && ActivePlan.IsValid()) {
+		NewPlan->Append(*ActivePlan);
+	}
+	NewPlan->Seed = Plan.Seed;
+	NewPlan->Append(Plan);
+
+	ActivePlan = NewPlan;
+}
+
+bool ABaseArenaGenerator::FindTilePath(const FVector& From, const FVector& To, TArray<FVector>& OutPoints) const
+{
+	OutPoints.Reset();
+	if (!TileGraph.IsValid()) { return false; }
+
+	const FTransform& GeneratorTransform = GetActorTransform();
+	if (!TileGraph->FindPathBetween(GeneratorTransform.InverseTransformPosition(From), GeneratorTransform.InverseTransformPosition(To), OutPoints)) { return false; }
+
+	for (FVector& Point : OutPoints)
+	{
+		Point = GeneratorTransform.TransformPosition(Point);
+	}
+	return true;
+}
+
+void ABaseArenaGenerator::FindTilePathAsync(const FVector& From, const FVector& To, TFunction<void(bool, const TArray<FVector>&)>&& OnComplete) const
+{
+	//The worker holds its own reference, the arena may be swapped while it runs
+	Async(EAsyncExecution::ThreadPool, [Graph = TileGraph, GeneratorTransform = GetActorTransform(), From, To, OnComplete = MoveTemp(OnComplete)]() mutable
+	{
+		TArray<FVector> Points;
+		const bool bFound = Graph.IsValid()
+			&& Graph->FindPathBetween(GeneratorTransform.InverseTransformPosition(From), GeneratorTransform.InverseTransformPosition(To), Points);
+
+		for (FVector& Point : Points)
+		{
+			Point = GeneratorTransform.TransformPosition(Point);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [bFound, Points = MoveTemp(Points), OnComplete = MoveTemp(OnComplete)]()
+		{
+			OnComplete(bFound, Points);
+		});
+	});
+}
+
+void ABaseArenaGenerator::BuildFlowFieldAsync(const TArray<FVector>& Goals, TFunction<void(TSharedPtr<const FArenaFlowField>)>&& OnComplete) const
+{
+	Async(EAsyncExecution::ThreadPool, [Graph = TileGraph, GeneratorTransform = GetActorTransform(), Goals, OnComplete = MoveTemp(OnComplete)]() mutable
+	{
+		TSharedPtr<FArenaFlowField> Field;
+		if (Graph.IsValid())
+		{
+			TArray<int32> GoalNodes;
+			for (const FVector& Goal : Goals)
+			{
+				GoalNodes.AddUnique(Graph->FindNearestNode(GeneratorTransform.InverseTransformPosition(Goal)));
+			}
+
+			Field = MakeShared<FArenaFlowField>();
+			Graph->BuildFlowField(GoalNodes, *Field);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [Field, OnComplete = MoveTemp(OnComplete)]()
+		{
+			OnComplete(Field);
+		});
+	});
+}
+
+#pragma endregion
+
+#pragma region Minimap
+
+void ABaseArenaGenerator::RasterizeLayout(int32 Seed, int32 Resolution, FArenaLayoutRaster& OutRaster) const
+{
+	const FArenaLayoutInputs Inputs = GatherLayoutInputs();
+	FArenaLayoutPlanner Planner(Inputs, FRandomStream(Seed));
+
+	FArenaLayoutPlan Plan;
+	Planner.PlanLayout(Plan);
+
+	FArenaLayoutRaster::Rasterize(Plan, Inputs, Resolution, OutRaster);
+}
+
+void ABaseArenaGenerator::RasterizeActiveArena(int32 Resolution, FArenaLayoutRaster& OutRaster) const
+{
+	OutRaster.Reset();
+	if (!ActivePlan.IsValid()) { return; }
+
+	//The stream keeps advancing between generations, replanning from the seed would not give back the arena in play
+	FArenaLayoutRaster::Rasterize(*ActivePlan, GatherLayoutInputs(), Resolution, OutRaster);
+}
+
+UTexture2D* ABaseArenaGenerator::CreateMinimapTexture(int32 Resolution) const
+{
+	FArenaLayoutRaster Raster;
+	RasterizeActiveArena(Resolution, Raster);
+
+	if (Raster.IsEmpty()) {
+		ArenaGenLog_Warning("Cannot create a minimap, the active arena has no planned mesh tiles.");
+		return nullptr;
+	}
+
+	return Raster.CreateTexture();
+}
+
+#pragma endregion
+
+#pragma region Ground Snapping
+
+bool ABaseArenaGenerator::IsSnappingToGround() const
+{
+	for (const FArenaGroundSnapPass& Pass : GroundSnapPasses)
+	{
+		if (Pass.IsActive()) { return true; }
+	}
+	return false;
+}
+
+bool ABaseArenaGenerator::StartGroundSnap(FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, EArenaGroundSnapTarget Target, bool bUpdateInPlace)
+{
+	CancelGroundSnap(Target);
+
+	UWorld* World = GetWorld();
+	if (!World) { return false; }
+
+	TArray<FArenaGroundColumn> Columns;
+	FArenaGroundSnap::GatherColumns(Plan, Inputs, Columns);
+	if (Columns.IsEmpty()) { return false; }
+
+	//The arena itself is not ground, whether it is being replaced or not
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ArenaGroundSnap), false, this);
+	QueryParams.AddIgnoredActors(ActiveArena.SpawnedActors);
+
+	//Columns only move up to the max adjustment, so traces do not look further
+	const FTransform& GeneratorTransform = GetActorTransform();
+	const FVector Reach(0, 0, FMath::Max(GroundSnapMaxAdjust, 1.f));
+
+	if (bBlockingGroundSnap || IsRunningCommandlet())
+	{
+		for (FArenaGroundColumn& Column : Columns)
+		{
+			FHitResult Hit;
+			if (World->LineTraceSingleByChannel(Hit, GeneratorTransform.TransformPosition(Column.Location + Reach), GeneratorTransform.TransformPosition(Column.Location - Reach), GroundTraceChannel, QueryParams))
+			{
+				Column.Offset = GeneratorTransform.InverseTransformPosition(Hit.ImpactPoint).Z - Column.Location.Z;
+				Column.bHit = true;
+			}
+		}
+
+		const int32 NumMoved = ApplyGroundColumns(Plan, Inputs, Columns);
+		const int32 NumHits = Algo::CountIf(Columns, [](const FArenaGroundColumn& Column) { return Column.bHit; });
+		ArenaGenLog_Info("Snapped %d tiles to the ground, %d of %d columns found ground", NumMoved, NumHits, Columns.Num());
+		return false;
+	}
+
+	FArenaGroundSnapPass& Pass = GroundSnapPasses[(int32)Target];
+	if (!Pass.TraceDelegate.IsBound()) {
+		Pass.TraceDelegate.BindUObject(this, &ABaseArenaGenerator::OnGroundTraceDone, Target);
+	}
+
+	Pass.Plan = MakeShared<FArenaLayoutPlan>(Plan);
+	Pass.Inputs = MakeShared<FArenaLayoutInputs>(Inputs);
+	Pass.Columns = MoveTemp(Columns);
+	Pass.bInPlace = bUpdateInPlace;
+
+	//All traces are issued in the same frame and batched by the world, results arrive on the next one
+	Pass.Traces.SetNum(Pass.Columns.Num());
+	for (int32 ColumnIdx = 0; ColumnIdx < Pass.Columns.Num(); ++ColumnIdx)
+	{
+		const FVector& Location = Pass.Columns[ColumnIdx].Location;
+		Pass.Traces[ColumnIdx] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
+			GeneratorTransform.TransformPosition(Location + Reach), GeneratorTransform.TransformPosition(Location - Reach),
+			GroundTraceChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam, &Pass.TraceDelegate, ColumnIdx);
+	}
+	Pass.PendingTraces = Pass.Columns.Num();
+
+	ArenaGenLog_InfoSilent("Snapping %d tile columns to the ground", Pass.Columns.Num());
+	return true;
+}
+
+void ABaseArenaGenerator::OnGroundTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum, EArenaGroundSnapTarget Target)
+{
+	FArenaGroundSnapPass& Pass = GroundSnapPasses[(int32)Target];
+
+	const int32 ColumnIdx = static_cast<int32>(Datum.UserData);
+	if (!Pass.Traces.IsValidIndex(ColumnIdx) || !(Pass.Traces[ColumnIdx] == Handle)) { return; }
+
+	//Each trace only reports once
+	Pass.Traces[ColumnIdx] = FTraceHandle();
+
+	const FHitResult* Hit = Datum.OutHits.FindByPredicate([](const FHitResult& Result) { return Result.bBlockingHit; });
+	if (Hit)
+	{
+		FArenaGroundColumn& Column = Pass.Columns[ColumnIdx];
+		Column.Offset = GetActorTransform().InverseTransformPosition(Hit->ImpactPoint).Z - Column.Location.Z;
+		Column.bHit = true;
+	}
+
+	if (--Pass.PendingTraces > 0) { return; }
+
+	FinishGroundSnap(Target);
+}
+
+void ABaseArenaGenerator::FinishGroundSnap(EArenaGroundSnapTarget Target)
+{
+	FArenaGroundSnapPass& Pass = GroundSnapPasses[(int32)Target];
+	TSharedPtr<FArenaLayoutPlan> Plan = MoveTemp(Pass.Plan);
+	TSharedPtr<const FArenaLayoutInputs> Inputs = MoveTemp(Pass.Inputs);
+	TArray<FArenaGroundColumn> Columns = MoveTemp(Pass.Columns);
+	const bool bInPlace = Pass.bInPlace;
+	CancelGroundSnap(Target);
+
+	if (!Plan.IsValid() || !Inputs.IsValid()) { return; }
+
+	const int32 NumMoved = ApplyGroundColumns(*Plan, *Inputs, Columns);
+	const int32 NumHits = Algo::CountIf(Columns, [](const FArenaGroundColumn& Column) { return Column.bHit; });
+
+	switch (Target)
+	{
+		case EArenaGroundSnapTarget::NextArena:
+		{
+			ArenaGenLog_InfoSilent("Snapped %d tiles of the next arena to the ground, %d of %d columns found ground", NumMoved, NumHits, Columns.Num());
+
+			NextArenaPlan = Plan;
+			QueueCommit(*Plan, NextArena, NextArenaQueue);
+			TickNextArenaPreparation();
+		}break;
+
+		case EArenaGroundSnapTarget::StreamBand:
+		{
+			ArenaGenLog_InfoSilent("Snapped %d tiles of a band to the ground, %d of %d columns found ground", NumMoved, NumHits, Columns.Num());
+
+			AddStreamBand(*Plan, MoveTemp(SnappingStreamBand));
+			SnappingStreamBand = FArenaStreamBand();
+		}break;
+
+		default:
+		case EArenaGroundSnapTarget::ActiveArena:
+		{
+			if (bInPlace) {
+				UpdateActiveArena(*Plan);
+			}
+			else {
+				CommitPlan(*Plan, ActiveArena);
+			}
+
+			ArenaGenLog_Info("Snapped %d tiles to the ground, %d of %d columns found ground, # of Instances: %d", NumMoved, NumHits, Columns.Num(), ActiveArena.TotalInstances);
+
+			OnArenaGroundSnapped.Broadcast();
+		}break;
+	}
+}
+
+int32 ABaseArenaGenerator::ApplyGroundColumns(FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, TConstArrayView<FArenaGroundColumn> Columns)
+{
+	const int32 NumMoved = FArenaGroundSnap::ApplyColumns(Plan, Inputs, Columns);
+
+	//Annotations and the graph were built from the tiles before they moved
+	if (NumMoved > 0)
+	{
+		if (Inputs.bBuildAnnotations) {
+			FArenaLayoutPlanner::BuildAnnotations(Plan, Inputs, Plan.Annotations);
+		}
+		if (Inputs.bBuildTileGraph) {
+			FArenaTileGraph::Build(Plan, Inputs, Plan.TileGraph);
+		}
+	}
+
+	return NumMoved;
+}
+
+void ABaseArenaGenerator::CancelGroundSnap(EArenaGroundSnapTarget Target)
+{
+	FArenaGroundSnapPass& Pass = GroundSnapPasses[(int32)Target];
+	Pass.Plan.Reset();
+	Pass.Inputs.Reset();
+	Pass.Columns.Reset();
+	Pass.Traces.Reset();
+	Pass.PendingTraces = 0;
+}
+
+void ABaseArenaGenerator::CancelGroundSnaps()
+{
+	for (int32 TargetIdx = 0; TargetIdx < (int32)EArenaGroundSnapTarget::Num; ++TargetIdx)
+	{
+		CancelGroundSnap((EArenaGroundSnapTarget)TargetIdx);
+	}
+	SnappingStreamBand = FArenaStreamBand();
+}
+
+#pragma endregion
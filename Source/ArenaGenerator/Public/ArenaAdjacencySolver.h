@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "ArenaGeneratorTypes.h"
+
+/* Arena Adjacency Solver
+* Picks a mesh for every cell of a lattice plane so that neighbors follow adjacency rules, in the style of
+* wave function collapse. Domains are 64-bit masks of the meshes still possible for a cell, and the meshes
+* supported by a domain are read from per-byte lookup tables, so propagation costs a few ORs per neighbor.
+* Independent from UObjects and deterministic for a given seed.
+*/
+
+struct ARENAGENERATOR_API FArenaAdjacencyRules
+{
+	static constexpr int32 MaxMeshes = 64;
+
+	int32 NumMeshes = 0;
+
+	//Meshes allowed in each direction of each mesh, [Direction][Mesh]. Directions are North, East, South, West.
+	TArray<uint64> Allowed[4];
+
+	TArray<float> Weights;
+
+	//Rules of a group's meshes. False if the group has no meshes or more than MaxMeshes.
+	bool BuildFromGroup(const FArenaMeshGroupConfig& Group);
+};
+
+struct ARENAGENERATOR_API FArenaAdjacencyResult
+{
+	//Mesh of each cell, Row * Columns + Column. Empty if no attempt was solved.
+	TArray<int32> Meshes;
+
+	int32 Attempts = 0;
+	int32 Contradictions = 0;
+	double Seconds = 0.0;
+
+	bool IsSolved() const { return !Meshes.IsEmpty(); }
+};
+
+class ARENAGENERATOR_API FArenaAdjacencySolver
+{
+public:
+	explicit FArenaAdjacencySolver(const FArenaAdjacencyRules& InRules);
+
+	//Solves a Columns x Rows plane, restarting with the next seed after a contradiction
+	void Solve(int32 Columns, int32 Rows, int32 Seed, int32 MaxAttempts, FArenaAdjacencyResult& OutResult);
+
+private:
+	struct FCellEntropy
+	{
+		float Entropy = 0.f;
+		int32 Count = 0;
+		int32 Cell = 0;
+
+		bool operator<(const FCellEntropy& Other) const { return Entropy < Other.Entropy; }
+	};
+
+	//One attempt, false on contradiction
+	bool Attempt(FRandomStream& Stream);
+
+	//Narrows neighbors of the cells on the propagation stack until nothing changes, false on contradiction
+	bool Propagate(FRandomStream& Stream);
+
+	//Meshes allowed in a direction next to any mesh of a domain
+	uint64 GetSupport(int32 Direction, uint64 Domain) const;
+
+	int32 PickMesh(uint64 Domain, FRandomStream& Stream) const;
+
+	void PushEntropy(int32 Cell, uint64 Domain, FRandomStream& Stream);
+
+	const FArenaAdjacencyRules& Rules;
+	int32 NumChunks = 0;
+
+	//Support of every byte of a domain, [Direction][Chunk * 256 + Byte]
+	TArray<uint64> SupportTables[4];
+
+	int32 Columns = 0;
+	int32 Rows = 0;
+	TArray<uint64> Domains;
+	TArray<int32> PropagationStack;
+	TArray<FCellEntropy> EntropyHeap;
+};
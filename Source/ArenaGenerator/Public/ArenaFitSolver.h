@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "ArenaGeneratorTypes.h"
+#include "ArenaFitSolver.generated.h"
+
+/* Arena Fit Solver
+* Solves section parameters (sides, grid dimensions, tiles per side) so that wall tiles fit
+* on every side of the polygon and the arena stays within a tile budget.
+* Closed-form bounds followed by at most a few verification steps per query. When a tile budget applies,
+* a binary search on the lead parameter adds a number of evaluations logarithmic in the lead.
+*/
+struct ARENAGENERATOR_API FArenaFitSolver
+{
+	//Solves one parameter set, following the same formulas as section planning
+	static FArenaFitResult Solve(const FArenaFitInputs& Inputs);
+
+	//Solves many parameter sets in parallel. OutResults matches Inputs order.
+	static void SolveBatch(TArrayView<const FArenaFitInputs> Inputs, TArrayView<FArenaFitResult> OutResults);
+
+	//Geometry for a number of sides and a value of the lead parameter of the build order rules, without any adjustment
+	static FArenaFitResult Evaluate(const FArenaFitInputs& Inputs, int32 Sides, int32 Lead);
+
+	//Lead parameter requested by the targets: grid dimensions for grid rules, tiles per side for polygon rules
+	static int32 GetTargetLead(const FArenaFitInputs& Inputs, int32 Sides);
+
+	//Most sides a polygon of this vertex radius can have with TilesPerSide wall tiles on each side. 0 if not even a triangle fits.
+	static int32 MaxSidesForRadius(float Radius, float TileSize, int32 MaxSides, int32 TilesPerSide = 1);
+
+	//Smallest vertex radius giving sides long enough for TilesPerSide wall tiles
+	static float MinRadiusForSides(int32 Sides, float TileSize, int32 TilesPerSide = 1);
+
+	//Interior angle as computed by section planning
+	static float InteriorAngleForSides(int32 Sides);
+
+private:
+
+	//Smallest lead value for which wall tiles fit on the sides
+	static int32 MinFittingLead(const FArenaFitInputs& Inputs, int32 Sides);
+};
+
+UCLASS()
+class ARENAGENERATOR_API UArenaFitSolverLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	//Solves sides, grid dimensions and tiles per side so wall tiles fit and the tile budget is respected
+	UFUNCTION(BlueprintPure, Category = "Arena | Fit")
+	static FArenaFitResult SolveArenaFit(const FArenaFitInputs& Inputs);
+
+	//Solves every parameter set in parallel
+	UFUNCTION(BlueprintCallable, Category = "Arena | Fit")
+	static void SolveArenaFitBatch(const TArray<FArenaFitInputs>& Inputs, TArray<FArenaFitResult>& OutResults);
+
+	UFUNCTION(BlueprintPure, Category = "Arena | Fit")
+	static int32 MaxSidesForRadius(float Radius, float TileSize, int32 MaxSides = 120, int32 TilesPerSide = 1);
+
+	UFUNCTION(BlueprintPure, Category = "Arena | Fit")
+	static float MinRadiusForSides(int32 Sides, float TileSize, int32 TilesPerSide = 1);
+};
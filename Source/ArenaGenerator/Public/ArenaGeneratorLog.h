@@ -66,3 +66,7 @@ bool ShowLogsOnScreen(float& Duration);
 // Logs error message to output and on screen
 #define ArenaGenLog_Error(Format, ...) \
 	_ArenaGenLog_PrivateImpl(true, FColor::Red, Error, Format, ##__VA_ARGS__)
+
+// Logs error message *only* to output. Safe to use off the game thread.
+#define ArenaGenLog_ErrorSilent(Format, ...) \
+	_ArenaGenLog_PrivateImpl(false, FColor::Red, Error, Format, ##__VA_ARGS__)
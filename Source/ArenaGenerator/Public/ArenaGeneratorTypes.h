@@ -61,8 +61,10 @@ enum class EOriginPlacementType : uint8
 	X_Positive_Y_Negative,
 	X_Negative_Y_Positive,
 	Center,
-	//Custom, // TODO - add behavior for custom origins
-	//...
+	//Pivot to center offset measured from the mesh's bounds
+	FromMeshBounds,
+	//Pivot to center offset set on the mesh
+	Custom,
 };
 
 /*
@@ -95,9 +97,141 @@ enum class ETypeToPlace : uint8
 	StaticMeshes,
 	Actors,
 };
+
+/*
+* Where baked arena data is stored when a generator is baked at cook time.
+* Level = serialized on the generator actor itself,
+* SidecarAsset = saved in a separate Arena Baked Layout asset next to the map.
+*/
+UENUM(BlueprintType)
+enum class EArenaBakeTarget : uint8
+{
+	Level,
+	SidecarAsset,
+};
+
+/*
+* Noise used by warp fields to offset placement coherently.
+* Value = smooth interpolation of random lattice values, blocky at low octaves,
+* Perlin = gradient noise, Simplex = gradient noise on a simplex lattice, fewer directional artifacts.
+*/
+UENUM(BlueprintType)
+enum class EArenaWarpNoiseType : uint8
+{
+	None,
+	Value,
+	Perlin,
+	Simplex,
+};
+
+/*
+* How a section is fixed when its wall tiles do not fit on the polygon sides.
+* ReduceSides = keep the arena size and use fewer, longer sides,
+* GrowArena = keep the sides and increase the radius and grid dimensions.
+*/
+UENUM(BlueprintType)
+enum class EArenaFitResolution : uint8
+{
+	ReduceSides,
+	GrowArena,
+};
+
+//Order of arena variants returned by a parameter sweep
+UENUM(BlueprintType)
+enum class EArenaVariantSort : uint8
+{
+	Instances,
+	Radius,
+	Sides,
+	TilesPerSide,
+};
+
+/*
+* How a carve volume selects the tiles it removes.
+* LatticeRange = ranges of lattice coordinates: polygon side, position along the side and height band, or grid repetition, column and row,
+* Box = box relative to the generator, converted to lattice ranges when a pattern is planned.
+*/
+UENUM(BlueprintType)
+enum class EArenaCarveShape : uint8
+{
+	LatticeRange,
+	Box,
+};
 #pragma endregion
 
 #pragma region Structs
+//Extra mesh of a composite tile, instanced with the tile's mesh on every tile
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaSubMesh
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UStaticMesh* Mesh = nullptr;
+
+	//Relative to the transform of the tile's mesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FTransform RelativeTransform;
+};
+
+/*
+* Mesh and yaw picked for a tile from which of its 8 neighbors are occupied.
+* Neighbor bits from bit 0: N, NE, E, SE, S, SW, W, NW. N is the next row of the lattice, E the next column.
+* Grids: rows run along the generator's x axis, columns along y. Polygons: columns run along the sides, rows up the height bands.
+*/
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaAutoTileRule
+{
+	GENERATED_BODY()
+
+	//Neighbor bits that must be occupied
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "255"))
+	int32 Occupied = 0;
+
+	//Neighbor bits compared against Occupied, the others can be anything
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "255"))
+	int32 CompareMask = 255;
+
+	//Index into the group's meshes, -1 keeps the tile's mesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "-1"))
+	int32 MeshIndex = -1;
+
+	//Added to the tile's yaw, the mesh turns around its center
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Yaw = 0.f;
+
+	//Also matches the rule turned by 90, 180 and 270 degrees of yaw, adding that turn. Meant for grids.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bMatchRotations = false;
+};
+
+/*
+* Meshes accepted next to a mesh by the adjacency solver, as indices into the group's meshes.
+* Two meshes can be neighbors only if both accept each other. An empty list accepts any mesh.
+* North is the next row of the lattice, East the next column, same as autotile rules.
+*/
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaMeshAdjacency
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<int32> North;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<int32> East;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<int32> South;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<int32> West;
+
+	//Relative chance of the mesh being picked among the ones still possible for a tile
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	float Weight = 1.f;
+};
+
 USTRUCT(BlueprintType)
 struct ARENAGENERATOR_API FArenaMesh : public FTableRowBase
 {
@@ -108,6 +242,18 @@ struct ARENAGENERATOR_API FArenaMesh : public FTableRowBase
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	UStaticMesh* Mesh = nullptr;
+
+	//Offset from the mesh's pivot to its center in mesh space, used by the Custom origin type
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "OriginType == EOriginPlacementType::Custom", EditConditionHides))
+	FVector CustomPivotToCenter = FVector(0);
+
+	//Makes this a composite tile. Sub meshes are instanced in their own components, no actors are spawned.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FArenaSubMesh> SubMeshes;
+
+	//Neighbors allowed by the adjacency solver, used when the group solves adjacency
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FArenaMeshAdjacency Adjacency;
 };
 
 USTRUCT(BlueprintType)
@@ -115,15 +261,40 @@ struct ARENAGENERATOR_API FArenaMeshGroupConfig : public FTableRowBase
 {
 	GENERATED_BODY()
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "!bDimensionsFromMeshBounds"))
 	FVector MeshDimensions = FVector{ 500, 500, 500 };
 
+	//Measures MeshDimensions from the bounds of the group's meshes. The largest mesh sets the tile size.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bDimensionsFromMeshBounds = false;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FVector MeshScale = FVector{ 1 };
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TArray<FArenaMesh> GroupMeshes;
 
+	//Picks the mesh of each tile so every pair of neighbors follows the meshes' adjacency rules. Groups are limited to 64 meshes.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSolveAdjacency = false;
+
+	//Restarts with a new seed after a contradiction, up to this many attempts. Tiles keep their planned mesh if all fail.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bSolveAdjacency", ClampMin = "1"))
+	int32 AdjacencyAttempts = 8;
+
+	//Picks the mesh and yaw of each tile from its neighbors once a pattern is planned. Polygon sides see each other across seams.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bAutoTile = false;
+
+	//First matching rule wins, tiles matching none are left as planned
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bAutoTile"))
+	TArray<FArenaAutoTileRule> AutoTileRules;
+
+	//Meshes in component order: every group mesh, then the sub meshes of each composite in order
+	void GetComponentMeshes(TArray<UStaticMesh*>& OutMeshes) const;
+
+	//Component index of the first sub mesh of each group mesh
+	void GetSubMeshSlots(TArray<int32>& OutFirstSlots) const;
 };
 
 USTRUCT(BlueprintType)
@@ -139,6 +310,45 @@ struct ARENAGENERATOR_API FArenaActorConfig : public FTableRowBase
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TArray<TSubclassOf<AActor>> ClassesToSpawn;
+
+	//Mesh drawn for each tile of this group while it is a Mass entity and not promoted to an actor
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UStaticMesh* EntityProxyMesh = nullptr;
+};
+
+//Coherent noise field offsetting placement. Sampled at each tile's position so neighbouring tiles warp alike.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaWarpField
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EArenaWarpNoiseType NoiseType = EArenaWarpNoiseType::None;
+
+	//Maximum offset per axis. For polygons this is along forward = x, right = y, up = z vectors of the side.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Amplitude = FVector(0.f, 0.f, 100.f);
+
+	//Noise cycles per unit of distance. 0.001 gives features about 1000 units wide.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	float Frequency = 0.001f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1", ClampMax = "8"))
+	int32 Octaves = 3;
+
+	//Frequency multiplier of each octave
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	float Lacunarity = 2.f;
+
+	//Amplitude multiplier of each octave
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "1"))
+	float Persistence = 0.5f;
+
+	//Added to the arena seed so patterns can use different fields
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SeedOffset = 0;
+
+	bool IsEnabled() const { return NoiseType != EArenaWarpNoiseType::None && !Amplitude.IsNearlyZero(); }
 };
 
 USTRUCT(BlueprintType)
@@ -197,6 +407,10 @@ struct ARENAGENERATOR_API FArenaSectionBuildRules : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Warping")
 		float WarpConcavityStrength = 0.f;
 
+	// Coherent noise warping, replaces the random warp range when enabled. Applied on top of concavity.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Warping")
+		FArenaWarpField WarpField;
+
 	//OFFSET PARAMS
 
 	//How many times should we multiply the right vector of the placement direction by the mesh size
@@ -218,6 +432,11 @@ struct ARENAGENERATOR_API FArenaSectionBuildRules : public FTableRowBase
 	//height increment by in relation to its mesh height. Default is 1.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Offsets")
 		float OffsetByHeightIncrement = 1.f;
+
+	//When duplicate tiles are removed, tiles of this pattern are kept over coincident tiles of lower priority patterns.
+	//Equal priorities keep the tile planned first.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Offsets")
+		int32 DuplicatePriority = 0;
 	
 };
 
@@ -238,6 +457,46 @@ struct ARENAGENERATOR_API FArenaSectionTargets : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int32 TargetGridDimensions = 15;
 
+	//What to change when wall tiles do not fit on the sides of the polygon
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EArenaFitResolution FitResolution = EArenaFitResolution::ReduceSides;
+
+	//Maximum grid tiles plus wall tiles of one row. The lead parameter of the build order rules is reduced to fit. 0 = unlimited.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 TileBudget = 0;
+
+};
+
+//Opening in a section, such as a doorway. Carved tiles are never planned.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaCarveVolume
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EArenaCarveShape Shape = EArenaCarveShape::LatticeRange;
+
+	//Build rule of the section to carve, -1 carves every build rule
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "-1"))
+	int32 PatternIdx = INDEX_NONE;
+
+	//Inclusive ranges of polygon sides or grid repetitions. A negative end runs to the last one.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "Shape == EArenaCarveShape::LatticeRange"))
+	FIntPoint Slices = FIntPoint(0, -1);
+
+	//Inclusive ranges of positions along a polygon side or grid columns. A negative end runs to the last one.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "Shape == EArenaCarveShape::LatticeRange"))
+	FIntPoint Columns = FIntPoint(0, -1);
+
+	//Inclusive ranges of polygon height bands or grid rows. A negative end runs to the last one.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "Shape == EArenaCarveShape::LatticeRange"))
+	FIntPoint Rows = FIntPoint(0, -1);
+
+	//Relative to the generator. Carves tiles whose lattice cell has its middle inside, warping is not taken into account.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "Shape == EArenaCarveShape::Box"))
+	FBox Box = FBox(FVector(-100.f), FVector(100.f));
+
+	bool AppliesTo(int32 InPatternIdx) const { return PatternIdx == INDEX_NONE || PatternIdx == InPatternIdx; }
 };
 
 USTRUCT(BlueprintType)
@@ -253,6 +512,346 @@ struct ARENAGENERATOR_API FArenaSection : public FTableRowBase
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TArray<FArenaSectionBuildRules> BuildRules;
+
+	//Openings removed from the section's patterns while they are planned
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FArenaCarveVolume> CarveVolumes;
+
+	//Moves floor columns and the bottom of walls onto the ground under the generator before the section is committed, prepared or streamed.
+	//Traces are async and the section is committed a frame later, except while baking where they block.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSnapToGround = false;
+};
+
+//Parameters of an arena fit query. Mirrors a section's targets with the sizes of its focus meshes.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaFitInputs
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EArenaBuildOrderRules BuildOrderRules = EArenaBuildOrderRules::PolygonLeadByRadius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FArenaSectionTargets Targets;
+
+	//X size of the focus grid mesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float GridTileSize = 500.f;
+
+	//X size of the focus polygon mesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float WallTileSize = 500.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxSides = 120;
+
+	//Clamps wall tiles per side when the grid leads, as section planning does. Polygon lead targets are used as they are.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxTilesPerSideRow = 100;
+};
+
+//Arena parameters satisfying the fit constraints.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaFitResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 ArenaSides = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 ArenaDimensions = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 TilesPerArenaSide = 0;
+
+	//Radius of the vertices of the polygon
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float InscribedRadius = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Apothem = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float SideLength = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float InteriorAngle = 0.f;
+
+	//Grid tiles plus wall tiles of one row
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumTiles = 0;
+
+	//Whether sides, dimensions or tiles per side differ from the targets
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bAdjusted = false;
+
+	//Whether wall tiles fit on every side
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bWallsFit = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bWithinBudget = true;
+};
+
+/*
+* Parameter grid evaluated by a sweep. Every combination of sides, tiles per side, target radius
+* and focus mesh groups is applied to the base section, then filtered and sorted.
+*/
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaParameterSweep
+{
+	GENERATED_BODY()
+
+	//Section the swept parameters are applied to
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep")
+	FArenaSection BaseSection;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep", meta = (ClampMin = "3"))
+	int32 SidesMin = 3;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep", meta = (ClampMin = "3"))
+	int32 SidesMax = 12;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep", meta = (ClampMin = "1"))
+	int32 TilesPerSideMin = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep", meta = (ClampMin = "1"))
+	int32 TilesPerSideMax = 8;
+
+	//Target radius range. A step of 0 keeps the base section's target radius.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep", meta = (ClampMin = "0"))
+	float RadiusMin = 1000.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep", meta = (ClampMin = "0"))
+	float RadiusMax = 5000.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep", meta = (ClampMin = "0"))
+	float RadiusStep = 0.f;
+
+	//Mesh groups tried on polygon patterns. Empty keeps the base section's groups.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep")
+	TArray<int32> PolygonGroups;
+
+	//Mesh groups tried on grid patterns. Empty keeps the base section's groups.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sweep")
+	TArray<int32> GridGroups;
+
+	//Variants with more mesh instances plus actors are discarded. 0 = unlimited.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Filters", meta = (ClampMin = "0"))
+	int32 MaxInstances = 0;
+
+	//Range of the solved vertex radius. A max of 0 = unlimited.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Filters", meta = (ClampMin = "0"))
+	float MinResultRadius = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Filters", meta = (ClampMin = "0"))
+	float MaxResultRadius = 0.f;
+
+	//Discard variants the fit solver had to adjust
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Filters")
+	bool bOnlyUnadjusted = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Results")
+	EArenaVariantSort SortBy = EArenaVariantSort::Instances;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Results")
+	bool bSortDescending = false;
+
+	//Maximum number of variants returned after sorting. 0 = all.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Results", meta = (ClampMin = "0"))
+	int32 MaxResults = 1000;
+};
+
+//One evaluated combination of a parameter sweep.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaVariant
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 TargetSides = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 TargetTilesPerSide = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float TargetRadius = 0.f;
+
+	//Group used by polygon and grid patterns, INDEX_NONE when the base section's groups were kept
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PolygonGroup = INDEX_NONE;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 GridGroup = INDEX_NONE;
+
+	//Solved section parameters
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FArenaFitResult Fit;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PredictedInstances = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PredictedActors = 0;
+};
+
+//Floor locations usable as spawn points, relative to the generator. Sorted by clearance, largest first.
+USTRUCT()
+struct ARENAGENERATOR_API FArenaSpawnPoints
+{
+	GENERATED_BODY()
+
+	//On top of the floor tile, at its center
+	UPROPERTY(VisibleAnywhere)
+	TArray<FVector3f> Locations;
+
+	//Tiles from the point to the nearest missing floor tile or floor edge. 1 = edge tile.
+	UPROPERTY(VisibleAnywhere)
+	TArray<uint16> Clearance;
+
+	//Number of points with a clearance of at least the index
+	UPROPERTY(VisibleAnywhere)
+	TArray<int32> NumWithClearance;
+
+	int32 Num() const { return Locations.Num(); }
+
+	//Uniform random point with at least MinClearance tiles of clearance, INDEX_NONE if there is none. Constant time.
+	int32 Sample(const FRandomStream& Stream, int32 MinClearance = 1) const;
+};
+
+//Positions against the walls, relative to the generator
+USTRUCT()
+struct ARENAGENERATOR_API FArenaCoverPoints
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere)
+	TArray<FVector3f> Locations;
+
+	//Unit direction from the point toward the wall it is covered by
+	UPROPERTY(VisibleAnywhere)
+	TArray<FVector3f> Facing;
+
+	int32 Num() const { return Locations.Num(); }
+
+	//Uniform random point, INDEX_NONE if there is none. Constant time.
+	int32 Sample(const FRandomStream& Stream) const;
+};
+
+//Closed loop of points around the inside of a polygon ring, one per side, relative to the generator
+USTRUCT()
+struct ARENAGENERATOR_API FArenaPatrolLoop
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere)
+	TArray<FVector3f> Points;
+};
+
+//Gameplay locations derived from a plan, so game code does not have to trace the arena to find them.
+USTRUCT()
+struct ARENAGENERATOR_API FArenaAnnotations
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere)
+	FArenaSpawnPoints SpawnPoints;
+
+	UPROPERTY(VisibleAnywhere)
+	FArenaCoverPoints CoverPoints;
+
+	UPROPERTY(VisibleAnywhere)
+	TArray<FArenaPatrolLoop> PatrolLoops;
+
+	bool IsEmpty() const { return SpawnPoints.Num() == 0 && CoverPoints.Num() == 0 && PatrolLoops.IsEmpty(); }
+
+	void Reset();
+
+	SIZE_T GetAllocatedSize() const;
+};
+
+//All instances of one mesh of a generated arena, relative to the generator.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaBakedMeshInstances
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UStaticMesh* Mesh = nullptr;
+
+	//Mesh group the instances were generated from
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 GroupIndex = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 MeshIndex = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<FTransform> Transforms;
+};
+
+//One actor of a generated arena, relative to the generator.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaBakedActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TSubclassOf<AActor> ActorClass;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FTransform Transform;
+};
+
+//Summary of a generated layout, used to pick and budget layouts without loading them.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaLayoutStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumMeshInstances = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumActors = 0;
+
+	//Bounds of all instance and actor origins, relative to the generator
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FBox Bounds = FBox(ForceInit);
+
+	//Size of the baked layout data in bytes
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int64 MemoryBytes = 0;
+};
+
+//Result of a generation pass, stored so the arena can be restored without building sections.
+USTRUCT(BlueprintType)
+struct ARENAGENERATOR_API FArenaBakedLayout
+{
+	GENERATED_BODY()
+
+	//Seed the layout was generated with
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Seed = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<FArenaBakedMeshInstances> MeshInstances;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<FArenaBakedActor> Actors;
+
+	UPROPERTY(VisibleAnywhere)
+	FArenaAnnotations Annotations;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FArenaLayoutStats Stats;
+
+	bool IsValid() const { return !MeshInstances.IsEmpty() || !Actors.IsEmpty(); }
+
+	//Recalculates Stats from the layout contents
+	void UpdateStats();
 };
 #pragma endregion
 
@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FArenaLayoutPlan;
+struct FArenaLayoutInputs;
+struct FArenaPlannedPattern;
+struct FArenaTileCoord;
+
+//One ground trace of a snapping pass, shared by every tile of a lattice column
+struct ARENAGENERATOR_API FArenaGroundColumn
+{
+	//Index into the plan's patterns
+	int32 PlanPattern = 0;
+
+	//Lattice column within the pattern, see FArenaGroundSnap::GetColumnIdx
+	int32 ColumnIdx = 0;
+
+	//Center of the bottom of the column's lowest tile, relative to the generator. Traces go through it.
+	FVector Location = FVector(0.f);
+
+	//Height change found by the trace, relative to the generator
+	float Offset = 0.f;
+	bool bHit = false;
+};
+
+/* Arena Ground Snap
+* Moves the tiles of sections flagged to snap to the ground, a whole lattice column at a time.
+* Grid columns are a (column, row) through every repetition, polygon columns a position along a side through every height band,
+* so only the bottom of each column is traced and the tiles above it keep their stacking.
+* Tracing is left to the caller, snapping only reads and writes the plan.
+*/
+class ARENAGENERATOR_API FArenaGroundSnap
+{
+public:
+	//Columns to trace, one per lattice column of every pattern of a snapped section
+	static void GatherColumns(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, TArray<FArenaGroundColumn>& OutColumns);
+
+	//Moves the tiles and sub tiles of every column that hit by its offset, clamped to the max adjustment. Returns the number of tiles moved.
+	static int32 ApplyColumns(FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, TConstArrayView<FArenaGroundColumn> Columns);
+
+	static int32 GetNumColumns(const FArenaPlannedPattern& Pattern);
+
+	//Lattice column of a tile, INDEX_NONE outside of the pattern's lattice
+	static int32 GetColumnIdx(const FArenaPlannedPattern& Pattern, const FArenaTileCoord& Coord);
+};
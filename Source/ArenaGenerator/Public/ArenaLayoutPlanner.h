@@ -0,0 +1,394 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "ArenaGeneratorTypes.h"
+#include "ArenaTileGraph.h"
+
+/* Arena Layout Planner
+* Placement math for arenas, independent from UObjects and the world.
+* The planner turns a section list into a plan of tile transforms that a generator
+* commits into components, or that can be baked directly. Planners only read their
+* inputs, so any number of them can run in parallel on worker threads.
+*/
+
+//Geometry derived for a section from its build order rules.
+struct ARENAGENERATOR_API FArenaSectionGeometry
+{
+	EArenaBuildOrderRules BuildOrderRules = EArenaBuildOrderRules::PolygonLeadByRadius;
+	float InscribedRadius = 0.f;
+	float Apothem = 0.f;
+	float InteriorAngle = 0.f;
+	float ExteriorAngle = 0.f;
+	float SideLength = 0.f;
+	int32 ArenaSides = 0;
+	int32 ArenaDimensions = 0;
+	int32 TilesPerArenaSide = 0;
+};
+
+//Everything the planner reads from a generator. Copied so planning never touches the generator itself.
+struct ARENAGENERATOR_API FArenaLayoutInputs
+{
+	TArray<FArenaMeshGroupConfig> MeshGroups;
+	TArray<FArenaActorConfig> ActorGroups;
+	TArray<FArenaSection> SectionList;
+	EOriginPlacementType ArenaPlacementOnActor = EOriginPlacementType::Center;
+
+	//Pivot to center offset of each mesh of each group, see FArenaMeshMetricsCache::ResolveInputs. Origin types are used when empty.
+	TArray<TArray<FVector>> MeshPivotOffsets;
+
+	//Drops tiles coincident with a tile of a higher priority pattern once a plan is complete
+	bool bRemoveDuplicateTiles = false;
+	float DuplicateTolerance = 1.f;
+	bool bDuplicatesIgnoreYaw = false;
+
+	//Annotations built with the plan, see FArenaLayoutPlanner::BuildAnnotations
+	bool bBuildAnnotations = true;
+	float CoverOffset = 50.f;
+	float PatrolInset = 300.f;
+
+	//Walkability graph built with the plan, see FArenaTileGraph
+	bool bBuildTileGraph = false;
+	float GraphMaxStepHeight = 50.f;
+	float GraphAgentHeight = 180.f;
+	bool bGraphDiagonals = true;
+
+	//Largest height change of a tile column snapped to the ground, see FArenaGroundSnap
+	float GroundSnapMaxAdjust = 200.f;
+
+	int32 MaxSides = 120;
+	int32 MaxTilesPerSideRow = 100;
+};
+
+//Values carried from one pattern to the next while planning.
+struct ARENAGENERATOR_API FArenaPlannerState
+{
+	FArenaSectionGeometry Geometry;
+	FVector OriginOffset = FVector(0);
+	FVector PreviousMeshSize = FVector(0.f);
+	int32 PreviousTilesPerSide = 0;
+	FVector PreviousLastPosition = FVector(0.f);
+
+	//Based on build order rules, arena parameters are calculated with dependencies from user-input parameters.
+	//Using grid based build order rules requires the first pattern with section-type of horizontal grid to be used as reference
+	//Will use index 0 if it fails to find a grid-type pattern with horizontal grid build rules.
+	int32 FocusGridIndex = 0;
+
+	//Based on build order rules, arena parameters are calculated with dependencies from user-input parameters.
+	//Using polygon based build order rules requires the first patterns with polygon build rules to be used as reference.
+	//Will use index 0 if it fails to find a polygon-type pattern with polygonal build rules.
+	int32 FocusPolygonIndex = 0;
+};
+
+/*
+* Lattice coordinate of a tile within its pattern. Every pattern is a stack of 2D slices.
+* Polygon: Slice = side, Column = position along the side, Row = height band.
+* Grid: Slice = repetition (SectionAmount), Column and Row of the grid.
+*/
+struct ARENAGENERATOR_API FArenaTileCoord
+{
+	int32 Slice = 0;
+	int32 Column = 0;
+	int32 Row = 0;
+};
+
+struct ARENAGENERATOR_API FArenaPlannedTile
+{
+	//Transform relative to the generator
+	FTransform Transform;
+
+	FArenaTileCoord Coord;
+
+	//Index into the group's meshes, or actor classes for actor patterns. Sub meshes index past the group's meshes, see GetComponentMeshes.
+	int32 MeshIdx = 0;
+};
+
+//One pattern (build rule) of a section. Its tiles are Tiles[FirstTile, FirstTile + NumTiles) in the plan.
+struct ARENAGENERATOR_API FArenaPlannedPattern
+{
+	int32 SectionIdx = 0;
+	int32 PatternIdx = 0;
+	EArenaSectionType SectionType = EArenaSectionType::Polygon;
+	ETypeToPlace AssetToPlace = ETypeToPlace::StaticMeshes;
+
+	//Index into MeshGroups or ActorGroups depending on AssetToPlace
+	int32 GroupIdx = 0;
+	FVector MeshSize = FVector(0.f);
+	FVector MeshScale = FVector(1.f);
+
+	//Tiles per polygon side, also used to place grids
+	int32 TilesPerSide = 0;
+
+	//Lattice extents
+	int32 Slices = 0;
+	int32 Columns = 0;
+	int32 Rows = 0;
+
+	int32 FirstTile = 0;
+	int32 NumTiles = 0;
+
+	//Sub mesh instances of composite tiles, SubTiles[FirstSubTile, FirstSubTile + NumSubTiles) in the plan
+	int32 FirstSubTile = 0;
+	int32 NumSubTiles = 0;
+
+	//Adjacency solver report, summed over the pattern's slices
+	int32 AdjacencyAttempts = 0;
+	int32 AdjacencyContradictions = 0;
+
+	//Lattice cells left out by the section's carve volumes
+	int32 NumCarvedTiles = 0;
+};
+
+struct ARENAGENERATOR_API FArenaLayoutPlan
+{
+	int32 Seed = 0;
+
+	TArray<FArenaPlannedPattern> Patterns;
+	TArray<FArenaPlannedTile> Tiles;
+
+	//Sub mesh instances of composite tiles. They share their tile's coordinate and are not part of the lattice.
+	TArray<FArenaPlannedTile> SubTiles;
+
+	//Geometry of each planned section, in section order
+	TArray<FArenaSectionGeometry> SectionGeometry;
+
+	//Tiles dropped as duplicates of other tiles, see FArenaLayoutInputs::bRemoveDuplicateTiles
+	int32 NumDuplicatesRemoved = 0;
+
+	//Gameplay locations of the whole plan, empty for streamed bands
+	FArenaAnnotations Annotations;
+
+	//Floor connectivity of the whole plan, empty for streamed bands or when not requested
+	FArenaTileGraph TileGraph;
+
+	TArrayView<const FArenaPlannedTile> GetPatternTiles(const FArenaPlannedPattern& Pattern) const
+	{
+		return TArrayView<const FArenaPlannedTile>(Tiles.GetData() + Pattern.FirstTile, Pattern.NumTiles);
+	}
+
+	TArrayView<const FArenaPlannedTile> GetPatternSubTiles(const FArenaPlannedPattern& Pattern) const
+	{
+		return TArrayView<const FArenaPlannedTile>(SubTiles.GetData() + Pattern.FirstSubTile, Pattern.NumSubTiles);
+	}
+
+	bool IsEmpty() const { return Tiles.IsEmpty(); }
+
+	void Reset();
+
+	//Adds the patterns and tiles of another plan after these, offsetting its tile ranges. Annotations and the graph are left as they are.
+	void Append(const FArenaLayoutPlan& Other);
+};
+
+//Concavity weight of every (column, row) of a pattern, built once and shared by all of its sides and repetitions.
+struct ARENAGENERATOR_API FArenaConcavityTable
+{
+	int32 Columns = 0;
+	int32 Rows = 0;
+	TArray<float> Weights;
+
+	void Build(int32 ColMidpoint, int32 RowMidpoint, int32 InColumns, int32 InRows, float ConcavityStrength);
+
+	float Get(int32 Col, int32 Row) const { return Weights[Row * Columns + Col]; }
+};
+
+//Rotation offset of every (mesh, yaw index) of a pattern, moving each mesh so it turns around its center instead of its pivot.
+struct ARENAGENERATOR_API FArenaPivotTable
+{
+	int32 NumYaws = 0;
+	TArray<FVector> Offsets;
+
+	void Build(TConstArrayView<FVector> PivotToCenter, float BaseYaw, float YawIncrement, int32 InNumYaws);
+
+	const FVector& Get(int32 MeshIdx, int32 YawIdx) const { return Offsets[MeshIdx * NumYaws + YawIdx]; }
+};
+
+//Autotile result of every 8-neighbor occupancy mask, built once per pattern from its group's rules.
+struct ARENAGENERATOR_API FArenaAutoTileTable
+{
+	struct FEntry
+	{
+		int32 MeshIdx = INDEX_NONE;
+		float Yaw = 0.f;
+		bool bMatched = false;
+	};
+
+	FEntry Entries[256];
+
+	void Build(TConstArrayView<FArenaAutoTileRule> Rules, int32 NumMeshes);
+
+	//Turns a neighbor mask by 90 degree steps of yaw, N becomes E
+	static uint8 RotateMask(uint8 Mask, int32 Turns);
+
+	/*
+	* Neighbor mask of every cell of a zero padded occupancy plane of (Columns + 2) * (Rows + 2) bytes, written at the same cell.
+	* Computed a whole row at a time so the compiler can vectorize it. Wrapping copies the first and last columns into the padding.
+	*/
+	static void ComputeMasks(TArrayView<uint8> Occupancy, int32 Columns, int32 Rows, bool bWrapColumns, TArrayView<uint8> OutMasks);
+};
+
+//Lattice cells of a pattern removed by carve volumes. Volumes are turned into lattice ranges once, tiles only test a bit.
+struct ARENAGENERATOR_API FArenaCarveMask
+{
+	int32 Slices = 0;
+	int32 Columns = 0;
+	int32 Rows = 0;
+	TBitArray<> Cells;
+
+	void Init(const FArenaPlannedPattern& Pattern);
+
+	bool IsEmpty() const { return Cells.IsEmpty(); }
+
+	bool IsCarved(int32 Slice, int32 Column, int32 Row) const
+	{
+		return !Cells.IsEmpty() && Cells[(Slice * Rows + Row) * Columns + Column];
+	}
+
+	//Inclusive ranges clamped to the lattice. Negative ends run to the last cell.
+	void AddRange(FIntPoint SliceRange, FIntPoint ColumnRange, FIntPoint RowRange);
+
+	//Cells of an axis aligned lattice whose middle is inside Box. Cell (Slice, Column, Row) has its middle at Origin + (Row, Column, Slice) * Step.
+	void AddGridBox(const FBox& Box, const FVector& Origin, const FVector& Step);
+
+	//Cells of one row of a slice whose middle is inside Box. Cell Column has its middle at Start + Column * Step.
+	void AddLineBox(const FBox& Box, int32 Slice, int32 Row, const FVector& Start, const FVector& Step);
+};
+
+class ARENAGENERATOR_API FArenaLayoutPlanner
+{
+public:
+
+	FArenaLayoutPlanner(const FArenaLayoutInputs& InInputs, const FRandomStream& InStream);
+
+	//Plans every section of the section list, starting from a reset state
+	bool PlanLayout(FArenaLayoutPlan& OutPlan);
+
+	//Calculates section parameters then plans every pattern of the section, continuing from the current state
+	bool PlanSection(int32 SectionIdx, FArenaLayoutPlan& OutPlan);
+
+	//Plans a section on top of the current height instead of restarting at the base, used to stream bands of endless arenas
+	bool PlanSectionBand(int32 SectionIdx, FArenaLayoutPlan& OutPlan);
+
+	//Counts the tiles a section would place, continuing from the current state, without planning any transform
+	bool PredictSectionTiles(const FArenaSection& Section, int32& OutMeshTiles, int32& OutActorTiles);
+
+	//Plans a single pattern with the current section parameters and state
+	bool PlanPattern(const FArenaSectionBuildRules& Rules, int32 SectionIdx, int32 PatternIdx, FArenaLayoutPlan& OutPlan);
+
+	//Calculates the definitive parameters of the section to be generated and stores them in the state.
+	bool CalculateSectionParameters(const FArenaSection& Section);
+
+	//Fit of the last section whose parameters were calculated
+	const FArenaFitResult& GetSectionFit() const { return SectionFit; }
+
+	const FArenaPlannerState& GetState() const { return State; }
+	void SetState(const FArenaPlannerState& InState) { State = InState; }
+
+	const FRandomStream& GetStream() const { return Stream; }
+
+	//Quiet planners do not log adjusted targets, invalid groups or adjacency fallbacks, for prediction and batch use where every plan would log
+	void SetQuiet(bool bInQuiet) { bQuiet = bInQuiet; }
+
+	//Plans one layout per seed in parallel. OutPlans matches Seeds order.
+	static void PlanLayoutsForSeeds(const FArenaLayoutInputs& Inputs, TArrayView<const int32> Seeds, TArray<FArenaLayoutPlan>& OutPlans);
+
+	//Converts a plan into a baked layout, grouping tiles per mesh, and fills its stats
+	static FArenaBakedLayout BakePlan(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs);
+
+	//Spawn points from the top of grid floors, cover along the bottom band of polygon walls and a patrol loop inside each polygon ring
+	static void BuildAnnotations(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, FArenaAnnotations& OutAnnotations);
+
+	//Pivot to center offset of every mesh of a pattern's group. Actors are centered on their origin.
+	static void GetPivotOffsets(const FArenaLayoutInputs& Inputs, const FArenaPlannedPattern& Pattern, TArray<FVector>& OutOffsets);
+
+#pragma region Utility
+
+	static float CalculateOpposite(float length, float angle);
+	static float CalculateAdjacent(float length, float angle);
+	static FVector ForwardVectorFromYaw(float yaw);
+
+	//Returns a scalar vector to multiply a mesh size to get the necessary off such that the mesh spans positively across X and Y axes from the origin. Optimized for absolute directions, incorrect for angled directions.
+	static FVector RotatedMeshOffset(EOriginPlacementType OriginType, const FVector& MeshSize, int RotationIndex);
+
+	//Offsets mesh along FV and RV based on origin type. Optimized for angled directions.
+	static FVector OffsetMeshAlongDirections(const FVector& FV, const FVector& RV, EOriginPlacementType OriginType, const FVector& MeshSize, int RotationIndex);
+
+	//Returns a scalar vector to multiply a mesh size with to get the necessary offset such that the origin sits in the center of the mesh.
+	static FVector OriginOffsetScalar(EOriginPlacementType OriginType);
+
+	//Adds concavity to a 2-dimensional grid of columns and rows in a direction amplified by concavity strength.
+	static FVector PlacementWarpingConcavity(int ColMidpoint, int RowMidpoint, int Col, int Row, float ConcavityStrength, FVector WarpDirection);
+
+	//Scalar of PlacementWarpingConcavity along its warp direction
+	static float ConcavityWeight(int ColMidpoint, int RowMidpoint, int Col, int Row, float ConcavityStrength);
+
+	//Given an angle of rotation, offsets mesh to the center
+	static FVector OffsetMeshToCenter(EOriginPlacementType OriginType, const FVector& MeshSize, float angle);
+
+	//Offset moving a mesh rotated by angle around its pivot back onto its center, then from its center to its pivot
+	static FVector PivotRotationOffset(const FVector& PivotToCenter, float angle);
+
+#pragma endregion
+
+private:
+
+	//Randomly offsets by negative and positive values of the OffsetRanges along directions. X input will be driven by Forward vector, Y input will be driven by Right vector. Z-axis will be driven by z value
+	FVector PlacementWarpingDirectional(FVector OffsetRanges, const FVector& DirFV, const FVector& DirRV);
+
+	//Carve volumes of a section that apply to one of its patterns
+	void GetCarveVolumes(int32 SectionIdx, int32 PatternIdx, TArray<const FArenaCarveVolume*>& OutVolumes) const;
+
+	//Resolves the group, sizes and lattice extents of a pattern from its rules and the current state
+	bool PreparePattern(const FArenaSectionBuildRules& Rules, int32 SectionIdx, int32 PatternIdx, FArenaPlannedPattern& Pattern);
+
+	//Offsets the tiles of a planned pattern by the noise warp field of its rules, along the same directions as directional warping
+	void ApplyWarpField(const FArenaWarpField& Field, const FArenaPlannedPattern& Pattern, FArenaLayoutPlan& OutPlan) const;
+
+	//Drops tiles coincident in position and yaw with a kept tile of the same asset type, visiting patterns by priority.
+	//Hashes tiles by position cells of the tolerance's size. Returns the number of tiles removed.
+	int32 RemoveDuplicateTiles(FArenaLayoutPlan& OutPlan) const;
+
+	//Adds the sub mesh instances of every composite tile of a planned pattern
+	void AddSubTiles(FArenaPlannedPattern& Pattern, FArenaLayoutPlan& OutPlan) const;
+
+	//Replaces the mesh and yaw of each tile of a pattern from its group's autotile rules and the tile's neighbors
+	void ApplyAutoTiling(const FArenaPlannedPattern& Pattern, FArenaLayoutPlan& OutPlan) const;
+
+	//Picks the mesh of each tile of a pattern with the adjacency solver, one plane per slice. Draws one seed from the stream.
+	void SolveAdjacency(FArenaPlannedPattern& Pattern, FArenaLayoutPlan& OutPlan);
+
+	//Changes the mesh and adds yaw to a planned tile, keeping the mesh's center in place
+	static void SetTileMesh(FArenaPlannedTile& Tile, int32 NewMeshIdx, float AddedYaw, TConstArrayView<FVector> PivotOffsets);
+
+	//Origin offset of a pattern based on the arena placement on actor and the current section parameters
+	FVector CalculatePatternOrigin(EArenaSectionType SectionType, const FVector& MeshSize, const FVector& MeshScale, int32 CurrTilesPerSide) const;
+
+	const FArenaLayoutInputs& Inputs;
+	FRandomStream Stream;
+	FArenaPlannerState State;
+	FArenaFitResult SectionFit;
+	bool bQuiet = false;
+};
@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UTexture2D;
+struct FArenaLayoutPlan;
+struct FArenaLayoutInputs;
+
+/* Arena Layout Raster
+* Top down image of a layout plan rasterized on the CPU, without rendering anything, so it also works headless.
+* Every pixel keeps the section, mesh group and top height of the highest static mesh tile covering its center.
+* Pixel (X, Y) covers generator space X and Y growing with the pixel coordinates, starting at Bounds.Min.
+* Used for minimaps, AI heatmaps and comparing layouts.
+*/
+struct ARENAGENERATOR_API FArenaLayoutRaster
+{
+	int32 Width = 0;
+	int32 Height = 0;
+
+	//Generator space area covered by the image, and the size of a square pixel
+	FBox2D Bounds = FBox2D(ForceInit);
+	float PixelSize = 0.f;
+
+	//Section index + 1 per pixel, 0 where no tile is. Sections past 254 share 255.
+	TArray<uint8> SectionIds;
+
+	//Mesh group index + 1 per pixel, 0 where no tile is. Groups past 254 share 255.
+	TArray<uint8> GroupIds;
+
+	//Top of the highest tile per pixel, relative to the generator. 0 where no tile is.
+	TArray<float> Heights;
+
+	//Range of Heights over the occupied pixels
+	float MinHeight = 0.f;
+	float MaxHeight = 0.f;
+
+	//Rasterizes every static mesh tile of a plan as its rotated footprint. The longest side of the plan gets Resolution pixels.
+	static void Rasterize(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, int32 Resolution, FArenaLayoutRaster& Out);
+
+	bool IsEmpty() const { return Width == 0 || Height == 0; }
+
+	bool IsOccupied(int32 X, int32 Y) const { return SectionIds[Y * Width + X] != 0; }
+
+	//Packs the planes into BGRA8 pixels. R = section, G = height normalized over [MinHeight, MaxHeight], B = group, A = occupied.
+	void ToColors(TArray<FColor>& OutColors) const;
+
+	//Transient texture of ToColors with nearest filtering, game thread only. Nullptr for an empty raster.
+	UTexture2D* CreateTexture(FName Name = NAME_None) const;
+
+	//Pixels whose section or group differ, or whose height differs by more than HeightTolerance. INDEX_NONE if the rasters do not line up.
+	int32 CountDifferences(const FArenaLayoutRaster& Other, float HeightTolerance = 1.f) const;
+
+	void Reset();
+
+	friend ARENAGENERATOR_API FArchive& operator<<(FArchive& Ar, FArenaLayoutRaster& Raster);
+};
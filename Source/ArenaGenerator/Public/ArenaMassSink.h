@@ -0,0 +1,184 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "ArenaOutputSink.h"
+#include "ArenaMassSink.generated.h"
+
+class UMassEntitySubsystem;
+class UInstancedStaticMeshComponent;
+struct FMassEntityManager;
+
+/* Arena Mass Sink
+* Actor patterns with thousands of tiles are too heavy as actors. This sink stores each tile as a
+* Mass entity instead, drawn through one instanced mesh per actor group (EntityProxyMesh).
+* Only tiles that need behavior are promoted to actors, and demoted back when they no longer do,
+* either one by one or by proximity to tracked sources. Demoted actors are hidden and pooled for the next promotion.
+*/
+
+//Transform of the tile relative to the generator
+USTRUCT()
+struct ARENAGENERATOR_API FArenaTileTransformFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FTransform RelativeTransform;
+};
+
+//Actor the tile becomes when promoted
+USTRUCT()
+struct ARENAGENERATOR_API FArenaTileClassFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<AActor> ActorClass;
+
+	UPROPERTY()
+	int32 GroupIdx = 0;
+
+	UPROPERTY()
+	int32 ClassIdx = 0;
+};
+
+//Lattice coordinate of the tile, see FArenaTileCoord
+USTRUCT()
+struct ARENAGENERATOR_API FArenaTileCoordFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 SectionIdx = 0;
+
+	UPROPERTY()
+	int32 PatternIdx = 0;
+
+	UPROPERTY()
+	int32 Slice = 0;
+
+	UPROPERTY()
+	int32 Column = 0;
+
+	UPROPERTY()
+	int32 Row = 0;
+};
+
+//How the tile is currently drawn: a proxy instance, or the promoted actor
+USTRUCT()
+struct ARENAGENERATOR_API FArenaTileVisualFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TWeakObjectPtr<UInstancedStaticMeshComponent> Proxy;
+
+	UPROPERTY()
+	int32 InstanceIdx = INDEX_NONE;
+
+	UPROPERTY()
+	TWeakObjectPtr<AActor> PromotedActor;
+};
+
+class ARENAGENERATOR_API FArenaMassSink : public IArenaOutputSink
+{
+public:
+	static const FName SinkName;
+
+	virtual ~FArenaMassSink();
+
+	virtual void BeginCommit(FArenaSinkContext& Context, const FArenaLayoutPlan& Plan) override;
+	virtual void CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles) override;
+	virtual void Clear(ABaseArenaGenerator& Generator) override;
+
+	//Places a pooled or new actor on the tile and hides its proxy instance. Returns the existing actor if already promoted.
+	AActor* PromoteTile(ABaseArenaGenerator& Generator, FMassEntityHandle Entity);
+
+	//Returns the tile's actor to the pool and shows its proxy instance again
+	void DemoteTile(ABaseArenaGenerator& Generator, FMassEntityHandle Entity);
+
+	/*
+	* Promotes tiles of the active arena closer than PromoteRadius to any source and demotes promoted tiles further than DemoteRadius.
+	* Sources are relative to the generator. At most MaxChanges tiles change per call, the rest catch up on later calls.
+	* Returns the number of tiles promoted or demoted.
+	*/
+	int32 UpdatePromotion(ABaseArenaGenerator& Generator, TConstArrayView<FVector> Sources, float PromoteRadius, float DemoteRadius, int32 MaxChanges);
+
+	bool IsTilePromoted(FMassEntityHandle Entity) const;
+
+	//True while any tile of the active arena is an actor
+	bool HasPromotedTiles();
+
+	//Destroys the entities committed with any of these proxies, and their promoted and pooled actors, before the proxies are destroyed
+	void ReleaseBatches(ABaseArenaGenerator& Generator, TConstArrayView<UInstancedStaticMeshComponent*> Proxies);
+
+	//Entities of every committed arena still alive, including one being prepared in the background
+	void GetEntities(TArray<FMassEntityHandle>& OutEntities) const;
+
+	FMassEntityManager* GetEntityManager() const;
+
+private:
+	//Entities of one commit. They live as long as the proxy components of the set they were committed into.
+	struct FEntityBatch
+	{
+		TArray<FMassEntityHandle> Entities;
+		TArray<TWeakObjectPtr<UInstancedStaticMeshComponent>> Proxies;
+
+		//Demoted actors, hidden and kept in the batch's set until promoted again
+		TMap<UClass*, TArray<TWeakObjectPtr<AActor>>> ActorPool;
+
+		//True once the first proxy is valid and visible, meaning the batch belongs to the arena in play
+		bool IsActive() const;
+	};
+
+	void DestroyBatch(FEntityBatch& Batch);
+	FEntityBatch* FindBatch(const UInstancedStaticMeshComponent* Proxy);
+
+	//Promote and demote without refreshing the proxy render state, so many tiles can swap in one batch
+	AActor* PromoteTileDeferred(ABaseArenaGenerator& Generator, FMassEntityHandle Entity);
+	void DemoteTileDeferred(ABaseArenaGenerator& Generator, FMassEntityHandle Entity);
+
+	//Rebuilds the flat tile arrays read by UpdatePromotion when the active batches or promotions changed
+	void RefreshPromotionCache(FMassEntityManager& EntityManager);
+
+	TWeakObjectPtr<UMassEntitySubsystem> EntitySubsystem;
+	FMassArchetypeHandle Archetype;
+	TArray<FEntityBatch> Batches;
+
+	//Proxy component of each actor group for the set being committed
+	TMap<int32, UInstancedStaticMeshComponent*> CommitProxies;
+
+	//Entities of the active batches with their location and promotion, in the same order
+	TArray<FMassEntityHandle> CachedEntities;
+	TArray<FVector> CachedLocations;
+	TBitArray<> CachedPromoted;
+	TArray<const FEntityBatch*> CachedBatches;
+	bool bPromotionCacheDirty = true;
+
+	//Proxies whose instances were hidden or shown since their render state was last refreshed
+	TSet<UInstancedStaticMeshComponent*> DirtyProxies;
+};
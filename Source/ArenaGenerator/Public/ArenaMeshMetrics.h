@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "ArenaGeneratorTypes.h"
+
+class UStaticMesh;
+struct FArenaLayoutInputs;
+
+/* Arena Mesh Metrics
+* Tile dimensions and pivot offsets measured from static mesh bounds, cached per mesh so they are only
+* measured once. Resolved into the layout inputs on the game thread so planners never touch the meshes.
+*/
+struct ARENAGENERATOR_API FArenaMeshMetrics
+{
+	//Size of the mesh's bounding box, unscaled
+	FVector Dimensions = FVector(0.f);
+
+	//Offset from the pivot to the center of the bounds in mesh space. Z is left at zero, tiles stack from their pivot height.
+	FVector PivotToCenter = FVector(0.f);
+};
+
+class ARENAGENERATOR_API FArenaMeshMetricsCache
+{
+public:
+	//Game thread only
+	static const FArenaMeshMetrics& Get(const UStaticMesh* Mesh);
+
+	//Drops every cached mesh, for meshes edited or reimported since they were measured
+	static void Reset();
+
+	//Measures group dimensions flagged to come from mesh bounds and fills the pivot offset of every mesh of every group
+	static void ResolveInputs(FArenaLayoutInputs& Inputs);
+
+	//Pivot to center of a mesh entry from its origin type, before the group's scale
+	static FVector GetPivotToCenter(const FArenaMesh& ArenaMesh, const FVector& GroupDimensions);
+
+private:
+	static TMap<FObjectKey, FArenaMeshMetrics>& GetCache();
+};
@@ -0,0 +1,49 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArenaGeneratorTypes.h"
+
+/* Arena Noise
+* Seeded coherent noise for warp fields. Thread-safe and independent from FMath's
+* unseeded noise, so the same seed always produces the same arena on any thread.
+*/
+struct ARENAGENERATOR_API FArenaNoise
+{
+	//Single octave noise in roughly [-1, 1]
+	static float Value3D(const FVector& P, uint32 Seed);
+	static float Perlin3D(const FVector& P, uint32 Seed);
+	static float Simplex3D(const FVector& P, uint32 Seed);
+
+	//Octaves of the field's noise type, normalized to roughly [-1, 1]
+	static float Fractal3D(const FArenaWarpField& Field, const FVector& P, uint32 Seed);
+
+	//Samples the field at every position. OutOffsets receives per-axis offsets scaled by the field amplitude.
+	//Each position is evaluated with scalar noise, large batches are split across worker threads instead of SIMD lanes.
+	static void SampleWarpField(const FArenaWarpField& Field, int32 Seed, TArrayView<const FVector> Positions, TArrayView<FVector> OutOffsets);
+
+	static uint32 Hash(int32 X, int32 Y, int32 Z, uint32 Seed);
+};
@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArenaLayoutPlanner.h"
+
+class ABaseArenaGenerator;
+struct FArenaInstanceSet;
+struct FArenaCommitQueue;
+
+/* Arena Output Sinks
+* Sinks turn planned tiles into something in the world. A generator picks one sink for meshes
+* and one for actors by name, and feeds them every pattern of a plan as one span of tiles.
+* Projects can register their own sinks, for example to feed a custom instancing system.
+*/
+
+//What a sink is committing into
+struct ARENAGENERATOR_API FArenaSinkContext
+{
+	ABaseArenaGenerator& Generator;
+
+	//Set receiving the components and actors. Hidden sets are being prepared in the background.
+	FArenaInstanceSet& Target;
+
+	//Work queued here is spread over frames by the generator when it prepares arenas in the background
+	FArenaCommitQueue& Queue;
+};
+
+class ARENAGENERATOR_API IArenaOutputSink
+{
+public:
+	virtual ~IArenaOutputSink() = default;
+
+	//Called once before the patterns of a plan
+	virtual void BeginCommit(FArenaSinkContext& Context, const FArenaLayoutPlan& Plan) {}
+
+	//Receives every tile of a pattern at once
+	virtual void CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles) = 0;
+
+	//Receives the sub mesh instances of a pattern's composite tiles, after its tiles. Sinks that ignore it place only the tiles' own meshes.
+	virtual void CommitSubTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> SubTiles) {}
+
+	//Called once after the patterns of a plan
+	virtual void EndCommit(FArenaSinkContext& Context) {}
+
+	//Called when the generator wipes its arena, for sinks owning output the generator does not track
+	virtual void Clear(ABaseArenaGenerator& Generator) {}
+
+	//True if the generator may move this sink's output in Set to a new plan in place, when regenerating or carving. Only mesh group
+	//components and spawned actors can be moved, so other sinks leave this false and their arenas are generated again instead.
+	virtual bool CanUpdateInPlace(const FArenaInstanceSet& Set) const { return false; }
+};
+
+//Instanced static mesh components, one per mesh of a group. Also used for hierarchical instances.
+class ARENAGENERATOR_API FArenaInstancedMeshSink : public IArenaOutputSink
+{
+public:
+	explicit FArenaInstancedMeshSink(UClass* InComponentClass);
+
+	virtual void BeginCommit(FArenaSinkContext& Context, const FArenaLayoutPlan& Plan) override;
+	virtual void CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles) override;
+	virtual void CommitSubTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> SubTiles) override;
+	virtual bool CanUpdateInPlace(const FArenaInstanceSet& Set) const override;
+
+private:
+	//Adds tiles to the batch of the component at their mesh index
+	void QueueInstances(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles);
+
+	UClass* ComponentClass = nullptr;
+};
+
+//One actor per tile, attached to the generator
+class ARENAGENERATOR_API FArenaActorSink : public IArenaOutputSink
+{
+public:
+	virtual void CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles) override;
+	virtual bool CanUpdateInPlace(const FArenaInstanceSet& Set) const override { return true; }
+};
+
+//Places nothing and counts what it receives, to measure planning without committing
+class ARENAGENERATOR_API FArenaCountingSink : public IArenaOutputSink
+{
+public:
+	virtual void BeginCommit(FArenaSinkContext& Context, const FArenaLayoutPlan& Plan) override;
+	virtual void CommitTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> Tiles) override;
+	virtual void CommitSubTiles(FArenaSinkContext& Context, const FArenaPlannedPattern& Pattern, TArrayView<const FArenaPlannedTile> SubTiles) override;
+	virtual void EndCommit(FArenaSinkContext& Context) override;
+
+	int64 NumPatterns = 0;
+	int64 NumTiles = 0;
+	int64 NumSubTiles = 0;
+
+private:
+	double CommitStartTime = 0.0;
+};
+
+class ARENAGENERATOR_API FArenaOutputSinkRegistry
+{
+public:
+	using FSinkFactory = TFunction<TSharedRef<IArenaOutputSink>()>;
+
+	static FArenaOutputSinkRegistry& Get();
+
+	//Registers a factory creating a sink for each generator using it. Replaces any sink of the same name.
+	void RegisterSink(FName Name, FSinkFactory Factory);
+	void UnregisterSink(FName Name);
+
+	//Creates a new sink, or returns null if none is registered under that name
+	TSharedPtr<IArenaOutputSink> CreateSink(FName Name) const;
+
+	TArray<FName> GetSinkNames() const;
+
+	//Built-in sinks, registered by the module
+	static const FName ISMSinkName;
+	static const FName HISMSinkName;
+	static const FName ActorSinkName;
+	static const FName CountingSinkName;
+
+	static void RegisterBuiltInSinks();
+	static void UnregisterBuiltInSinks();
+
+private:
+	TMap<FName, FSinkFactory> Factories;
+	mutable FCriticalSection FactoriesLock;
+};
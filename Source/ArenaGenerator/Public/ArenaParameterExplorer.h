@@ -0,0 +1,52 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArenaGeneratorTypes.h"
+
+struct FArenaLayoutInputs;
+
+/* Arena Parameter Explorer
+* Evaluates large grids of section parameters without generating geometry.
+* Each combination runs the section parameter math and tile count prediction of the planner,
+* in parallel, so designers and tools can browse every valid variant within a budget.
+*/
+struct ARENAGENERATOR_API FArenaParameterExplorer
+{
+	//Number of combinations a sweep evaluates before filtering
+	static int64 CountCombinations(const FArenaParameterSweep& Sweep);
+
+	//Evaluates every combination of the sweep with the groups of Inputs, then filters, sorts and truncates the results
+	static void Explore(const FArenaLayoutInputs& Inputs, const FArenaParameterSweep& Sweep, TArray<FArenaVariant>& OutVariants);
+
+	static void SortVariants(TArray<FArenaVariant>& Variants, EArenaVariantSort SortBy, bool bDescending);
+
+	//Combinations above this are refused, a sweep this large is not interactive anymore
+	static constexpr int64 MaxCombinations = 1000000;
+
+	//Combinations evaluated per parallel batch. Only accepted variants of a batch are kept, so memory does not grow with the sweep.
+	static constexpr int32 BatchSize = 16384;
+};
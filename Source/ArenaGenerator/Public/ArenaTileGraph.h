@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FArenaLayoutPlan;
+struct FArenaLayoutInputs;
+
+//Distance to the nearest goal of every node of a tile graph, and the next node on the way there
+struct ARENAGENERATOR_API FArenaFlowField
+{
+	TArray<float> Distances;
+
+	//INDEX_NONE for goals and nodes that cannot reach a goal
+	TArray<int32> NextNodes;
+
+	bool CanReachGoal(int32 Node) const { return Distances.IsValidIndex(Node) && Distances[Node] < MAX_flt; }
+};
+
+/* Arena Tile Graph
+* Walkability graph over the floor tiles of a plan, built from the lattice coordinates the planner already knows.
+* A floor tile is a node when nothing stands above it within the agent height, including the next layers of its stack.
+* Neighbors of the lattice are linked when their height difference is a step and no wall crosses between them,
+* neighboring floors of other patterns are linked the same way. No physics query is made.
+* Edges are stored in CSR form: the edges of node N are EdgeTargets[EdgeOffsets[N], EdgeOffsets[N + 1]).
+* Queries only read the graph, any number of worker threads can run them at once.
+*/
+struct ARENAGENERATOR_API FArenaTileGraph
+{
+	//Walkable surface above the center of each node's tile, relative to the generator
+	TArray<FVector3f> Positions;
+
+	//Plan tile of each node
+	TArray<int32> Tiles;
+
+	TArray<int32> EdgeOffsets;
+	TArray<int32> EdgeTargets;
+	TArray<float> EdgeCosts;
+
+	static void Build(const FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, FArenaTileGraph& Out);
+
+	int32 NumNodes() const { return Positions.Num(); }
+	int32 NumEdges() const { return EdgeTargets.Num(); }
+	bool IsEmpty() const { return Positions.IsEmpty(); }
+
+	TConstArrayView<int32> GetNeighbors(int32 Node) const
+	{
+		return TConstArrayView<int32>(EdgeTargets.GetData() + EdgeOffsets[Node], EdgeOffsets[Node + 1] - EdgeOffsets[Node]);
+	}
+
+	//Node closest to a location relative to the generator, INDEX_NONE for an empty graph. Linear in the number of nodes.
+	int32 FindNearestNode(const FVector& Location) const;
+
+	//A* between two nodes. OutPath starts with Start and ends with Goal, false if Goal cannot be reached.
+	bool FindPath(int32 Start, int32 Goal, TArray<int32>& OutPath) const;
+
+	//FindPath between the nodes nearest to two locations, as node positions
+	bool FindPathBetween(const FVector& From, const FVector& To, TArray<FVector>& OutPoints) const;
+
+	//Dijkstra from every goal at once, for many agents heading to the same places
+	void BuildFlowField(TConstArrayView<int32> Goals, FArenaFlowField& OutField) const;
+
+	void Reset();
+
+	SIZE_T GetAllocatedSize() const;
+};
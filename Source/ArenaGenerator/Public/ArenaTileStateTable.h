@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArenaLayoutPlanner.h"
+
+/* Arena Tile State Table
+* Gameplay state for every tile of the active arena, stored as a structure of arrays so scans only
+* touch the columns they read. Game code registers typed columns (health, flags, timestamps...) and
+* the generator keeps one row per planned tile, addressable by plan index or lattice coordinate.
+* Writes mark fixed-size chunks dirty so only changed ranges need to be replicated.
+* Game thread only.
+*/
+
+//Contiguous tiles [FirstTile, FirstTile + NumTiles)
+struct ARENAGENERATOR_API FArenaTileRange
+{
+	int32 FirstTile = 0;
+	int32 NumTiles = 0;
+};
+
+class ARENAGENERATOR_API FArenaTileStateTable
+{
+public:
+	//Tiles per dirty flag
+	static constexpr int32 DirtyChunkSize = 64;
+
+	//Removes every tile and keeps the registered columns
+	void ResetTiles();
+
+	//Appends one row per tile of the plan, columns start at their default value
+	void AddPlanTiles(const FArenaLayoutPlan& Plan);
+
+	//Appends one row per location for tiles without a plan, such as baked ones. FindTile does not find them.
+	void AddTileLocations(TConstArrayView<FVector> Locations);
+
+	//Removes a range of rows. Later tiles move down by the range's size and are marked dirty.
+	void RemoveTiles(const FArenaTileRange& Range);
+
+	int32 Num() const { return PositionX.Num(); }
+
+	//Tile of a pattern at a lattice coordinate, INDEX_NONE if the lattice has no tile there
+	int32 FindTile(int32 SectionIdx, int32 PatternIdx, const FArenaTileCoord& Coord) const;
+
+	//Location relative to the generator
+	FVector GetTileLocation(int32 Tile) const { return FVector(PositionX[Tile], PositionY[Tile], PositionZ[Tile]); }
+
+#pragma region Columns
+
+	//Registers a column or returns the existing one of that name. Values must be trivially copyable.
+	template<typename T>
+	int32 RegisterColumn(FName Name, const T& DefaultValue = T())
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Tile state columns are copied and replicated as raw bytes");
+		return RegisterColumnRaw(Name, sizeof(T), &DefaultValue);
+	}
+
+	int32 FindColumn(FName Name) const;
+	FName GetColumnName(int32 ColumnIdx) const { return Columns[ColumnIdx].Name; }
+	int32 GetColumnElementSize(int32 ColumnIdx) const { return Columns[ColumnIdx].ElementSize; }
+
+	//Read access, never marks anything dirty
+	template<typename T>
+	TConstArrayView<T> GetColumn(int32 ColumnIdx) const
+	{
+		const FColumn& Column = GetCheckedColumn(ColumnIdx, sizeof(T));
+		return TConstArrayView<T>(reinterpret_cast<const T*>(Column.Data.GetData()), Num());
+	}
+
+	//Write access to a whole column, the caller marks what it changed with MarkDirty
+	template<typename T>
+	TArrayView<T> GetMutableColumn(int32 ColumnIdx)
+	{
+		FColumn& Column = GetCheckedColumn(ColumnIdx, sizeof(T));
+		return TArrayView<T>(reinterpret_cast<T*>(Column.Data.GetData()), Num());
+	}
+
+	template<typename T>
+	void SetValue(int32 ColumnIdx, int32 Tile, const T& Value)
+	{
+		GetMutableColumn<T>(ColumnIdx)[Tile] = Value;
+		MarkDirty(ColumnIdx, Tile, 1);
+	}
+
+	template<typename T>
+	void SetValues(int32 ColumnIdx, TConstArrayView<int32> Tiles, const T& Value)
+	{
+		TArrayView<T> Values = GetMutableColumn<T>(ColumnIdx);
+		for (const int32 Tile : Tiles)
+		{
+			Values[Tile] = Value;
+			MarkDirty(ColumnIdx, Tile, 1);
+		}
+	}
+
+	void MarkDirty(int32 ColumnIdx, int32 FirstTile, int32 NumTiles);
+
+#pragma endregion
+
+#pragma region Queries
+
+	//Tiles within Radius of Center, relative to the generator
+	void QueryRadius(const FVector& Center, float Radius, TArray<int32>& OutTiles) const;
+
+	//Tiles of a uint32 column having every bit of Mask set
+	void QueryFlags(int32 FlagColumn, uint32 Mask, TArray<int32>& OutTiles) const;
+	void QueryFlagsInRadius(int32 FlagColumn, uint32 Mask, const FVector& Center, float Radius, TArray<int32>& OutTiles) const;
+
+	//Sets or clears Mask on tiles of a uint32 column. Returns how many tiles changed.
+	int32 SetFlags(int32 FlagColumn, TConstArrayView<int32> Tiles, uint32 Mask, bool bSet);
+
+#pragma endregion
+
+#pragma region Replication
+
+	void GetDirtyRanges(int32 ColumnIdx, TArray<FArenaTileRange>& OutRanges) const;
+	void MarkAllDirty();
+	void ClearDirty();
+
+	//Writes the dirty ranges of every column. Clients apply them with ApplyDirtyRanges.
+	void SerializeDirtyRanges(FArchive& Ar, bool bClearDirty = true);
+
+	//Reads ranges written by SerializeDirtyRanges. Fails without changes if the tile count or a column differs.
+	bool ApplyDirtyRanges(FArchive& Ar);
+
+#pragma endregion
+
+private:
+	struct FColumn
+	{
+		FName Name;
+		int32 ElementSize = 0;
+		TArray<uint8> DefaultValue;
+
+		//16 byte aligned so columns of floats or ints can be read with vector loads
+		TArray<uint8, TAlignedHeapAllocator<16>> Data;
+		TBitArray<> DirtyChunks;
+	};
+
+	//Lattice of one pattern, mapping coordinates to tile indices
+	struct FPatternLattice
+	{
+		int32 SectionIdx = 0;
+		int32 PatternIdx = 0;
+		int32 Slices = 0;
+		int32 Columns = 0;
+		int32 Rows = 0;
+		TArray<int32> Tiles;
+	};
+
+	int32 RegisterColumnRaw(FName Name, int32 ElementSize, const void* DefaultValue);
+
+	//Appends default values to every column for the rows from FirstTile on
+	void AddDefaultRows(int32 FirstTile);
+	FColumn& GetCheckedColumn(int32 ColumnIdx, int32 ElementSize);
+	const FColumn& GetCheckedColumn(int32 ColumnIdx, int32 ElementSize) const;
+
+	//Calls Visit with blocks of 4 tiles and a 4 bit mask of those within the radius
+	template<typename VisitorType>
+	void ScanRadius(const FVector& Center, float Radius, VisitorType&& Visit) const;
+
+	TArray<float, TAlignedHeapAllocator<16>> PositionX;
+	TArray<float, TAlignedHeapAllocator<16>> PositionY;
+	TArray<float, TAlignedHeapAllocator<16>> PositionZ;
+
+	TArray<FPatternLattice> Lattices;
+	TArray<FColumn> Columns;
+};
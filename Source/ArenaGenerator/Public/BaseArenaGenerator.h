@@ -26,8 +26,115 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "ArenaGeneratorTypes.h"
+#include "ArenaLayoutPlanner.h"
+#include "ArenaTileStateTable.h"
+#include "ArenaGroundSnap.h"
+#include "WorldCollision.h"
 #include "BaseArenaGenerator.generated.h"
 
+class UArenaBakedLayoutAsset;
+class IArenaOutputSink;
+class FArenaMassSink;
+struct FArenaLayoutRaster;
+class UTexture2D;
+class UInstancedStaticMeshComponent;
+
+//Components and actors making up one generated arena.
+struct FArenaInstanceSet
+{
+	TArray<TArray<UInstancedStaticMeshComponent*>> MeshInstances;
+	TArray<AActor*> SpawnedActors;
+	TArray<int32> UsedGroupIndices;
+	int32 TotalInstances = 0;
+
+	//Class of the instanced components created for this set, set by the mesh output sink. Null uses UInstancedStaticMeshComponent.
+	UClass* ComponentClass = nullptr;
+
+	//Components created by output sinks besides the mesh group components, destroyed and revealed with the set
+	TArray<UInstancedStaticMeshComponent*> SinkComponents;
+
+	//Hidden sets are created invisible and ignoring collision until they are revealed
+	bool bHidden = false;
+
+	bool IsEmpty() const { return MeshInstances.IsEmpty() && SpawnedActors.IsEmpty() && SinkComponents.IsEmpty(); }
+};
+
+//Instances and actors of a plan waiting to be added to an instance set, so the work can be spread over frames.
+struct FArenaCommitQueue
+{
+	struct FInstanceBatch
+	{
+		UInstancedStaticMeshComponent* Component = nullptr;
+		TArray<FTransform> Transforms;
+		int32 Cursor = 0;
+	};
+
+	struct FActorSpawn
+	{
+		TSubclassOf<AActor> ActorClass;
+		FTransform Transform;
+	};
+
+	TArray<FInstanceBatch> InstanceBatches;
+	TArray<FActorSpawn> ActorSpawns;
+
+	//Batch index of each component, so a component receives all of its instances in one batch
+	TMap<UInstancedStaticMeshComponent*, int32> ComponentBatches;
+	int32 BatchIdx = 0;
+	int32 ActorIdx = 0;
+
+	//Set once the target's deferred physics was queued after its last instance
+	bool bPhysicsQueued = false;
+
+	bool IsDone() const { return BatchIdx >= InstanceBatches.Num() && ActorIdx >= ActorSpawns.Num(); }
+};
+
+//Height band of a streamed arena and the instance slots and actors it occupies.
+struct FArenaStreamBand
+{
+	//Band extents along the generator's Z axis
+	float MinZ = 0.f;
+	float MaxZ = 0.f;
+
+	TArray<TPair<UInstancedStaticMeshComponent*, int32>> Slots;
+	TArray<AActor*> Actors;
+
+	//Components the actor sink created for the band, such as Mass entity proxies, destroyed when the band retires
+	TArray<UInstancedStaticMeshComponent*> SinkComponents;
+
+	//Rows of the band in the tile state table, removed when the band retires
+	FArenaTileRange Tiles;
+};
+
+//Arena a snapped plan is committed to once its ground traces returned
+enum class EArenaGroundSnapTarget : uint8
+{
+	ActiveArena,
+	NextArena,
+	StreamBand,
+	Num
+};
+
+//Plan waiting for the ground traces under its snapped sections, with the inputs it was planned from.
+struct FArenaGroundSnapPass
+{
+	TSharedPtr<FArenaLayoutPlan> Plan;
+	TSharedPtr<const FArenaLayoutInputs> Inputs;
+	TArray<FArenaGroundColumn> Columns;
+
+	//Trace of each column. Results of a cancelled pass no longer match and are dropped.
+	TArray<FTraceHandle> Traces;
+	int32 PendingTraces = 0;
+	FTraceDelegate TraceDelegate;
+
+	//Active arena passes replace its layout in place instead of adding to it
+	bool bInPlace = false;
+
+	bool IsActive() const { return Plan.IsValid(); }
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnArenaBufferEvent);
+
 UCLASS(Blueprintable, ClassGroup = "Arena Generator")
 class ARENAGENERATOR_API ABaseArenaGenerator : public AActor
 {
@@ -44,6 +151,9 @@ protected:
 	// Need to override to delete additional memory allocated
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	//Maps deprecated properties of generators saved before output sinks
+	virtual void PostLoad() override;
+
 public:	
 
 	//Will generate an Arena based on provided patterns in PatternList
@@ -65,34 +175,289 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Arena")
 	virtual void BuildSection(FArenaSectionBuildRules& Section);
 
-	
+	//Regenerates the arena with a new seed, reusing existing components, instances and actors where possible
+	UFUNCTION(BlueprintCallable, Category = "Arena")
+	void RegenerateArena(int32 NewSeed);
+
+	//Builds the arena and stores the result in the bake target so it can be restored without building sections
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Baking")
+	void BakeArena();
+
+	//Discards baked data stored on this generator
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Baking")
+	void ClearBakedLayout();
+
+	//Builds the arena and stores it in the bake target. Returns false if nothing could be baked.
+	bool BakeArenaLayout();
+
+	//Captures the currently generated instances and actors as a baked layout
+	FArenaBakedLayout CaptureBakedLayout() const;
+
+	//Recreates instances and actors from a baked layout. Does not wipe the current arena.
+	void ApplyBakedLayout(const FArenaBakedLayout& Layout);
+
+	//Returns the baked layout from the bake target, or nullptr if there is none
+	const FArenaBakedLayout* FindBakedLayout() const;
+
+
+	//Copies the parameters the layout planner needs from this generator
+	FArenaLayoutInputs GatherLayoutInputs() const;
+
+	//Adds a carve volume to a section and removes its tiles from the active arena in one batch, replanning it without touching the other tiles.
+	//The volume stays on the section for the following generations. Returns false if only the section was changed.
+	UFUNCTION(BlueprintCallable, Category = "Arena")
+	bool CarveArena(int32 SectionIdx, const FArenaCarveVolume& Volume);
+
+	//Plans one layout per seed in parallel, without touching the world, and returns them baked with their stats.
+	UFUNCTION(BlueprintCallable, Category = "Arena")
+	void PlanLayoutsForSeeds(const TArray<int32>& Seeds, TArray<FArenaBakedLayout>& OutLayouts) const;
+
+	//Evaluates every combination of the sweep with this generator's groups, without generating geometry. Results are filtered and sorted as the sweep asks.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Exploration")
+	void ExploreArenaVariants(const FArenaParameterSweep& Sweep, TArray<FArenaVariant>& OutVariants) const;
+
+	//Sorts variants returned by ExploreArenaVariants
+	UFUNCTION(BlueprintCallable, Category = "Arena | Exploration")
+	static void SortArenaVariants(UPARAM(ref) TArray<FArenaVariant>& Variants, EArenaVariantSort SortBy, bool bDescending);
+
+	//Plans the next arena in the background, then prepares it hidden over several frames. OnNextArenaReady fires once it can be swapped in.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Double Buffering")
+	void PrepareNextArena(int32 Seed);
+
+	//Reveals the prepared arena and hides the current one, which is then released over several frames. Returns false if no arena is ready.
+	//With bBuildNavigationBeforeSwap the swap completes once the navmesh of the prepared arena is built, OnArenaSwapped fires then.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Double Buffering")
+	bool SwapToNextArena();
+
+	//Stops preparing the next arena and destroys what was already prepared
+	UFUNCTION(BlueprintCallable, Category = "Arena | Double Buffering")
+	void CancelNextArena();
+
+	UFUNCTION(BlueprintPure, Category = "Arena | Double Buffering")
+	bool IsNextArenaReady() const { return bNextArenaReady; }
+
+	//Fired when a prepared arena can be swapped in
+	UPROPERTY(BlueprintAssignable, Category = "Arena | Double Buffering")
+	FOnArenaBufferEvent OnNextArenaReady;
+
+	//Fired after the prepared arena was swapped in
+	UPROPERTY(BlueprintAssignable, Category = "Arena | Double Buffering")
+	FOnArenaBufferEvent OnArenaSwapped;
+
+	//Fired once every committed component has its physics bodies, when physics creation is deferred
+	UPROPERTY(BlueprintAssignable, Category = "Arena | Physics")
+	FOnArenaBufferEvent OnArenaCollidable;
+
+	UFUNCTION(BlueprintPure, Category = "Arena | Physics")
+	bool IsArenaCollidable() const { return PhysicsQueue.IsEmpty(); }
+
+	//Starts streaming the arena in height bands above what was already generated, one section of the section list per band, looping over the list.
+	//Continues from the cached origin offset, mesh size and tiles per side. Wipe the arena first to stream from the generator's origin.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Streaming")
+	void StartArenaStreaming();
+
+	//Stops planning new bands. Bands already generated are kept until the arena is wiped.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Streaming")
+	void StopArenaStreaming();
+
+	//Plans bands ahead of the viewer in the background and retires bands below it, recycling their instance slots and actors
+	UFUNCTION(BlueprintCallable, Category = "Arena | Streaming")
+	void UpdateArenaStreaming(const FVector& ViewerLocation);
+
+	UFUNCTION(BlueprintPure, Category = "Arena | Streaming")
+	bool IsArenaStreaming() const { return bStreaming; }
+
+	//Fired once the ground traces of a layout returned and the snapped layout was committed
+	UPROPERTY(BlueprintAssignable, Category = "Arena | Ground Snapping")
+	FOnArenaBufferEvent OnArenaGroundSnapped;
+
+	//True while a layout waits for its ground traces before being committed
+	UFUNCTION(BlueprintPure, Category = "Arena | Ground Snapping")
+	bool IsSnappingToGround() const;
+
+	//Tracks an actor whose proximity promotes Mass entity tiles to actors, updated every PromotionInterval
+	UFUNCTION(BlueprintCallable, Category = "Arena | Promotion")
+	void AddPromotionSource(AActor* Source);
+
+	//Stops tracking an actor. Tiles it promoted are demoted on the next update.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Promotion")
+	void RemovePromotionSource(AActor* Source);
+
+	//Promotes and demotes tiles around world locations. Called by the promotion timer with the tracked sources, or directly.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Promotion")
+	void UpdateProximityPromotion(const TArray<FVector>& SourceLocations);
+
+	//Names of the registered output sinks
+	UFUNCTION()
+	static TArray<FName> GetOutputSinkNames();
+
+	//Sink receiving the tiles of patterns placing this type, created from the registry on first use
+	IArenaOutputSink* GetOutputSink(ETypeToPlace AssetToPlace);
+
+	//Returns the index in MeshInstances of the components for a mesh group, creating them if needed
+	int32 FindOrCreateGroupInstances(FArenaInstanceSet& Target, int32 GroupIdx);
+
+	//Spawns an actor of class attached to this generator at a relative transform
+	AActor* SpawnArenaActor(FArenaInstanceSet& Target, TSubclassOf<AActor> ActorClass, const FTransform& RelativeTransform);
+
+	//Creates and registers an instanced mesh component attached to the root. Null class uses UInstancedStaticMeshComponent.
+	UInstancedStaticMeshComponent* CreateInstancedMeshComponent(UStaticMesh* Mesh, bool bHidden = false, UClass* ComponentClass = nullptr);
+
+	FArenaInstanceSet& GetActiveArena() { return ActiveArena; }
+
+	//Actor sink when actor patterns are represented as Mass entities, null otherwise
+	FArenaMassSink* GetMassSink();
+
+	//True if both output sinks allow the active arena to be moved to a new plan in place, see IArenaOutputSink::CanUpdateInPlace
+	bool CanUpdateActiveArenaInPlace();
+
+	//Gameplay state of every tile of the active arena. Game code registers its columns here.
+	FArenaTileStateTable& GetTileState() { return TileState; }
+
+	//Tiles within Radius of a world location having every bit of Mask set in a uint32 column. None column skips the flag test.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Tile State")
+	void QueryTilesInRadius(const FVector& WorldCenter, float Radius, FName FlagColumn, int32 Mask, TArray<int32>& OutTiles) const;
+
+	UFUNCTION(BlueprintPure, Category = "Arena | Tile State")
+	FVector GetTileWorldLocation(int32 Tile) const;
+
+	//Spawn points, cover and patrol loops of the active arena, relative to the generator
+	const FArenaAnnotations& GetAnnotations() const { return Annotations; }
+
+	//Random spawn point on a floor tile with at least MinClearance tiles to the floor's edge. False if there is none.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Annotations")
+	bool SampleSpawnPoint(const FRandomStream& Stream, int32 MinClearance, FVector& OutLocation) const;
+
+	//Random cover point against a wall, facing the wall. False if there is none.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Annotations")
+	bool SampleCoverPoint(const FRandomStream& Stream, FVector& OutLocation, FVector& OutFacing) const;
+
+	UFUNCTION(BlueprintPure, Category = "Arena | Annotations")
+	int32 GetNumPatrolLoops() const { return Annotations.PatrolLoops.Num(); }
+
+	//World locations of a patrol loop, the last point connects back to the first
+	UFUNCTION(BlueprintCallable, Category = "Arena | Annotations")
+	void GetPatrolLoop(int32 LoopIdx, TArray<FVector>& OutPoints) const;
+
+	//Walkability graph of the active arena, relative to the generator. Null without bBuildTileGraph. Shared so worker queries outlive arena swaps.
+	TSharedPtr<const FArenaTileGraph> GetTileGraph() const { return TileGraph; }
+
+	//Shortest path over the tile graph between the floors nearest to two world locations, in world space. False if there is none.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Tile Graph")
+	bool FindTilePath(const FVector& From, const FVector& To, TArray<FVector>& OutPoints) const;
+
+	//FindTilePath on a worker thread. OnComplete runs on the game thread.
+	void FindTilePathAsync(const FVector& From, const FVector& To, TFunction<void(bool, const TArray<FVector>&)>&& OnComplete) const;
+
+	//Flow field toward the floors nearest to world locations, built on a worker thread. OnComplete runs on the game thread, with a null field without a graph.
+	void BuildFlowFieldAsync(const TArray<FVector>& Goals, TFunction<void(TSharedPtr<const FArenaFlowField>)>&& OnComplete) const;
+
+	//Plans the layout of a seed without touching the world and rasterizes it from above, see FArenaLayoutRaster
+	void RasterizeLayout(int32 Seed, int32 Resolution, FArenaLayoutRaster& OutRaster) const;
+
+	//Rasterizes the tiles of the active arena from above, with its carved openings and ground snapping. Empty for baked and streamed arenas.
+	void RasterizeActiveArena(int32 Resolution, FArenaLayoutRaster& OutRaster) const;
+
+	//Top down texture of the active arena for minimaps, rasterized on the CPU. R = section, G = height, B = mesh group, A = occupied.
+	UFUNCTION(BlueprintCallable, Category = "Arena | Minimap")
+	UTexture2D* CreateMinimapTexture(int32 Resolution = 512) const;
 
 private:
 
-	//Calculates the definitive parameters of the section to be generated.
-	virtual void CalculateSectionParameters(FArenaSection& Section);
+	//Moves the instances and actors of the active arena to a new plan in place, and rebuilds the state that follows the plan
+	void UpdateActiveArena(const FArenaLayoutPlan& Plan);
+
+	//Shares a copy of a plan's graph, or drops the current one if the plan has none
+	void SetTileGraph(const FArenaTileGraph& Graph);
+
+	//Keeps the tiles of a plan committed to the active arena, replacing the previous plans or added after them
+	void SetActivePlan(const FArenaLayoutPlan& Plan, bool bAppend);
+
+	//Traces the ground under the snapped sections of a plan, one async trace per lattice column. Once every trace returned the plan
+	//is committed to its target. False if the plan has nothing to snap, or was snapped right away with blocking traces while baking.
+	bool StartGroundSnap(FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, EArenaGroundSnapTarget Target, bool bUpdateInPlace = false);
+	void OnGroundTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum, EArenaGroundSnapTarget Target);
+	void FinishGroundSnap(EArenaGroundSnapTarget Target);
+	void CancelGroundSnap(EArenaGroundSnapTarget Target);
+	void CancelGroundSnaps();
+
+	//Moves the columns of a plan onto their ground and rebuilds what was built from the tiles before they moved. Returns the number of moved tiles.
+	static int32 ApplyGroundColumns(FArenaLayoutPlan& Plan, const FArenaLayoutInputs& Inputs, TConstArrayView<FArenaGroundColumn> Columns);
+
+	//Creates components and spawns actors for every tile of a plan
+	void CommitPlan(const FArenaLayoutPlan& Plan, FArenaInstanceSet& Target);
+
+	//Feeds every pattern of a plan to the output sinks, which create components in Target and queue instances and actors
+	void QueueCommit(const FArenaLayoutPlan& Plan, FArenaInstanceSet& Target, FArenaCommitQueue& OutQueue);
+
+	//Updates Target in place to match a plan, overwriting existing instances and only adding or removing the difference
+	void UpdateInstanceSet(const FArenaLayoutPlan& Plan, FArenaInstanceSet& Target);
+
+	//Adds queued instances and spawns queued actors into Target. Returns true once the queue is done.
+	bool ProcessCommitQueue(FArenaCommitQueue& Queue, FArenaInstanceSet& Target, int32 InstanceBudget, int32 ActorBudget);
+
+	//Copies the planner state back into the generator and its visible parameters
+	void ApplyPlannerState(const FArenaPlannerState& State);
+
+	//Destroys every component and actor of a set and empties it
+	void DestroyInstanceSet(FArenaInstanceSet& Set);
+
+	//Shows a hidden set and restores its collision, or hides it and makes it ignore collision
+	void SetInstanceSetRevealed(FArenaInstanceSet& Set, bool bRevealed);
+
+	//Requests the textures of every component and actor of a set, so a hidden set is sharp when it is revealed
+	void PrestreamInstanceSet(FArenaInstanceSet& Set, float Seconds);
+
+	//Reveals the next arena and retires the active one
+	void CompleteSwapToNextArena();
+
+	//Lets the generator's components of a set affect navigation. Their octree updates are applied together.
+	void SetInstanceSetAffectsNavigation(FArenaInstanceSet& Set, bool bAffectsNavigation);
+
+	//World bounds of every component and actor of a set
+	FBox GetInstanceSetBounds(const FArenaInstanceSet& Set) const;
+
+	//Dirties the navmesh over Bounds in one region or in chunks, and times the rebuild
+	void SubmitNavigationUpdate(const FBox& Bounds);
+
+	//Waits for the navigation rebuild to finish, then reports it and completes a pending swap
+	void TickNavigationBuild();
+
+	//Queues the components of a set created without physics, once all of their instances are added
+	void QueueInstanceSetPhysics(FArenaInstanceSet& Set);
+
+	//Creates the bodies of queued components within the frame budget, rescheduling itself until the queue is empty
+	void TickPhysicsCreation();
+
+	//Called on the game thread once the background plan of the next arena is ready
+	void OnNextArenaPlanned(int32 RequestId, TSharedPtr<FArenaLayoutPlan> Plan, const FArenaPlannerState& State, TSharedPtr<const FArenaLayoutInputs> Inputs);
 
-	FORCEINLINE float CalculateOpposite(float length, float angle);
-	FORCEINLINE float CalculateAdjacent(float length, float angle);
-	FORCEINLINE FVector ForwardVectorFromYaw(float yaw);
+	//Advances preparation of the next arena by one frame worth of work
+	void TickNextArenaPreparation();
 
-	//Returns a scalar vector to multiply a mesh size to get the necessary off such that the mesh spans positively across X and Y axes from the origin. Optimized for absolute directions, incorrect for angled directions.
-	FVector RotatedMeshOffset(EOriginPlacementType OriginType, FVector& MeshSize, int RotationIndex);
+	//Releases part of the retired arenas, rescheduling itself until they are gone
+	void TickArenaRelease();
 
-	//Offsets mesh along FV and RV based on origin type. Optimized for angled directions.
-	FVector OffsetMeshAlongDirections(const FVector& FV, const FVector& RV, EOriginPlacementType OriginType, const FVector& MeshSize, int RotationIndex);
+	//Plans the next band on a worker thread
+	void RequestStreamBand();
 
-	//Returns a scalar vector to multiply a mesh size with to get the necessary offset such that the origin sits in the center of the mesh.
-	FORCEINLINE FVector OriginOffsetScalar(EOriginPlacementType OriginType);
+	//Called on the game thread once a band is planned
+	void OnStreamBandPlanned(int32 RequestId, TSharedPtr<FArenaLayoutPlan> Plan, const FArenaPlannerState& State, const FRandomStream& Stream);
 
-	//Adds concavity to a 2-dimensional grid of columns and rows in a direction amplified by concavity strength.
-	FVector PlacementWarpingConcavity(int ColMidpoint, int RowMidpoint, int Col, int Row, float ConcavityStrength, FVector WarpDirection);
+	//Commits a band on top of the streamed arena and lets the next one be requested
+	void AddStreamBand(const FArenaLayoutPlan& Plan, FArenaStreamBand&& Band);
 
-	//Randomly offsets by negative and positive values of the OffsetRanges along directions. X input will be driven by Forward vector, Y input will be driven by Right vector. Z-axis will be driven by z value
-	FVector PlacementWarpingDirectional(FVector OffsetRanges, const FVector& DirFV, const FVector& DirRV);
+	//Places a planned band into free instance slots and pooled actors before adding new ones
+	void CommitStreamBand(const FArenaLayoutPlan& Plan, FArenaStreamBand& Band);
 
-	//Given an angle of rotation, offsets mesh to the center
-	FVector OffsetMeshToCenter(EOriginPlacementType OriginType, const FVector& MeshSize, float angle);
+	//Hides the slots and actors of a band and returns them to the pools
+	void RetireStreamBand(FArenaStreamBand& Band);
+
+	//Clears all streaming state, does not destroy components
+	void ResetStreaming();
+
+	//Updates promotion with the locations of the tracked sources
+	void TickProximityPromotion();
 
 public:
 //The values here are not meant to be directly modified by user input. 
@@ -147,9 +512,9 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Generation Rules")
 	bool bLoadMeshesAsync = false;
 
-	//TODO - map hierarchical instances as well
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Generation Rules")
-	bool bUseHierarchicalInstances = false;
+	//Deprecated, hierarchical instances are selected with MeshSinkName. Loaded generators that set it switch to the HISM sink.
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Select the HISM output sink with MeshSinkName instead."))
+	bool bUseHierarchicalInstances_DEPRECATED = false;
 
 	//Determines how many sides can the polygonal arena have. 
 	//WARNING: Consider Tiles per side and build rules! 
@@ -160,6 +525,55 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Generation Rules")
 	int32 MaxTilesPerSideRow = 100;
 
+	//Drops tiles coincident with another tile once a layout is planned, such as walls and floors meeting at the ring edge.
+	//Build rules with a higher DuplicatePriority keep their tiles.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Generation Rules")
+	bool bRemoveDuplicateTiles = false;
+
+	//Distance under which two tiles are coincident
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Generation Rules", meta = (EditCondition = "bRemoveDuplicateTiles", ClampMin = "0.01"))
+	float DuplicateTolerance = 1.f;
+
+	//Tiles are coincident whatever their yaw, otherwise their yaw must match within a degree
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Generation Rules", meta = (EditCondition = "bRemoveDuplicateTiles"))
+	bool bDuplicatesIgnoreYaw = false;
+
+	//Builds spawn points, cover and patrol loops with each layout, and bakes them with it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Annotations")
+	bool bBuildAnnotations = true;
+
+	//Distance between the inner face of a wall and its cover points
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Annotations", meta = (EditCondition = "bBuildAnnotations"))
+	float CoverOffset = 50.f;
+
+	//Distance between the inner face of the walls and the patrol loop of their ring
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Annotations", meta = (EditCondition = "bBuildAnnotations"))
+	float PatrolInset = 300.f;
+
+	//Builds a walkability graph over the floor tiles of each layout, for tile based pathing without a navmesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Tile Graph")
+	bool bBuildTileGraph = false;
+
+	//Highest height difference between two linked floors
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Tile Graph", meta = (EditCondition = "bBuildTileGraph", ClampMin = "0"))
+	float GraphMaxStepHeight = 50.f;
+
+	//Free height a floor needs above it to be walkable
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Tile Graph", meta = (EditCondition = "bBuildTileGraph", ClampMin = "1"))
+	float GraphAgentHeight = 180.f;
+
+	//Links diagonal floors of a grid when both floors beside them are linked
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Tile Graph", meta = (EditCondition = "bBuildTileGraph"))
+	bool bGraphDiagonals = true;
+
+	//Largest height change of a tile column of a section snapped to the ground. Columns without ground within this distance stay in place.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Ground Snapping", meta = (ClampMin = "0"))
+	float GroundSnapMaxAdjust = 200.f;
+
+	//Channel of the ground traces
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Ground Snapping")
+	TEnumAsByte<ECollisionChannel> GroundTraceChannel = ECC_WorldStatic;
+
 #pragma endregion
 
 #pragma region User Inputs - Patterns
@@ -175,31 +589,261 @@ public:
 
 #pragma endregion
 
+#pragma region User Inputs - Baking
+
+	//If set, the bake commandlet generates this arena at cook time and game worlds restore the baked layout instead of building sections.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Baking")
+	bool bBakeAtCook = false;
+
+	//Where the baked layout is stored
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Baking", meta = (EditCondition = "bBakeAtCook"))
+	EArenaBakeTarget BakeTarget = EArenaBakeTarget::Level;
+
+	//Sidecar asset used when baking to SidecarAsset. Created by the bake commandlet if left empty.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Baking", meta = (EditCondition = "bBakeAtCook"))
+	UArenaBakedLayoutAsset* BakedLayoutAsset = nullptr;
+
+	//Layout baked into the level
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Arena Parameters | Baking")
+	FArenaBakedLayout BakedLayout;
+
+#pragma endregion
+
+#pragma region User Inputs - Output
+
+	//Output sink receiving static mesh patterns. ISM and HISM are built in, projects can register their own.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Output", meta = (GetOptions = "GetOutputSinkNames"))
+	FName MeshSinkName = TEXT("ISM");
+
+	//Output sink receiving actor patterns
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Output", meta = (GetOptions = "GetOutputSinkNames"))
+	FName ActorSinkName = TEXT("Actors");
+
+#pragma endregion
+
+#pragma region User Inputs - Double Buffering
+
+	//How many instances are added to the next arena per frame while it is prepared
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Double Buffering", meta = (ClampMin = "1"))
+	int32 PrepareInstancesPerFrame = 4096;
+
+	//How many actors are spawned for the next arena per frame while it is prepared
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Double Buffering", meta = (ClampMin = "1"))
+	int32 PrepareActorsPerFrame = 32;
+
+	//How many components or actors of a swapped out arena are destroyed per frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Double Buffering", meta = (ClampMin = "1"))
+	int32 ReleaseObjectsPerFrame = 16;
+
+	//Seconds of texture prestreaming requested for the next arena's meshes while it is hidden
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Double Buffering", meta = (ClampMin = "0"))
+	float PrestreamSeconds = 5.f;
+
+#pragma endregion
+
+#pragma region User Inputs - Navigation
+
+	//Components are created without affecting navigation and enabled together once the commit is done, followed by a single dirty region.
+	//Avoids rebuilding navmesh tiles for every instance added. The navmesh is behind the arena until that rebuild is done.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Navigation")
+	bool bBatchNavigationUpdates = false;
+
+	//Size of the dirty regions the arena bounds are split into. 0 dirties the whole bounds as one region.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Navigation", meta = (ClampMin = "0", EditCondition = "bBatchNavigationUpdates"))
+	float NavigationDirtyChunkSize = 0.f;
+
+	//Builds the navmesh of a prepared arena before swapping it in. It stays without collision and is exported as navigable geometry
+	//for the build, while the active arena stays in the navmesh until the swap.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Navigation", meta = (EditCondition = "bBatchNavigationUpdates"))
+	bool bBuildNavigationBeforeSwap = false;
+
+	//Seconds after which a swap waiting on navigation completes anyway. Also how long a submitted rebuild may take to start before it is given up on.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Navigation", meta = (ClampMin = "0", EditCondition = "bBatchNavigationUpdates"))
+	float NavigationBuildTimeout = 10.f;
+
+	//Time the last navigation rebuild of the arena took
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Arena Parameters | Navigation")
+	float LastNavigationBuildSeconds = 0.f;
+
+#pragma endregion
+
+#pragma region User Inputs - Physics
+
+	//Components are registered without collision and get their bodies over the next frames once their instances are added,
+	//instead of creating a body per instance inside the generation loop. Arenas are not collidable right after generating, see IsArenaCollidable.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Physics")
+	bool bDeferPhysicsCreation = false;
+
+	//Instance bodies created per frame, charged one whole component at a time. At least one component is processed every frame.
+	//Instanced components create all of their bodies when their collision is enabled, so a component with more instances than the
+	//budget still creates them in a single frame. Spread very large patterns over several meshes to keep that frame short.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Physics", meta = (ClampMin = "1", EditCondition = "bDeferPhysicsCreation"))
+	int32 PhysicsBodiesPerFrame = 2000;
+
+#pragma endregion
+
+#pragma region User Inputs - Promotion
+
+	//Mass entity tiles closer than this to a promotion source become actors
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Promotion", meta = (ClampMin = "0"))
+	float PromotionRadius = 1500.f;
+
+	//Extra distance a source must move away before a promoted tile is demoted again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Promotion", meta = (ClampMin = "0"))
+	float PromotionHysteresis = 300.f;
+
+	//Seconds between updates of the tracked sources
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Promotion", meta = (ClampMin = "0.01"))
+	float PromotionInterval = 0.2f;
+
+	//How many tiles are promoted or demoted per update at most
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Promotion", meta = (ClampMin = "1"))
+	int32 MaxPromotionsPerUpdate = 64;
+
+#pragma endregion
+
+#pragma region User Inputs - Streaming
+
+	//Height above the viewer up to which bands are generated
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Streaming", meta = (ClampMin = "0"))
+	float StreamAheadDistance = 5000.f;
+
+	//Bands whose top is further than this below the viewer are retired
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Arena Parameters | Streaming", meta = (ClampMin = "0"))
+	float StreamRetireDistance = 2000.f;
+
+#pragma endregion
+
 private:
 
 #pragma region Section Exclusives
 
-	//Based on build order rules, arena parameters are calculated with dependencies from user-input parameters.
-	//Using grid based build order rules requires the first pattern with section-type of horizontal grid to be used as reference
-	//Will use index 0 if it fails to find a grid-type pattern with horizontal grid build rules.
-	int FocusGridIndex = 0;
+	//Arena currently in play
+	FArenaInstanceSet ActiveArena;
 
-	//Based on build order rules, arena parameters are calculated with dependencies from user-input parameters.
-	//Using polygon based build order rules requires the first patterns with polygon build rules to be used as reference.
-	//Will use index 0 if it fails to find a polygon-type pattern with polygonal build rules.
-	int FocusPolygonIndex = 0;
+	//Cached Values, carried between sections and patterns (origin offset, previous mesh size...)
+	FArenaPlannerState PlannerState;
 
-	FVector OriginOffset = FVector(0);
-	TArray<TArray<UInstancedStaticMeshComponent*>> MeshInstances;
-	TArray<AActor*> SpawnedActors;
-	TArray<int32> UsedGroupIndices;
+	//One row per planned tile of the active arena
+	FArenaTileStateTable TileState;
+
+	//Gameplay locations of the active arena, relative to the generator
+	FArenaAnnotations Annotations;
+
+	//Floor connectivity of the active arena, rebuilt with each layout
+	TSharedPtr<const FArenaTileGraph> TileGraph;
+
+	//Patterns and tiles of the active arena without annotations or graph, for queries over the whole arena such as its minimap
+	TSharedPtr<const FArenaLayoutPlan> ActivePlan;
+
+	//Stream the active arena was planned from, unset when it does not match a plan of the section list
+	TOptional<FRandomStream> ActiveArenaStream;
+
+#pragma endregion
+
+#pragma region Ground Snapping
+
+	//Pass of each target, so the next arena or a band can snap while the active arena does
+	FArenaGroundSnapPass GroundSnapPasses[(int32)EArenaGroundSnapTarget::Num];
+
+	//Set while baking. The layout is captured right after it is built and commandlets never tick the world, so traces are blocking.
+	bool bBlockingGroundSnap = false;
+
+#pragma endregion
+
+#pragma region Output
+
+	//Sinks created from MeshSinkName and ActorSinkName, recreated when the names change
+	TSharedPtr<IArenaOutputSink> MeshSink;
+	TSharedPtr<IArenaOutputSink> ActorSink;
+	FName CreatedMeshSinkName;
+	FName CreatedActorSinkName;
+
+#pragma endregion
+
+#pragma region Double Buffering
+
+	//Arena being prepared hidden, swapped in by SwapToNextArena
+	FArenaInstanceSet NextArena;
+	FArenaCommitQueue NextArenaQueue;
+	FArenaPlannerState NextArenaState;
+
+	//Kept until the swap to rebuild the tile state table
+	TSharedPtr<FArenaLayoutPlan> NextArenaPlan;
+	int32 NextArenaSeed = 0;
+
+	//Incremented on every request so stale background plans are dropped
+	int32 NextArenaRequestId = 0;
+	bool bPreparingNextArena = false;
+	bool bNextArenaReady = false;
+
+	//Pending commit tick of the prepared arena, cleared on cancel so a stale tick cannot finish a newer request
+	FTimerHandle NextArenaTimerHandle;
+
+	//Swapped out arenas waiting to be destroyed
+	TArray<FArenaInstanceSet> RetiredArenas;
+	FTimerHandle ReleaseTimerHandle;
+
+#pragma endregion
+
+#pragma region Streaming
+
+	//Bands currently generated, from lowest to highest
+	TArray<FArenaStreamBand> StreamBands;
+
+	//Slots of retired bands, reused before any instance is added
+	TMap<UInstancedStaticMeshComponent*, TArray<int32>> FreeStreamSlots;
+	TMap<UClass*, TArray<AActor*>> FreeStreamActors;
+
+	//Planner inputs, state and stream carried from one band to the next
+	TSharedPtr<FArenaLayoutInputs> StreamInputs;
+	FArenaPlannerState StreamState;
+	FRandomStream StreamRandom;
+	int32 StreamSectionIdx = 0;
+
+	int32 StreamRequestId = 0;
+	bool bStreaming = false;
+	bool bStreamBandInFlight = false;
+
+	//Band waiting for its ground traces before it is committed
+	FArenaStreamBand SnappingStreamBand;
+
+#pragma endregion
+
+#pragma region Navigation
+
+	double NavigationBuildStartTime = 0.0;
+	FTimerHandle NavigationBuildTimerHandle;
+	bool bNavigationBuildPending = false;
+
+	//Set once the pending rebuild was seen in progress, it only counts as done after that
+	bool bNavigationBuildStarted = false;
+
+	//Swap started with bBuildNavigationBeforeSwap, completed by TickNavigationBuild
+	bool bSwapAwaitingNavigation = false;
+
+#pragma endregion
+
+#pragma region Physics
+
+	//Collision each component was created with, restored when its bodies are created
+	TMap<TWeakObjectPtr<UInstancedStaticMeshComponent>, TEnumAsByte<ECollisionEnabled::Type>> DeferredPhysics;
+
+	//Components whose instances are all added, waiting for their bodies
+	TArray<TWeakObjectPtr<UInstancedStaticMeshComponent>> PhysicsQueue;
+	int32 PhysicsQueueIdx = 0;
+	double PhysicsStartTime = 0.0;
+	FTimerHandle PhysicsTimerHandle;
+
+	//Navigation is dirtied once bodies exist, collision-less components are not part of the navmesh
+	FBox PendingNavigationBounds = FBox(ForceInit);
+
+#pragma endregion
+
+#pragma region Promotion
 
-	//Cached Values
-	EArenaBuildOrderRules CurrentBOR = EArenaBuildOrderRules::PolygonLeadByRadius;
-	FVector PreviousMeshSize = FVector(0.f);
-	int PreviousTilesPerSide = 0;
-	FVector PreviousLastPosition = FVector(0.f);
-	int TotalInstances;
+	TArray<TWeakObjectPtr<AActor>> PromotionSources;
+	FTimerHandle PromotionTimerHandle;
 
 #pragma endregion
 };
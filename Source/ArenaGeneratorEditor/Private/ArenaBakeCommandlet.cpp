@@ -0,0 +1,220 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaBakeCommandlet.h"
+#include "BaseArenaGenerator.h"
+#include "ArenaBakedLayoutAsset.h"
+#include "ArenaCommandletUtils.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogArenaBake, Log, All);
+
+UArenaBakeCommandlet::UArenaBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UArenaBakeCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Maps;
+	GatherMaps(Params, Maps);
+
+	if (Maps.IsEmpty())
+	{
+		UE_LOG(LogArenaBake, Warning, TEXT("No maps to process."));
+		return 0;
+	}
+
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+
+	//Collecting garbage after every map is slow, never collecting runs out of memory on large batches
+	int32 GCInterval = 16;
+	FParse::Value(*Params, TEXT("GCInterval="), GCInterval);
+	GCInterval = FMath::Max(GCInterval, 1);
+
+	int32 FailedMaps = 0;
+	int32 TotalBaked = 0;
+
+	for (int32 MapIdx = 0; MapIdx < Maps.Num(); ++MapIdx)
+	{
+		UE_LOG(LogArenaBake, Display, TEXT("[%d/%d] %s"), MapIdx + 1, Maps.Num(), *Maps[MapIdx]);
+
+		int32 BakedGenerators = 0;
+		if (!BakeMap(Maps[MapIdx], bSave, BakedGenerators))
+		{
+			FailedMaps++;
+		}
+		TotalBaked += BakedGenerators;
+
+		if ((MapIdx + 1) % GCInterval == 0)
+		{
+			CollectGarbage(RF_NoFlags);
+		}
+	}
+
+	UE_LOG(LogArenaBake, Display, TEXT("Baked %d generators across %d maps, %d failed."), TotalBaked, Maps.Num(), FailedMaps);
+
+	return FailedMaps > 0 ? 1 : 0;
+}
+
+void UArenaBakeCommandlet::GatherMaps(const FString& Params, TArray<FString>& OutMaps) const
+{
+	FString MapList;
+	if (FParse::Value(*Params, TEXT("Maps="), MapList, false))
+	{
+		MapList.ParseIntoArray(OutMaps, TEXT("+"), true);
+		return;
+	}
+
+	FString MapPath = TEXT("/Game");
+	FParse::Value(*Params, TEXT("MapPath="), MapPath);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UWorld::StaticClass()->GetClassPathName());
+	Filter.PackagePaths.Add(*MapPath);
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> MapAssets;
+	AssetRegistry.GetAssets(Filter, MapAssets);
+
+	for (const FAssetData& MapAsset : MapAssets)
+	{
+		OutMaps.AddUnique(MapAsset.PackageName.ToString());
+	}
+}
+
+bool UArenaBakeCommandlet::BakeMap(const FString& MapPackageName, bool bSave, int32& OutBakedGenerators)
+{
+	OutBakedGenerators = 0;
+
+	UPackage* MapPackage = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogArenaBake, Error, TEXT("Could not load map %s"), *MapPackageName);
+		return false;
+	}
+
+	//Components need a registered world to be created and instanced, and ground snapping traces against it
+	World->AddToRoot();
+	const bool bInitializedWorld = !World->bIsWorldInitialized;
+	if (bInitializedWorld)
+	{
+		World->WorldType = EWorldType::Editor;
+		World->InitWorld(UWorld::InitializationValues()
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(true)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	bool bSuccess = true;
+	TArray<UPackage*> PackagesToSave;
+
+	for (TActorIterator<ABaseArenaGenerator> It(World); It; ++It)
+	{
+		ABaseArenaGenerator* Generator = *It;
+		if (!Generator->bBakeAtCook) { continue; }
+
+		if (BakeGenerator(Generator, MapPackageName, PackagesToSave))
+		{
+			OutBakedGenerators++;
+		}
+		else
+		{
+			bSuccess = false;
+		}
+	}
+
+	if (bSave)
+	{
+		for (UPackage* Package : PackagesToSave)
+		{
+			const bool bIsMap = Package == MapPackage;
+			UObject* Asset = bIsMap ? static_cast<UObject*>(World) : Package->FindAssetInPackage();
+
+			if (!ArenaCommandletUtils::SavePackage(Package, Asset, bIsMap ? FPackageName::GetMapPackageExtension() : FPackageName::GetAssetPackageExtension()))
+			{
+				bSuccess = false;
+			}
+		}
+	}
+
+	if (bInitializedWorld)
+	{
+		World->CleanupWorld();
+	}
+	World->RemoveFromRoot();
+
+	return bSuccess;
+}
+
+bool UArenaBakeCommandlet::BakeGenerator(ABaseArenaGenerator* Generator, const FString& MapPackageName, TArray<UPackage*>& OutPackagesToSave)
+{
+	if (Generator->BakeTarget == EArenaBakeTarget::SidecarAsset && !Generator->BakedLayoutAsset)
+	{
+		//Sidecar lives next to the map, named after it and the generator
+		const FString AssetName = FString::Printf(TEXT("%s_%s_BakedArena"), *FPackageName::GetShortName(MapPackageName), *Generator->GetName());
+		UArenaBakedLayoutAsset* Asset = ArenaCommandletUtils::CreateLayoutAsset(FPackageName::GetLongPackagePath(MapPackageName), AssetName);
+
+		Generator->Modify();
+		Generator->BakedLayoutAsset = Asset;
+	}
+
+	const bool bBaked = Generator->BakeArenaLayout();
+
+	//Baked data is what gets saved, not the generated components
+	Generator->WipeArena();
+
+	if (!bBaked)
+	{
+		UE_LOG(LogArenaBake, Error, TEXT("Failed to bake %s in %s"), *Generator->GetName(), *MapPackageName);
+		return false;
+	}
+
+	OutPackagesToSave.AddUnique(Generator->GetPackage());
+
+	if (Generator->BakeTarget == EArenaBakeTarget::SidecarAsset)
+	{
+		Generator->BakedLayoutAsset->Source = MapPackageName;
+		OutPackagesToSave.AddUnique(Generator->BakedLayoutAsset->GetPackage());
+	}
+
+	return true;
+}
@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaBatchLayoutCommandlet.h"
+#include "BaseArenaGenerator.h"
+#include "ArenaLayoutPlanner.h"
+#include "ArenaLayoutRaster.h"
+#include "ArenaBakedLayoutAsset.h"
+#include "ArenaCommandletUtils.h"
+#include "Async/ParallelFor.h"
+#include "Engine/DataTable.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/BufferArchive.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogArenaBatchLayout, Log, All);
+
+UArenaBatchLayoutCommandlet::UArenaBatchLayoutCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UArenaBatchLayoutCommandlet::Main(const FString& Params)
+{
+	FString GeneratorPath;
+	if (!FParse::Value(*Params, TEXT("Generator="), GeneratorPath))
+	{
+		UE_LOG(LogArenaBatchLayout, Error, TEXT("Missing -Generator=<generator class path>."));
+		return 1;
+	}
+
+	UClass* GeneratorClass = LoadClass<ABaseArenaGenerator>(nullptr, *GeneratorPath);
+	if (!GeneratorClass)
+	{
+		UE_LOG(LogArenaBatchLayout, Error, TEXT("Could not load generator class %s"), *GeneratorPath);
+		return 1;
+	}
+
+	TArray<FArenaLayoutInputs> Variants;
+	if (!GatherVariants(Params, GetDefault<ABaseArenaGenerator>(GeneratorClass), Variants))
+	{
+		return 1;
+	}
+
+	int32 NumSeeds = 1;
+	int32 FirstSeed = 0;
+	FParse::Value(*Params, TEXT("Seeds="), NumSeeds);
+	FParse::Value(*Params, TEXT("FirstSeed="), FirstSeed);
+	NumSeeds = FMath::Max(NumSeeds, 1);
+
+	//Top down rasters of every layout, skipped without a resolution
+	int32 RasterResolution = 0;
+	FParse::Value(*Params, TEXT("Raster="), RasterResolution);
+
+	//Every (variant, seed) pair is an independent job
+	const int32 NumJobs = Variants.Num() * NumSeeds;
+	TArray<FArenaBakedLayout> Layouts;
+	Layouts.SetNum(NumJobs);
+
+	TArray<FArenaLayoutRaster> Rasters;
+	Rasters.SetNum(RasterResolution > 0 ? NumJobs : 0);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	ParallelFor(NumJobs, [&Variants, &Layouts, &Rasters, NumSeeds, FirstSeed, RasterResolution](int32 JobIdx)
+	{
+		const FArenaLayoutInputs& Inputs = Variants[JobIdx / NumSeeds];
+
+		FArenaLayoutPlanner Planner(Inputs, FRandomStream(FirstSeed + (JobIdx % NumSeeds)));
+		FArenaLayoutPlan Plan;
+		Planner.PlanLayout(Plan);
+
+		Layouts[JobIdx] = FArenaLayoutPlanner::BakePlan(Plan, Inputs);
+
+		if (RasterResolution > 0) {
+			FArenaLayoutRaster::Rasterize(Plan, Inputs, RasterResolution, Rasters[JobIdx]);
+		}
+	});
+
+	UE_LOG(LogArenaBatchLayout, Display, TEXT("Planned %d layouts in %.2f ms"), NumJobs, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	FString OutPath = TEXT("/Game/ArenaPool");
+	FParse::Value(*Params, TEXT("OutPath="), OutPath);
+
+	FString StatsFile = FPaths::ProjectSavedDir() / TEXT("ArenaBatchLayout") / TEXT("Stats.csv");
+	FParse::Value(*Params, TEXT("Stats="), StatsFile);
+
+	FString RasterDir = FPaths::ProjectSavedDir() / TEXT("ArenaBatchLayout") / TEXT("Rasters");
+	FParse::Value(*Params, TEXT("RasterDir="), RasterDir);
+
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+	int32 FailedSaves = 0;
+
+	FString Csv = TEXT("Asset,Variant,Seed,MeshInstances,Actors,BoundsMinX,BoundsMinY,BoundsMinZ,BoundsMaxX,BoundsMaxY,BoundsMaxZ,MemoryBytes\n");
+
+	for (int32 JobIdx = 0; JobIdx < NumJobs; ++JobIdx)
+	{
+		FArenaBakedLayout& Layout = Layouts[JobIdx];
+		const FArenaLayoutStats& Stats = Layout.Stats;
+		const FString AssetName = FString::Printf(TEXT("ArenaLayout_V%d_S%d"), JobIdx / NumSeeds, Layout.Seed);
+
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%lld\n"),
+			*AssetName, JobIdx / NumSeeds, Layout.Seed, Stats.NumMeshInstances, Stats.NumActors,
+			Stats.Bounds.Min.X, Stats.Bounds.Min.Y, Stats.Bounds.Min.Z, Stats.Bounds.Max.X, Stats.Bounds.Max.Y, Stats.Bounds.Max.Z,
+			Stats.MemoryBytes);
+
+		if (Rasters.IsValidIndex(JobIdx))
+		{
+			FBufferArchive RasterData;
+			RasterData << Rasters[JobIdx];
+
+			const FString RasterFile = RasterDir / (AssetName + TEXT(".raster"));
+			if (!FFileHelper::SaveArrayToFile(RasterData, *RasterFile))
+			{
+				UE_LOG(LogArenaBatchLayout, Warning, TEXT("Could not write raster to %s"), *RasterFile);
+			}
+		}
+
+		if (!bSave) { continue; }
+
+		UArenaBakedLayoutAsset* Asset = ArenaCommandletUtils::CreateLayoutAsset(OutPath, AssetName);
+		Asset->Layout = MoveTemp(Layout);
+		Asset->Source = GeneratorPath;
+
+		if (!ArenaCommandletUtils::SavePackage(Asset->GetPackage(), Asset, FPackageName::GetAssetPackageExtension()))
+		{
+			FailedSaves++;
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *StatsFile))
+	{
+		UE_LOG(LogArenaBatchLayout, Warning, TEXT("Could not write stats to %s"), *StatsFile);
+	}
+
+	UE_LOG(LogArenaBatchLayout, Display, TEXT("Wrote %d layouts, stats in %s, %d failed."), NumJobs, *StatsFile, FailedSaves);
+
+	return FailedSaves > 0 ? 1 : 0;
+}
+
+bool UArenaBatchLayoutCommandlet::GatherVariants(const FString& Params, const ABaseArenaGenerator* Generator, TArray<FArenaLayoutInputs>& OutVariants) const
+{
+	const FArenaLayoutInputs BaseInputs = Generator->GatherLayoutInputs();
+
+	FString VariantList;
+	if (!FParse::Value(*Params, TEXT("Variants="), VariantList, false))
+	{
+		OutVariants.Add(BaseInputs);
+		return true;
+	}
+
+	TArray<FString> TablePaths;
+	VariantList.ParseIntoArray(TablePaths, TEXT("+"), true);
+
+	for (const FString& TablePath : TablePaths)
+	{
+		const UDataTable* Table = LoadObject<UDataTable>(nullptr, *TablePath);
+		if (!Table || !Table->GetRowStruct() || !Table->GetRowStruct()->IsChildOf(FArenaSection::StaticStruct()))
+		{
+			UE_LOG(LogArenaBatchLayout, Error, TEXT("%s is not a data table of Arena Sections."), *TablePath);
+			return false;
+		}
+
+		FArenaLayoutInputs& Variant = OutVariants.Add_GetRef(BaseInputs);
+		Variant.SectionList.Reset();
+
+		TArray<FArenaSection*> Rows;
+		Table->GetAllRows<FArenaSection>(TEXT("ArenaBatchLayout"), Rows);
+
+		for (const FArenaSection* Row : Rows)
+		{
+			Variant.SectionList.Add(*Row);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ArenaCommandletUtils.h"
+#include "ArenaBakedLayoutAsset.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogArenaCommandlet, Log, All);
+
+bool ArenaCommandletUtils::SavePackage(UPackage* Package, UObject* Asset, const FString& Extension)
+{
+	const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), Extension);
+
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	SaveArgs.SaveFlags = SAVE_NoError;
+
+	if (!UPackage::SavePackage(Package, Asset, *Filename, SaveArgs))
+	{
+		UE_LOG(LogArenaCommandlet, Error, TEXT("Failed to save %s"), *Filename);
+		return false;
+	}
+
+	return true;
+}
+
+UArenaBakedLayoutAsset* ArenaCommandletUtils::CreateLayoutAsset(const FString& PackagePath, const FString& AssetName)
+{
+	UPackage* AssetPackage = CreatePackage(*(PackagePath / AssetName));
+	UArenaBakedLayoutAsset* Asset = NewObject<UArenaBakedLayoutAsset>(AssetPackage, *AssetName, RF_Public | RF_Standalone);
+	FAssetRegistryModule::AssetCreated(Asset);
+
+	return Asset;
+}
@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ArenaBakeCommandlet.generated.h"
+
+class ABaseArenaGenerator;
+class UWorld;
+
+/**
+ * Bakes every arena generator flagged with bBakeAtCook in a batch of maps.
+ *
+ * Usage: -run=ArenaBake [-Maps=/Game/MapA+/Game/MapB] [-MapPath=/Game] [-GCInterval=16] [-NoSave]
+ * Without -Maps, every map found under MapPath is processed.
+ */
+UCLASS()
+class UArenaBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UArenaBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	//Gathers the long package names of the maps to process
+	void GatherMaps(const FString& Params, TArray<FString>& OutMaps) const;
+
+	//Loads a map, bakes its generators and saves what changed. Returns false on failure.
+	bool BakeMap(const FString& MapPackageName, bool bSave, int32& OutBakedGenerators);
+
+	//Bakes a single generator into its bake target, creating the sidecar asset if needed
+	bool BakeGenerator(ABaseArenaGenerator* Generator, const FString& MapPackageName, TArray<UPackage*>& OutPackagesToSave);
+};
@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Georges Brunet
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ArenaBatchLayoutCommandlet.generated.h"
+
+class ABaseArenaGenerator;
+struct FArenaLayoutInputs;
+
+/**
+ * Plans a pool of arena layouts for many seeds, and optionally section list variants, in parallel.
+ * Each layout is saved as an Arena Baked Layout asset and its stats are written to a CSV file.
+ * No world is loaded, layouts only depend on the generator class defaults.
+ * With -Raster each layout is also rasterized from above and written as a raw FArenaLayoutRaster file.
+ *
+ * Usage: -run=ArenaBatchLayout -Generator=/Game/Path/BP_Arena.BP_Arena_C [-Seeds=64] [-FirstSeed=0]
+ *        [-Variants=/Game/DT_SectionsA+/Game/DT_SectionsB] [-OutPath=/Game/ArenaPool] [-Stats=File.csv] [-NoSave]
+ *        [-Raster=512] [-RasterDir=Path]
+ * Variants are data tables of Arena Sections, each one replaces the generator's section list.
+ */
+UCLASS()
+class UArenaBatchLayoutCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UArenaBatchLayoutCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	//Builds one set of planner inputs per section list variant
+	bool GatherVariants(const FString& Params, const ABaseArenaGenerator* Generator, TArray<FArenaLayoutInputs>& OutVariants) const;
+};